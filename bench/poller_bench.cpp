@@ -0,0 +1,204 @@
+// Poller 对比基准：epoll vs io_uring
+// 1. 可读事件：模拟 SubReactor 的用法，EPOLLIN | EPOLLET | EPOLLONESHOT 注册连接，
+//    每轮让 batch 个连接可读 -> Wait 收集事件 -> 读走数据 -> ModFd 重新注册
+// 2. 新连接：模拟 MasterReactor 的用法，每轮 batch 个客户端连上回环监听 socket，
+//    epoll 为 Wait + accept4 直到 EAGAIN，io_uring 为 multishot accept(AddAcceptor)；
+//    耗时从发起连接算到全部接下(multishot accept 在客户端 connect 返回时就可能已完成)，
+//    系统调用只统计服务端一侧(Wait 按一次计，加上 accept4 的调用次数)
+//
+// 用法: ./poller_bench [连接数=1000] [每轮就绪数=64] [轮数=20000]
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Poller.h"
+
+static double RunBench(const std::string &type, int conns, int batch, int rounds)
+{
+    std::unique_ptr<Poller> poller = Poller::Create(type, 1024);
+    if (type != poller->Name())
+    {
+        printf("%-10s unavailable\n", type.c_str());
+        return -1;
+    }
+
+    std::vector<int> rd(conns), wr(conns);
+    for (int i = 0; i < conns; i++)
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) < 0)
+        {
+            perror("socketpair");
+            exit(1);
+        }
+        rd[i] = sv[0];
+        wr[i] = sv[1];
+        poller->AddFd(rd[i], EPOLLIN | EPOLLET | EPOLLONESHOT, &rd[i]);
+    }
+
+    std::mt19937 rng(42);
+    std::vector<char> ready(conns, 0);
+    char byte = 'x';
+    long events = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        // 挑 batch 个不同的连接写 1 字节
+        int want = 0;
+        while (want < batch)
+        {
+            int i = rng() % conns;
+            if (ready[i])
+                continue;
+            ready[i] = 1;
+            if (write(wr[i], &byte, 1) != 1)
+                exit(1);
+            want++;
+        }
+
+        while (want > 0)
+        {
+            int n = poller->Wait(-1);
+            for (int k = 0; k < n; k++)
+            {
+                int *fdp = static_cast<int *>(poller->GetEventPtr(k));
+                int i = static_cast<int>(fdp - rd.data());
+                char buf[16];
+                while (read(*fdp, buf, sizeof(buf)) > 0)
+                {
+                }
+                ready[i] = 0;
+                poller->ModFd(*fdp, EPOLLIN | EPOLLET | EPOLLONESHOT, fdp);
+                want--;
+                events++;
+            }
+        }
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < conns; i++)
+    {
+        poller->DelFd(rd[i]);
+        close(rd[i]);
+        close(wr[i]);
+    }
+
+    double nsPerEvent = sec * 1e9 / events;
+    printf("%-10s %8ld events  %8.3f s  %8.1f ns/event  %10.0f events/s\n",
+           type.c_str(), events, sec, nsPerEvent, events / sec);
+    return nsPerEvent;
+}
+
+static double RunAcceptBench(const std::string &type, int batch, int rounds)
+{
+    std::unique_ptr<Poller> poller = Poller::Create(type, 1024);
+    if (type != poller->Name())
+    {
+        printf("%-10s unavailable\n", type.c_str());
+        return -1;
+    }
+
+    int listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (listenFd < 0 || bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listenFd, 4096) < 0 || getsockname(listenFd, (sockaddr *)&addr, &len) < 0)
+    {
+        perror("listen");
+        exit(1);
+    }
+    bool multishot = poller->AddAcceptor(listenFd) == 0;
+    if (!multishot)
+    {
+        poller->AddFd(listenFd, EPOLLIN | EPOLLET);
+    }
+
+    std::vector<int> clients(batch), servers;
+    servers.reserve(batch);
+    long conns = 0, syscalls = 0;
+    double sec = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < batch; k++)
+        {
+            clients[k] = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (connect(clients[k], (sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS)
+            {
+                perror("connect");
+                exit(1);
+            }
+        }
+
+        while (static_cast<int>(servers.size()) < batch)
+        {
+            int n = poller->Wait(-1);
+            syscalls++;
+            for (int k = 0; k < n; k++)
+            {
+                int fd = poller->GetAcceptedFd(k);
+                if (fd >= 0)
+                {
+                    servers.push_back(fd);
+                    continue;
+                }
+                // 只是可读：accept 到 EAGAIN
+                while (true)
+                {
+                    syscalls++;
+                    fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (fd < 0)
+                        break;
+                    servers.push_back(fd);
+                }
+            }
+        }
+        sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        conns += static_cast<long>(servers.size());
+        for (int fd : servers)
+            close(fd);
+        for (int fd : clients)
+            close(fd);
+        servers.clear();
+    }
+    poller->DelFd(listenFd);
+    close(listenFd);
+
+    double nsPerConn = sec * 1e9 / conns;
+    printf("%-10s %8ld conns   %8.3f s  %8.1f ns/conn   %6.2f syscalls/conn%s\n",
+           type.c_str(), conns, sec, nsPerConn, static_cast<double>(syscalls) / conns,
+           multishot ? "  (multishot accept)" : "");
+    return nsPerConn;
+}
+
+int main(int argc, char *argv[])
+{
+    int conns = argc > 1 ? atoi(argv[1]) : 1000;
+    int batch = argc > 2 ? atoi(argv[2]) : 64;
+    int rounds = argc > 3 ? atoi(argv[3]) : 20000;
+    if (batch > conns)
+        batch = conns;
+
+    printf("conns=%d batch=%d rounds=%d\n", conns, batch, rounds);
+    RunBench("epoll", conns, batch, rounds);
+    RunBench("io_uring", conns, batch, rounds);
+
+    // 每轮都要新建 / 关闭 batch 对连接，轮数取十分之一
+    int acceptRounds = rounds / 10 > 0 ? rounds / 10 : 1;
+    printf("accept: batch=%d rounds=%d\n", batch, acceptRounds);
+    RunAcceptBench("epoll", batch, acceptRounds);
+    RunAcceptBench("io_uring", batch, acceptRounds);
+    return 0;
+}
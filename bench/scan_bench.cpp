@@ -0,0 +1,167 @@
+// 请求头扫描基准：原来的标量写法 vs HttpScan 的标量 / SSE4.2 / AVX2 内核
+// 原写法：std::search 找 CRLF，每行拷贝成 std::string，再 find(':') + substr 拆出头部名和值
+// 新写法：FindSpecial 找行尾并检查控制字符，FindTokenEnd 校验头部名并定位 ':'
+// 报文取自常见浏览器 / 工具的真实请求头
+//
+// 用法: ./scan_bench [每组迭代次数=200000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "HttpScan.h"
+
+static const char *CHROME =
+    "GET /css/style.css HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "Accept: text/css,*/*;q=0.1\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: style\r\n"
+    "Referer: https://www.example.com/index.html\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+    "Cookie: _ga=GA1.1.123456789.1700000000; session=3f2a9c0d7e6b5a4f3e2d1c0b9a8f7e6d; theme=dark\r\n"
+    "If-None-Match: \"65f1a2b3-2653\"\r\n"
+    "If-Modified-Since: Wed, 13 Mar 2024 10:00:03 GMT\r\n"
+    "\r\n";
+
+static const char *FIREFOX =
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 Firefox/125.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: none\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Priority: u=1\r\n"
+    "\r\n";
+
+static const char *CURL =
+    "GET / HTTP/1.1\r\n"
+    "Host: 127.0.0.1:8080\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "\r\n";
+
+// 原实现：逐行 std::search + 拷贝
+static size_t ParseLegacy(const std::string &req)
+{
+    const char CRLF[] = "\r\n";
+    const char *p = req.data();
+    const char *end = p + req.size();
+    size_t headers = 0;
+    bool first = true;
+    while (p < end)
+    {
+        const char *lineEnd = std::search(p, end, CRLF, CRLF + 2);
+        if (lineEnd == end)
+            break;
+        std::string line(p, lineEnd);
+        if (line.empty())
+            break;
+        if (!first)
+        {
+            size_t pos = line.find(':');
+            if (pos != std::string::npos)
+            {
+                std::string key = line.substr(0, pos);
+                std::string value = line.substr(pos + 2);
+                headers += key.size() + value.size() > 0;
+            }
+        }
+        first = false;
+        p = lineEnd + 2;
+    }
+    return headers;
+}
+
+// 新实现：与 HttpRequest::parse 相同的扫描方式，不拷贝
+static size_t ParseKernels(const HttpScan::Kernels &k, const std::string &req)
+{
+    const char *p = req.data();
+    const char *end = p + req.size();
+    size_t headers = 0;
+    bool first = true;
+    while (p < end)
+    {
+        const char *lf = k.findSpecial(p, end);
+        if (lf == end)
+            break;
+        if (*lf == '\r')
+            lf++;
+        if (lf == end || *lf != '\n')
+            return 0; // 非法控制字符
+        const char *lineEnd = lf[-1] == '\r' ? lf - 1 : lf;
+        if (lineEnd == p)
+            break;
+        const char *tokenEnd = k.findTokenEnd(p, lineEnd);
+        if (!first)
+        {
+            if (tokenEnd == lineEnd || *tokenEnd != ':')
+                return 0;
+            headers++;
+        }
+        first = false;
+        p = lf + 1;
+    }
+    return headers;
+}
+
+template <typename Func>
+static void Run(const char *name, const std::string &req, int iters, Func func)
+{
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++)
+    {
+        sink += func(req);
+        asm volatile("" : : "r"(sink) : "memory");
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double ns = sec * 1e9 / iters;
+    printf("  %-8s %8.1f ns/req  %6.2f GB/s  (headers=%zu)\n",
+           name, ns, req.size() * iters / sec / 1e9, sink / iters);
+}
+
+int main(int argc, char *argv[])
+{
+    int iters = argc > 1 ? atoi(argv[1]) : 200000;
+    printf("active kernel: %s\n", HttpScan::Active().name);
+
+    struct
+    {
+        const char *name;
+        const char *req;
+    } sets[] = {{"chrome", CHROME}, {"firefox", FIREFOX}, {"curl", CURL}};
+
+    for (auto &set : sets)
+    {
+        std::string req(set.req);
+        printf("%s (%zu bytes)\n", set.name, req.size());
+        Run("legacy", req, iters, ParseLegacy);
+        HttpScan::Impl impls[] = {HttpScan::SCALAR, HttpScan::SSE42, HttpScan::AVX2};
+        for (HttpScan::Impl impl : impls)
+        {
+            const HttpScan::Kernels *k = HttpScan::Get(impl);
+            if (!k)
+                continue;
+            Run(k->name, req, iters, [k](const std::string &r)
+                { return ParseKernels(*k, r); });
+        }
+    }
+    return 0;
+}
@@ -4,6 +4,8 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <utility>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -69,6 +71,250 @@ public:
         return GetStringValue(config_, "server", "srcDir", "../resources");
     }
 
+    // 连接分发方式："master" 主 Reactor 统一 accept 后轮询分派；"reuseport" 每个 SubReactor 各自 accept
+    std::string GetAcceptMode() const
+    {
+        return GetStringValue(config_, "server", "acceptMode", "master");
+    }
+
+    // reuseport 模式下的内核分流程序："cbpf" 按 CPU 号分流；"none" 使用内核默认哈希
+    std::string GetReusePortSteering() const
+    {
+        return GetStringValue(config_, "server", "reusePortSteering", "none");
+    }
+
+    // listen() 的 backlog，超过 net.core.somaxconn 时内核会截断(启动时会打印警告)
+    int GetListenBacklog() const
+    {
+        return GetIntValue(config_, "server", "backlog", 1024);
+    }
+
+    // TCP_DEFER_ACCEPT 秒数：连接上有数据才唤醒 accept，0 表示关闭
+    int GetDeferAcceptSec() const
+    {
+        return GetIntValue(config_, "server", "deferAcceptSec", 5);
+    }
+
+    // TCP_FASTOPEN 队列长度，0 表示关闭
+    int GetFastOpenQueue() const
+    {
+        return GetIntValue(config_, "server", "fastOpenQueue", 256);
+    }
+
+    // 热升级 / 优雅退出时等待存量连接结束的最长时间(毫秒)
+    int GetDrainTimeoutMs() const
+    {
+        return GetIntValue(config_, "server", "drainTimeoutMs", 30000);
+    }
+
+    // 热升级时等待新进程就绪的最长时间(毫秒)，超时则放弃升级继续服务
+    int GetUpgradeTimeoutMs() const
+    {
+        return GetIntValue(config_, "server", "upgradeTimeoutMs", 10000);
+    }
+
+    // 是否把 SubReactor / 工作线程绑定到 CPU，并按 NUMA 节点就近分配连接槽
+    bool GetAffinityEnabled() const
+    {
+        return GetBoolValue(config_, "affinity", "enabled", false);
+    }
+
+    // 可用的 CPU 列表，如 "0-7,16-23"；空表示所有在线 CPU
+    std::string GetAffinityCpus() const
+    {
+        return GetStringValue(config_, "affinity", "cpus", "");
+    }
+
+    // 工作线程是否也按组绑定到对应 SubReactor 的 CPU
+    bool GetAffinityPinWorkers() const
+    {
+        return GetBoolValue(config_, "affinity", "pinWorkers", true);
+    }
+
+    // 事件循环等待策略："block" / "spin" / "busypoll"
+    std::string GetWaitStrategy() const
+    {
+        return GetStringValue(config_, "reactor", "waitStrategy", "block");
+    }
+
+    // spin 策略下每次自旋的预算(微秒)
+    int GetSpinBudgetUs() const
+    {
+        return GetIntValue(config_, "reactor", "spinBudgetUs", 50);
+    }
+
+    // busypoll 策略下 SO_BUSY_POLL 的时间(微秒)
+    int GetBusyPollUs() const
+    {
+        return GetIntValue(config_, "reactor", "busyPollUs", 50);
+    }
+
+    // I/O 多路复用实现："epoll" / "io_uring"
+    std::string GetPoller() const
+    {
+        return GetStringValue(config_, "reactor", "poller", "epoll");
+    }
+
+    // 每个 SubReactor 跨线程邮箱的容量
+    int GetMailboxSize() const
+    {
+        return GetIntValue(config_, "reactor", "mailboxSize", 4096);
+    }
+
+    // 每个 SubReactor 预分配的连接槽数量(同时在线连接上限)
+    int GetMaxConnPerReactor() const
+    {
+        return GetIntValue(config_, "reactor", "maxConnPerReactor", 4096);
+    }
+
+    // 运行到完成模式：读 / 解析 / 写都在 SubReactor 线程完成，只把阻塞请求(如登录查库)交给线程池
+    bool GetRunToCompletion() const
+    {
+        return GetBoolValue(config_, "reactor", "runToCompletion", false);
+    }
+
+    // 时间轮 tick 粒度(毫秒)
+    int GetTimerTickMs() const
+    {
+        return GetIntValue(config_, "timer", "tickMs", 100);
+    }
+
+    // 请求头读取期限：从开始等待请求到收齐请求头的最长时间(毫秒)
+    int GetHeaderTimeoutMs() const
+    {
+        return GetIntValue(config_, "timer", "headerTimeoutMs", 10000);
+    }
+
+    // 长连接空闲超时(秒)，同时写进响应头 Keep-Alive: timeout=
+    int GetKeepAliveTimeoutSec() const
+    {
+        return GetIntValue(config_, "timer", "keepAliveTimeoutSec", 120);
+    }
+
+    // 一条长连接最多处理的请求数，同时写进响应头 Keep-Alive: max=
+    int GetKeepAliveMax() const
+    {
+        return GetIntValue(config_, "timer", "keepAliveMax", 6);
+    }
+
+    // 写停滞期限：发送缓冲一直写不出去的最长时间(毫秒)
+    int GetWriteTimeoutMs() const
+    {
+        return GetIntValue(config_, "timer", "writeTimeoutMs", 30000);
+    }
+
+    // 请求体(解码后)的最大字节数，超过返回 413
+    int GetMaxBodyBytes() const
+    {
+        return GetIntValue(config_, "http", "maxBodyBytes", 1024 * 1024);
+    }
+
+    // 上传：接收 multipart/form-data 的路径
+    std::string GetUploadPath() const
+    {
+        return GetStringValue(config_, "http", "uploadPath", "/upload");
+    }
+
+    // 上传文件的落盘目录，为空时不接收上传
+    std::string GetUploadDir() const
+    {
+        return GetStringValue(config_, "http", "uploadDir", "../upload");
+    }
+
+    // 单个上传请求的字节配额(MB)
+    int GetUploadMaxMB() const
+    {
+        return GetIntValue(config_, "http", "uploadMaxMB", 512);
+    }
+
+    // 请求体停滞期限：请求头已收齐后，请求体一直没有新数据的最长时间(毫秒)
+    int GetBodyTimeoutMs() const
+    {
+        return GetIntValue(config_, "timer", "bodyTimeoutMs", 30000);
+    }
+
+    // 打开文件缓存的条目数上限(共享 fd / stat / 映射，inotify 失效)，0 表示不缓存
+    int GetCacheOpenFiles() const
+    {
+        return GetIntValue(config_, "cache", "openFiles", 1024);
+    }
+
+    // 内容缓存的字节预算(MB)：小文件读入内存，W-TinyLFU 准入，0 表示不缓存内容
+    int GetCacheContentMB() const
+    {
+        return GetIntValue(config_, "cache", "contentMB", 64);
+    }
+
+    // 读入内容缓存的单个文件大小上限(KB)，更大的文件直接从映射发送
+    int GetCacheContentMaxFileKB() const
+    {
+        return GetIntValue(config_, "cache", "contentMaxFileKB", 1024);
+    }
+
+    // 不超过该字节数的文件正文直接拷进响应头所在的缓冲，一次 send 发出
+    int GetInlineMaxBytes() const
+    {
+        return GetIntValue(config_, "transfer", "inlineMaxBytes", 4096);
+    }
+
+    // 不小于该大小(KB)的文件打开时给出顺序读 / 预读提示(posix_fadvise)，0 表示关闭
+    int GetReadaheadMinKB() const
+    {
+        return GetIntValue(config_, "transfer", "readaheadMinKB", 4096);
+    }
+
+    // 启动时为可压缩的静态文件生成 .gz / .br 预压缩旁路文件
+    bool GetPrecompress() const
+    {
+        return GetBoolValue(config_, "compress", "precompress", true);
+    }
+
+    // 小于该字节数的文件 / 正文不压缩
+    int GetCompressMinBytes() const
+    {
+        return GetIntValue(config_, "compress", "minBytes", 256);
+    }
+
+    // 实时 gzip 的压缩级别(空闲时，繁忙时自动降低)，0 表示关闭实时压缩
+    int GetCompressLevel() const
+    {
+        return GetIntValue(config_, "compress", "level", 6);
+    }
+
+    // 超过该大小(KB)的正文不实时压缩
+    int GetCompressMaxKB() const
+    {
+        return GetIntValue(config_, "compress", "maxKB", 1024);
+    }
+
+    // 实时压缩结果缓存的字节预算(MB)，0 表示不缓存
+    int GetCompressMemoMB() const
+    {
+        return GetIntValue(config_, "compress", "memoMB", 16);
+    }
+
+    // 重定向：redirects 段中 "路由模式": "Location"，以 301 响应
+    std::vector<std::pair<std::string, std::string>> GetRedirects() const
+    {
+        std::vector<std::pair<std::string, std::string>> redirects;
+        if (!config_.contains("redirects") || !config_.at("redirects").is_object())
+        {
+            return redirects;
+        }
+        for (const auto &item : config_.at("redirects").items())
+        {
+            if (item.value().is_string())
+            {
+                redirects.emplace_back(item.key(), item.value().get<std::string>());
+            }
+            else
+            {
+                std::cerr << "Warning: invalid redirect [" << item.key() << "], ignored" << std::endl;
+            }
+        }
+        return redirects;
+    }
+
     std::string GetDBHost() const
     {
         return GetStringValue(config_, "database", "host", "localhost");
@@ -136,6 +382,20 @@ private:
         }
     }
 
+    // 获取布尔值，默认值为"default_value"
+    bool GetBoolValue(const json &config, const std::string &section, const std::string &key, bool default_value) const
+    {
+        try
+        {
+            return config.at(section).at(key).get<bool>();
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Warning: Missing or invalid key [" << section << "][" << key << "], using default: " << std::boolalpha << default_value << std::endl;
+            return default_value;
+        }
+    }
+
     // 禁止拷贝和赋值
     Config(const Config &) = delete;
     Config &operator=(const Config &) = delete;
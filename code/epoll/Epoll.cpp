@@ -1,5 +1,6 @@
 #include "Epoll.h"
 #include <stdexcept>
+#include <sys/ioctl.h>
 
 /**
  * @brief 构造函数
@@ -58,6 +59,30 @@ int Epoll::ModFd(int fd, uint32_t events)
     return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
 }
 
+int Epoll::AddFd(int fd, uint32_t events, void *ptr)
+{
+    if (fd < 0)
+        return -1;
+
+    epoll_event ev{};
+    ev.data.ptr = ptr;
+    ev.events = events;
+
+    return epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int Epoll::ModFd(int fd, uint32_t events, void *ptr)
+{
+    if (fd < 0)
+        return -1;
+
+    epoll_event ev{};
+    ev.data.ptr = ptr;
+    ev.events = events;
+
+    return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
 int Epoll::DelFd(int fd)
 {
     if (fd < 0)
@@ -83,7 +108,25 @@ int Epoll::GetEventFd(size_t i) const
     return events_[i].data.fd;
 }
 
+void *Epoll::GetEventPtr(size_t i) const
+{
+    return events_[i].data.ptr;
+}
+
 uint32_t Epoll::GetEvents(size_t i) const
 {
     return events_[i].events;
 }
+
+bool Epoll::SetBusyPoll(int usecs)
+{
+#ifdef EPIOCSPARAMS
+    struct epoll_params params{};
+    params.busy_poll_usecs = static_cast<uint32_t>(usecs);
+    params.busy_poll_budget = 8;
+    return ioctl(epollFd_, EPIOCSPARAMS, &params) == 0;
+#else
+    (void)usecs;
+    return false;
+#endif
+}
@@ -6,8 +6,12 @@
 #include <vector>
 #include <cerrno>
 #include <stdexcept>
+#include "Poller.h"
 
-class Epoll
+/**
+ * @brief 基于 epoll 的 Poller 实现
+ */
+class Epoll : public Poller
 {
 public:
     /**
@@ -19,7 +23,7 @@ public:
     /**
      * @brief 析构函数：关闭 epoll 文件描述符
      */
-    ~Epoll();
+    ~Epoll() override;
 
     /**
      * @brief 向 epoll 中添加一个文件描述符
@@ -27,7 +31,7 @@ public:
      * @param events 监听的事件，如 EPOLLIN | EPOLLOUT | EPOLLET | EPOLLONESHOT 等
      * @return 成功返回 0，失败返回 -1
      */
-    int AddFd(int fd, uint32_t events);
+    int AddFd(int fd, uint32_t events) override;
 
     /**
      * @brief 修改已存在的 fd 的监听事件
@@ -35,35 +39,62 @@ public:
      * @param events 新的事件
      * @return 成功返回 0，失败返回 -1
      */
-    int ModFd(int fd, uint32_t events);
+    int ModFd(int fd, uint32_t events) override;
+
+    /**
+     * @brief 添加 fd，并把 ptr 存入 epoll_event.data.ptr(就绪时直接拿到连接对象)
+     */
+    int AddFd(int fd, uint32_t events, void *ptr) override;
+
+    /**
+     * @brief 修改 fd 的监听事件，同时保持 data.ptr
+     */
+    int ModFd(int fd, uint32_t events, void *ptr) override;
 
     /**
      * @brief 从 epoll 中移除一个文件描述符
      * @param fd 要移除的 fd
      * @return 成功返回 0，失败返回 -1
      */
-    int DelFd(int fd);
+    int DelFd(int fd) override;
 
     /**
      * @brief 等待事件触发
      * @param timeoutMS 超时时间（毫秒），-1 表示阻塞等待
      * @return 返回就绪事件的数量(>=0)，出错返回 -1
      */
-    int Wait(int timeoutMS = -1);
+    int Wait(int timeoutMS = -1) override;
 
     /**
      * @brief 获取第 i 个就绪事件对应的 fd
      * @param i 就绪事件在数组中的索引
      * @return 对应的 fd
      */
-    int GetEventFd(size_t i) const;
+    int GetEventFd(size_t i) const override;
+
+    /**
+     * @brief 获取第 i 个就绪事件的 data.ptr(仅对以 ptr 方式注册的 fd 有意义)
+     */
+    void *GetEventPtr(size_t i) const override;
 
     /**
      * @brief 获取第 i 个就绪事件的类型(EPOLLIN / EPOLLOUT / EPOLLERR / ...)
      * @param i 就绪事件在数组中的索引
      * @return 事件类型
      */
-    uint32_t GetEvents(size_t i) const;
+    uint32_t GetEvents(size_t i) const override;
+
+    /**
+     * @brief 返回 epoll 实例本身的 fd(用于 ioctl 等设置)
+     */
+    int GetEpollFd() const { return epollFd_; }
+
+    /**
+     * @brief 设置 epoll_wait 的忙轮询参数(EPIOCSPARAMS，Linux 6.9+)
+     */
+    bool SetBusyPoll(int usecs) override;
+
+    const char *Name() const override { return "epoll"; }
 
 private:
     int epollFd_;                     // epoll 文件描述符
@@ -0,0 +1,526 @@
+#include "IoUringPoller.h"
+
+#ifdef WEBSERVER_IO_URING
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    // POLL_REMOVE / ASYNC_CANCEL / FILES_UPDATE 自身的完成事件用这个 user_data，收割时直接忽略
+    const uint64_t INTERNAL_TAG = ~0ULL;
+
+    // user_data 低 32 位的最高位：这是一个 accept 的完成事件(fd 不会用到这一位)
+    const uint64_t ACCEPT_FLAG = 1ULL << 31;
+
+    // 固定文件表的上限，超出的 fd 照常按 fd 提交
+    const size_t MAX_FIXED_FILES = 32768;
+
+    // FILES_UPDATE 清空表项时读取的值
+    const int NO_FILE = -1;
+
+    // poll 能识别的事件位(与 POLLIN / POLLOUT 等数值相同)
+    const uint32_t POLL_MASK = EPOLLIN | EPOLLOUT | EPOLLPRI | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
+
+    int SysSetup(unsigned entries, io_uring_params *p)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+    }
+
+    int SysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags, const void *arg, size_t argSize)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+    }
+
+    int SysRegister(int fd, unsigned opcode, const void *arg, unsigned nrArgs)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+    }
+
+    uint64_t MakeUserData(int fd, uint32_t gen, bool accept = false)
+    {
+        return (static_cast<uint64_t>(gen) << 32) | static_cast<uint32_t>(fd) | (accept ? ACCEPT_FLAG : 0);
+    }
+}
+
+IoUringPoller::IoUringPoller(int maxEvent)
+    : ringFd_(-1),
+      events_(maxEvent),
+      accepted_(maxEvent, -1),
+      multishotAccept_(true),
+      sqRing_(MAP_FAILED),
+      sqRingSize_(0),
+      sqes_(static_cast<io_uring_sqe *>(MAP_FAILED)),
+      sqesSize_(0),
+      sqEntries_(0),
+      sqLocalTail_(0),
+      pending_(0),
+      cqRing_(MAP_FAILED),
+      cqRingSize_(0)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // 完成队列开大一些：每个 fd 最多一个未完成的 poll，再加上 POLL_REMOVE / FILES_UPDATE 的完成事件
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = static_cast<unsigned>(maxEvent) * 4;
+
+    ringFd_ = SysSetup(static_cast<unsigned>(maxEvent), &params);
+    if (ringFd_ < 0)
+    {
+        throw std::runtime_error("io_uring_setup failed, errno " + std::to_string(errno));
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG))
+    {
+        close(ringFd_);
+        throw std::runtime_error("io_uring lacks IORING_FEAT_EXT_ARG (need Linux 5.11+)");
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+    {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    cqRing_ = singleMmap ? sqRing_
+                         : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES));
+    if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED)
+    {
+        int err = errno;
+        Release_();
+        throw std::runtime_error("io_uring mmap failed, errno " + std::to_string(err));
+    }
+
+    char *sq = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    sqEntries_ = params.sq_entries;
+    sqLocalTail_ = *sqTail_;
+
+    char *cq = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    RegisterFiles_();
+}
+
+IoUringPoller::~IoUringPoller()
+{
+    Release_();
+}
+
+void IoUringPoller::Release_()
+{
+    if (sqes_ != MAP_FAILED)
+        munmap(sqes_, sqesSize_);
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+        munmap(cqRing_, cqRingSize_);
+    if (sqRing_ != MAP_FAILED)
+        munmap(sqRing_, sqRingSize_);
+    sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+    cqRing_ = sqRing_ = MAP_FAILED;
+    if (ringFd_ >= 0)
+    {
+        close(ringFd_);
+        ringFd_ = -1;
+    }
+}
+
+void IoUringPoller::RegisterFiles_()
+{
+    // 表大小不能超过 RLIMIT_NOFILE；全部填 -1 注册为稀疏表(Linux 5.5+)，之后按需登记
+    size_t n = MAX_FIXED_FILES;
+    rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < n)
+    {
+        n = static_cast<size_t>(rl.rlim_cur);
+    }
+    std::vector<int> empty(n, NO_FILE);
+    if (n == 0 || SysRegister(ringFd_, IORING_REGISTER_FILES, empty.data(), static_cast<unsigned>(n)) < 0)
+    {
+        return; // 不使用固定文件，照常按 fd 提交
+    }
+    fileSlots_.resize(n);
+    std::iota(fileSlots_.begin(), fileSlots_.end(), 0);
+}
+
+int IoUringPoller::AddFd(int fd, uint32_t events)
+{
+    epoll_data_t data{};
+    data.fd = fd;
+    return Ctl_(fd, events, data, true);
+}
+
+int IoUringPoller::ModFd(int fd, uint32_t events)
+{
+    epoll_data_t data{};
+    data.fd = fd;
+    return Ctl_(fd, events, data, false);
+}
+
+int IoUringPoller::AddFd(int fd, uint32_t events, void *ptr)
+{
+    epoll_data_t data{};
+    data.ptr = ptr;
+    return Ctl_(fd, events, data, true);
+}
+
+int IoUringPoller::ModFd(int fd, uint32_t events, void *ptr)
+{
+    epoll_data_t data{};
+    data.ptr = ptr;
+    return Ctl_(fd, events, data, false);
+}
+
+int IoUringPoller::AddAcceptor(int listenFd)
+{
+#ifdef IORING_ACCEPT_MULTISHOT
+    epoll_data_t data{};
+    data.fd = listenFd;
+    return Ctl_(listenFd, EPOLLIN, data, true, true);
+#else
+    (void)listenFd;
+    errno = EOPNOTSUPP; // 编译时的内核头文件还没有 multishot accept
+    return -1;
+#endif
+}
+
+int IoUringPoller::Ctl_(int fd, uint32_t events, epoll_data_t data, bool add, bool acceptor)
+{
+    if (fd < 0)
+        return -1;
+    if (static_cast<size_t>(fd) >= regs_.size())
+    {
+        regs_.resize(static_cast<size_t>(fd) + 1024);
+    }
+
+    Registration &reg = regs_[fd];
+    // 与 epoll_ctl 的错误语义保持一致
+    if (add == reg.registered)
+    {
+        errno = add ? EEXIST : ENOENT;
+        return -1;
+    }
+    if (reg.armed)
+    {
+        // 旧的 poll 还挂在内核里：先撤销，代数 + 1 让它的完成事件失效
+        Cancel_(fd, reg);
+    }
+    reg.events = events;
+    reg.data = data;
+    reg.registered = true;
+    if (add)
+    {
+        reg.acceptor = acceptor;
+        UpdateFile_(fd, reg, true);
+    }
+    Arm_(fd, reg);
+    return 0;
+}
+
+int IoUringPoller::DelFd(int fd)
+{
+    if (fd < 0 || static_cast<size_t>(fd) >= regs_.size() || !regs_[fd].registered)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    Registration &reg = regs_[fd];
+    reg.registered = false;
+    reg.acceptor = false;
+    bool armed = reg.armed;
+    if (armed)
+    {
+        Cancel_(fd, reg);
+    }
+    else
+    {
+        reg.gen++;
+    }
+    // 固定文件表也持有文件引用：清空表项随下一次提交生效，调用方 close() 后 socket 最迟在下一次 Wait 时释放
+    if (reg.fixed)
+    {
+        UpdateFile_(fd, reg, false);
+    }
+    if (armed)
+    {
+        // 未完成的 poll / accept 可能长时间挂着，立即提交撤销，保证调用方 close() 后连接能及时关闭
+        Submit_(0, 0, nullptr, 0);
+    }
+    return 0;
+}
+
+void IoUringPoller::UpdateFile_(int fd, Registration &reg, bool install)
+{
+    if (install && static_cast<size_t>(fd) >= fileSlots_.size())
+    {
+        return; // 未启用固定文件或 fd 超出表大小
+    }
+    if (install)
+    {
+        // 登记与随后的 POLL_ADD / ACCEPT 链接，保证先于它执行，两者要在同一批提交
+        unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if (sqLocalTail_ - head + 2 > sqEntries_)
+        {
+            Submit_(0, 0, nullptr, 0);
+        }
+    }
+    io_uring_sqe *sqe = GetSqe_();
+    sqe->opcode = IORING_OP_FILES_UPDATE;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(install ? &fileSlots_[fd] : &NO_FILE);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(fd);
+    sqe->user_data = INTERNAL_TAG;
+    if (install)
+    {
+        sqe->flags |= IOSQE_IO_LINK;
+    }
+    reg.fixed = install;
+}
+
+void IoUringPoller::Arm_(int fd, Registration &reg)
+{
+    if (reg.acceptor && multishotAccept_)
+    {
+        ArmAccept_(fd, reg);
+    }
+    else
+    {
+        ArmPoll_(fd, reg);
+    }
+}
+
+void IoUringPoller::ArmPoll_(int fd, Registration &reg)
+{
+    io_uring_sqe *sqe = GetSqe_();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd; // 固定文件下标就是 fd
+    sqe->flags = reg.fixed ? IOSQE_FIXED_FILE : 0;
+    sqe->poll32_events = reg.events & POLL_MASK;
+    // 没有 EPOLLONESHOT 的 fd 使用多次触发的 poll，不需要每次重新提交
+    sqe->len = (reg.events & EPOLLONESHOT) ? 0 : IORING_POLL_ADD_MULTI;
+    sqe->user_data = MakeUserData(fd, reg.gen);
+    reg.armed = true;
+    reg.accepting = false;
+}
+
+void IoUringPoller::ArmAccept_(int fd, Registration &reg)
+{
+#ifdef IORING_ACCEPT_MULTISHOT
+    io_uring_sqe *sqe = GetSqe_();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->flags = reg.fixed ? IOSQE_FIXED_FILE : 0;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    // 不取客户端地址：多个连接共用一块缓冲会互相覆盖，需要时由 getpeername 取得
+    sqe->user_data = MakeUserData(fd, reg.gen, true);
+    reg.armed = true;
+    reg.accepting = true;
+#else
+    ArmPoll_(fd, reg);
+#endif
+}
+
+void IoUringPoller::Cancel_(int fd, Registration &reg)
+{
+    io_uring_sqe *sqe = GetSqe_();
+    // POLL_REMOVE 只能撤销 poll，accept 用通用的 ASYNC_CANCEL
+    sqe->opcode = reg.accepting ? IORING_OP_ASYNC_CANCEL : IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = MakeUserData(fd, reg.gen, reg.accepting);
+    sqe->user_data = INTERNAL_TAG;
+    reg.gen++;
+    reg.armed = false;
+}
+
+io_uring_sqe *IoUringPoller::GetSqe_()
+{
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (sqLocalTail_ - head >= sqEntries_)
+    {
+        // 提交队列满：先把已有的交给内核
+        Submit_(0, 0, nullptr, 0);
+    }
+    unsigned idx = sqLocalTail_ & *sqMask_;
+    io_uring_sqe *sqe = &sqes_[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray_[idx] = idx;
+    sqLocalTail_++;
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+    pending_++;
+    return sqe;
+}
+
+int IoUringPoller::Submit_(unsigned minComplete, unsigned flags, const void *arg, size_t argSize)
+{
+    int ret;
+    do
+    {
+        ret = SysEnter(ringFd_, pending_, minComplete, flags, arg, argSize);
+    } while (ret < 0 && errno == EINTR && minComplete == 0);
+
+    if (ret >= 0)
+    {
+        pending_ -= static_cast<unsigned>(ret) < pending_ ? static_cast<unsigned>(ret) : pending_;
+    }
+    return ret;
+}
+
+int IoUringPoller::Wait(int timeoutMS)
+{
+    // 完成队列里已经有事件就不必等待
+    bool ready = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) != *cqHead_;
+
+    if (!ready && timeoutMS != 0)
+    {
+        io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        struct __kernel_timespec ts;
+        if (timeoutMS > 0)
+        {
+            ts.tv_sec = timeoutMS / 1000;
+            ts.tv_nsec = static_cast<long long>(timeoutMS % 1000) * 1000000;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+        }
+        int ret = Submit_(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        if (ret < 0 && errno != ETIME)
+        {
+            if (errno == EINTR)
+                return -1;
+            if (errno != EBUSY) // EBUSY：完成队列溢出，先收割
+                return -1;
+        }
+    }
+    else if (pending_ > 0)
+    {
+        Submit_(0, 0, nullptr, 0);
+    }
+
+    return Reap_();
+}
+
+int IoUringPoller::Reap_()
+{
+    int n = 0;
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+
+    while (head != tail && n < static_cast<int>(events_.size()))
+    {
+        io_uring_cqe *cqe = &cqes_[head & *cqMask_];
+        head++;
+
+        if (cqe->user_data == INTERNAL_TAG)
+            continue;
+
+        bool accept = cqe->user_data & ACCEPT_FLAG;
+        int fd = static_cast<int>(cqe->user_data & (ACCEPT_FLAG - 1));
+        uint32_t gen = static_cast<uint32_t>(cqe->user_data >> 32);
+        if (static_cast<size_t>(fd) >= regs_.size() || !regs_[fd].registered || regs_[fd].gen != gen)
+        {
+            // 已删除或已重新注册：过期事件；撤销生效前已经接下的连接没人认领，直接关闭
+            if (accept && cqe->res >= 0)
+                close(cqe->res);
+            continue;
+        }
+        Registration &reg = regs_[fd];
+
+        bool more = cqe->flags & IORING_CQE_F_MORE;
+        if (!more)
+        {
+            reg.armed = false;
+        }
+        if (!more && reg.fixed && (cqe->res == -ECANCELED || cqe->res == -EBADF))
+        {
+            // 链接在前面的 FILES_UPDATE 失败，或表项已不可用：这个 fd 改回按 fd 提交
+            reg.fixed = false;
+            Arm_(fd, reg);
+            continue;
+        }
+        if (cqe->res == -ECANCELED)
+            continue;
+
+        if (accept)
+        {
+            // 新连接直接交给调用方；出错时只报告可读，由调用方 accept(EMFILE 时丢弃连接等)
+            events_[n].events = EPOLLIN;
+            events_[n].data = reg.data;
+            accepted_[n] = cqe->res >= 0 ? cqe->res : -1;
+            n++;
+            if (!more)
+            {
+                if (cqe->res == -EINVAL)
+                    multishotAccept_ = false; // 内核不支持 multishot accept(Linux 5.19 之前)
+                // 出错后改挂 poll，等下一次可读再换回 accept，避免错误持续时空转
+                if (cqe->res < 0)
+                    ArmPoll_(fd, reg);
+                else
+                    Arm_(fd, reg);
+            }
+            continue;
+        }
+
+        uint32_t revents = cqe->res < 0 ? EPOLLERR : static_cast<uint32_t>(cqe->res);
+        events_[n].events = revents;
+        events_[n].data = reg.data;
+        accepted_[n] = -1;
+        n++;
+
+        if (reg.acceptor && multishotAccept_)
+        {
+            // 监听 socket 因 accept 出错暂时挂着 poll：本次由调用方 accept，之后换回 multishot accept
+            if (reg.armed)
+                Cancel_(fd, reg);
+            ArmAccept_(fd, reg);
+        }
+        else if (!more && !(reg.events & EPOLLONESHOT))
+        {
+            // 多次触发的 poll 被内核终止(如完成队列溢出)，重新挂上
+            ArmPoll_(fd, reg);
+        }
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+int IoUringPoller::GetEventFd(size_t i) const
+{
+    return events_[i].data.fd;
+}
+
+void *IoUringPoller::GetEventPtr(size_t i) const
+{
+    return events_[i].data.ptr;
+}
+
+uint32_t IoUringPoller::GetEvents(size_t i) const
+{
+    return events_[i].events;
+}
+
+int IoUringPoller::GetAcceptedFd(size_t i) const
+{
+    return accepted_[i];
+}
+
+#endif // WEBSERVER_IO_URING
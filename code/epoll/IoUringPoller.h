@@ -0,0 +1,113 @@
+#ifndef IOURINGPOLLER_H
+#define IOURINGPOLLER_H
+
+#ifdef WEBSERVER_IO_URING
+
+#include <linux/io_uring.h>
+#include <vector>
+#include "Poller.h"
+
+/**
+ * @brief 基于 io_uring 的 Poller(直接使用系统调用，不依赖 liburing)
+ *  - 注册 / 修改 fd 只是往提交队列写一个 POLL_ADD，和下一次 Wait 合并为一次 io_uring_enter
+ *  - 带 EPOLLONESHOT 的 fd 使用单次 poll，触发后需要 ModFd 重新注册(与 epoll 用法一致)
+ *  - 其余 fd(监听 socket、eventfd)使用多次触发的 poll(IORING_POLL_ADD_MULTI，Linux 5.13+)
+ *  - AddAcceptor 的监听 socket 使用 multishot accept(Linux 5.19+)：一个 SQE 持续产出新连接，
+ *    省掉每个连接的 accept4 和每批末尾探测 EAGAIN 的那一次；内核不支持或 accept 出错时
+ *    退回多次触发的 poll，由调用方自己 accept，下一次可读后再换回 multishot accept
+ *  - fd 同时登记到 ring 的固定文件表(下标即 fd)，之后的 POLL_ADD / ACCEPT 带 IOSQE_FIXED_FILE，
+ *    内核不必每次按 fd 查找并引用文件；登记 / 清除用 FILES_UPDATE 操作，随下一次 io_uring_enter 一起提交
+ *  - user_data 高 32 位为代数，DelFd / 重新注册后旧的完成事件会被丢弃
+ */
+class IoUringPoller : public Poller
+{
+public:
+    /**
+     * @param maxEvent 一次 Wait 最多返回的事件数，也决定提交队列大小
+     * 内核不支持(缺少 IORING_FEAT_EXT_ARG 等)时抛出 std::runtime_error
+     */
+    explicit IoUringPoller(int maxEvent = 1024);
+    ~IoUringPoller() override;
+
+    int AddFd(int fd, uint32_t events) override;
+    int ModFd(int fd, uint32_t events) override;
+    int AddFd(int fd, uint32_t events, void *ptr) override;
+    int ModFd(int fd, uint32_t events, void *ptr) override;
+    int DelFd(int fd) override;
+    int AddAcceptor(int listenFd) override;
+
+    int Wait(int timeoutMS = -1) override;
+
+    int GetEventFd(size_t i) const override;
+    void *GetEventPtr(size_t i) const override;
+    uint32_t GetEvents(size_t i) const override;
+    int GetAcceptedFd(size_t i) const override;
+
+    const char *Name() const override { return "io_uring"; }
+
+private:
+    // 每个 fd 的注册信息
+    struct Registration
+    {
+        uint32_t events = 0;
+        epoll_data_t data{};
+        uint32_t gen = 0;       // 代数，拼进 user_data
+        bool registered = false;
+        bool armed = false;     // 内核中是否还有未完成的 poll / accept
+        bool acceptor = false;  // 由 AddAcceptor 注册
+        bool accepting = false; // 当前挂着的是 multishot accept(否则是 poll)
+        bool fixed = false;     // 已登记到固定文件表
+    };
+
+    int Ctl_(int fd, uint32_t events, epoll_data_t data, bool add, bool acceptor = false);
+    // 解除映射并关闭 ring
+    void Release_();
+    // 注册稀疏的固定文件表，失败时不使用固定文件
+    void RegisterFiles_();
+    // 把 fd 登记到固定文件表 / 从表中移除
+    void UpdateFile_(int fd, Registration &reg, bool install);
+    // 按注册类型提交 POLL_ADD 或 multishot ACCEPT
+    void Arm_(int fd, Registration &reg);
+    void ArmPoll_(int fd, Registration &reg);
+    void ArmAccept_(int fd, Registration &reg);
+    // 撤销挂在内核中的 poll / accept，代数 + 1
+    void Cancel_(int fd, Registration &reg);
+    // 取一个空闲的 SQE，提交队列满时先提交
+    io_uring_sqe *GetSqe_();
+    // 提交所有待提交的 SQE
+    int Submit_(unsigned minComplete, unsigned flags, const void *arg, size_t argSize);
+    // 把完成队列中的事件收集到 events_
+    int Reap_();
+
+    int ringFd_;
+    std::vector<epoll_event> events_;
+    std::vector<int> accepted_;      // 与 events_ 一一对应，multishot accept 得到的新连接，没有时为 -1
+    std::vector<Registration> regs_; // 以 fd 为下标
+    std::vector<int> fileSlots_;     // fileSlots_[i] = i，FILES_UPDATE 从这里读取要登记的 fd；为空表示不使用固定文件
+    bool multishotAccept_;           // 内核支持 multishot accept(首次返回 EINVAL 后置为 false)
+
+    // 提交队列
+    void *sqRing_;
+    size_t sqRingSize_;
+    unsigned *sqHead_;
+    unsigned *sqTail_;
+    unsigned *sqMask_;
+    unsigned *sqArray_;
+    io_uring_sqe *sqes_;
+    size_t sqesSize_;
+    unsigned sqEntries_;
+    unsigned sqLocalTail_;
+    unsigned pending_; // 已写入还未提交的 SQE 数
+
+    // 完成队列
+    void *cqRing_;
+    size_t cqRingSize_;
+    unsigned *cqHead_;
+    unsigned *cqTail_;
+    unsigned *cqMask_;
+    io_uring_cqe *cqes_;
+};
+
+#endif // WEBSERVER_IO_URING
+
+#endif // IOURINGPOLLER_H
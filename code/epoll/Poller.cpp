@@ -0,0 +1,24 @@
+#include "Poller.h"
+#include "Epoll.h"
+#include "IoUringPoller.h"
+#include "log.hpp"
+
+std::unique_ptr<Poller> Poller::Create(const std::string &type, int maxEvent)
+{
+    if (type == "io_uring")
+    {
+#ifdef WEBSERVER_IO_URING
+        try
+        {
+            return std::make_unique<IoUringPoller>(maxEvent);
+        }
+        catch (const std::exception &e)
+        {
+            AsyncLogger::get_instance().log(WARNING, std::string("io_uring unavailable, fallback to epoll: ") + e.what());
+        }
+#else
+        AsyncLogger::get_instance().log(WARNING, "io_uring not compiled in, fallback to epoll");
+#endif
+    }
+    return std::make_unique<Epoll>(maxEvent);
+}
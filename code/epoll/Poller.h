@@ -0,0 +1,90 @@
+#ifndef POLLER_H
+#define POLLER_H
+
+#include <sys/epoll.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * @brief I/O 多路复用的抽象接口：接口语义与 epoll 一致(事件位使用 EPOLLIN / EPOLLOUT / EPOLLET / EPOLLONESHOT 等)
+ *        目前有两种实现：
+ *  - Epoll        ：epoll_ctl + epoll_wait
+ *  - IoUringPoller：io_uring 的 POLL_ADD / POLL_REMOVE，注册 / 修改只写提交队列，
+ *                   与下一次等待合并成一次 io_uring_enter 系统调用；
+ *                   监听 socket 可交给内核 multishot accept(AddAcceptor)
+ *  Poller 非线程安全，只能在所属 Reactor 线程使用
+ */
+class Poller
+{
+public:
+    virtual ~Poller() = default;
+
+    /**
+     * @brief 添加 / 修改 fd，epoll_event.data.fd = fd
+     */
+    virtual int AddFd(int fd, uint32_t events) = 0;
+    virtual int ModFd(int fd, uint32_t events) = 0;
+
+    /**
+     * @brief 添加 / 修改 fd，epoll_event.data.ptr = ptr
+     */
+    virtual int AddFd(int fd, uint32_t events, void *ptr) = 0;
+    virtual int ModFd(int fd, uint32_t events, void *ptr) = 0;
+
+    /**
+     * @brief 移除 fd
+     */
+    virtual int DelFd(int fd) = 0;
+
+    /**
+     * @brief 由 Poller 代为 accept 监听 socket，移除同样使用 DelFd
+     *        事件照常以 data.fd = listenFd、EPOLLIN 报告，GetAcceptedFd 取出新连接
+     * @return 不支持时返回 -1，调用方改用 AddFd + 自己 accept
+     */
+    virtual int AddAcceptor(int /*listenFd*/)
+    {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    /**
+     * @brief 等待事件
+     * @param timeoutMS 超时时间(毫秒)，-1 表示阻塞等待，0 表示立即返回
+     * @return 就绪事件的数量(>=0)，出错返回 -1(errno 有效)
+     */
+    virtual int Wait(int timeoutMS = -1) = 0;
+
+    /**
+     * @brief 第 i 个就绪事件的 data.fd / data.ptr / 事件位
+     */
+    virtual int GetEventFd(size_t i) const = 0;
+    virtual void *GetEventPtr(size_t i) const = 0;
+    virtual uint32_t GetEvents(size_t i) const = 0;
+
+    /**
+     * @brief 第 i 个事件是 AddAcceptor 代为 accept 的新连接时返回其 fd(已带 O_NONBLOCK | O_CLOEXEC)
+     *        返回 -1 表示只是监听 socket 可读(内核不支持或 accept 出错)，调用方按原方式 accept 到 EAGAIN
+     */
+    virtual int GetAcceptedFd(size_t /*i*/) const { return -1; }
+
+    /**
+     * @brief 开启等待时的网卡忙轮询(不支持时返回 false)
+     */
+    virtual bool SetBusyPoll(int /*usecs*/) { return false; }
+
+    /**
+     * @brief 实现名称，用于日志
+     */
+    virtual const char *Name() const = 0;
+
+    /**
+     * @brief 按名称创建 Poller："epoll" / "io_uring"
+     *        io_uring 未编译进来或内核不支持时回退到 epoll
+     */
+    static std::unique_ptr<Poller> Create(const std::string &type, int maxEvent = 1024);
+};
+
+#endif // POLLER_H
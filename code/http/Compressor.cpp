@@ -0,0 +1,320 @@
+#include "Compressor.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <sys/resource.h>
+#include <unistd.h>
+
+size_t Compressor::minBytes_ = 256;
+size_t Compressor::maxBytes_ = 1024 * 1024;
+int Compressor::maxLevel_ = 0;
+size_t Compressor::memoBytes_ = 0;
+int Compressor::cpus_ = 1;
+std::atomic<int> Compressor::currentLevel_(1);
+std::atomic<int64_t> Compressor::sampleAt_(0);
+std::atomic<int64_t> Compressor::sampleCpu_(0);
+
+namespace
+{
+    int64_t NowNs(clockid_t clock)
+    {
+        struct timespec ts;
+        clock_gettime(clock, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    int64_t ProcessCpuNs()
+    {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return (static_cast<int64_t>(ru.ru_utime.tv_sec) + ru.ru_stime.tv_sec) * 1000000000LL +
+               (static_cast<int64_t>(ru.ru_utime.tv_usec) + ru.ru_stime.tv_usec) * 1000LL;
+    }
+
+    /**
+     * @brief 压缩结果缓存：键为 路径 + 文件版本，一把锁的 LRU(只在未命中压缩后插入，锁内没有耗时操作)
+     *        不值得压缩的文件记为空条目(按键长计入预算)，同一版本不再重复压缩
+     */
+    struct Memo
+    {
+        using LruList = std::list<std::pair<std::string, const CachedFile *>>; // 最近使用的在前
+
+        std::mutex mtx;
+        LruList lru;
+        std::unordered_map<std::string_view, LruList::iterator> index;
+        size_t bytes = 0;
+
+        static size_t Cost(const std::string &key, const CachedFile *entry)
+        {
+            return entry ? entry->Size() : key.size();
+        }
+
+        /**
+         * @brief 插入条目(缓存持有一个引用)并按预算淘汰；已有同键条目时保留先插入的
+         */
+        void Insert(const std::string &key, const CachedFile *entry, size_t limit)
+        {
+            if (Cost(key, entry) > limit)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            if (index.count(key))
+            {
+                return; // 其他连接同时压缩了同一文件
+            }
+            lru.emplace_front(key, entry);
+            index.emplace(lru.front().first, lru.begin());
+            bytes += Cost(key, entry);
+            if (entry)
+            {
+                FileCache::Pin(entry);
+            }
+            while (bytes > limit)
+            {
+                auto &victim = lru.back();
+                bytes -= Cost(victim.first, victim.second);
+                index.erase(victim.first);
+                FileCache::Unpin(victim.second);
+                lru.pop_back();
+            }
+        }
+
+        ~Memo()
+        {
+            for (auto &entry : lru)
+            {
+                FileCache::Unpin(entry.second);
+            }
+        }
+    };
+
+    Memo memo;
+
+    // 统计
+    std::atomic<uint64_t> compressed(0); // 压缩次数
+    std::atomic<uint64_t> bytesIn(0);
+    std::atomic<uint64_t> bytesOut(0);
+    std::atomic<uint64_t> cpuNs(0); // 压缩占用的线程 CPU 时间
+    std::atomic<uint64_t> memoHits(0);
+}
+
+void Compressor::Init(size_t minBytes, size_t maxBytes, int maxLevel, size_t memoBytes)
+{
+    minBytes_ = std::max<size_t>(minBytes, 1);
+    maxBytes_ = maxBytes;
+    maxLevel_ = std::min(std::max(maxLevel, 0), 9);
+    memoBytes_ = memoBytes;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpus_ = cpus > 0 ? static_cast<int>(cpus) : 1;
+    currentLevel_.store(std::max(maxLevel_, 1), std::memory_order_relaxed);
+}
+
+Compressor::Compressor()
+    : zs_(nullptr),
+      level_(0)
+{
+}
+
+Compressor::~Compressor()
+{
+    Release();
+}
+
+void Compressor::Release()
+{
+    if (zs_)
+    {
+        deflateEnd(zs_);
+        delete zs_;
+        zs_ = nullptr;
+    }
+}
+
+int Compressor::Level_()
+{
+    int64_t now = NowNs(CLOCK_MONOTONIC);
+    int64_t last = sampleAt_.load(std::memory_order_relaxed);
+    // 只有一个线程负责采样
+    if (now - last >= SAMPLE_NS && sampleAt_.compare_exchange_strong(last, now, std::memory_order_relaxed))
+    {
+        int64_t cpu = ProcessCpuNs();
+        int64_t prevCpu = sampleCpu_.exchange(cpu, std::memory_order_relaxed);
+        double busy = static_cast<double>(cpu - prevCpu) / (static_cast<double>(now - last) * cpus_);
+        int level = busy < 0.5 ? maxLevel_ : busy < 0.8 ? std::max(1, maxLevel_ / 2) : 1;
+        currentLevel_.store(level, std::memory_order_relaxed);
+    }
+    return currentLevel_.load(std::memory_order_relaxed);
+}
+
+bool Compressor::Begin_()
+{
+    int level = Level_();
+    if (!zs_)
+    {
+        zs_ = new z_stream;
+        memset(zs_, 0, sizeof(*zs_));
+        if (deflateInit2(zs_, level, Z_DEFLATED, WINDOW_BITS, MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            delete zs_;
+            zs_ = nullptr;
+            return false;
+        }
+        level_ = level;
+        return true;
+    }
+    if (deflateReset(zs_) != Z_OK)
+    {
+        Release();
+        return false;
+    }
+    // 刚重置、还没有输入时修改级别不会产生输出
+    if (level != level_ && deflateParams(zs_, level, Z_DEFAULT_STRATEGY) == Z_OK)
+    {
+        level_ = level;
+    }
+    return true;
+}
+
+bool Compressor::Feed_(const char *data, size_t len, bool last, std::string &out)
+{
+    zs_->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    zs_->avail_in = len;
+    int flush = last ? Z_FINISH : Z_NO_FLUSH;
+    while (true)
+    {
+        size_t used = out.size();
+        out.resize(used + CHUNK);
+        zs_->next_out = reinterpret_cast<Bytef *>(&out[used]);
+        zs_->avail_out = CHUNK;
+        int ret = deflate(zs_, flush);
+        out.resize(used + CHUNK - zs_->avail_out);
+        if (ret == Z_STREAM_ERROR)
+        {
+            return false;
+        }
+        // 输出空间没有用完说明输入已全部消化(Z_FINISH 时要等到流结束)
+        if (last ? ret == Z_STREAM_END : zs_->avail_out != 0)
+        {
+            return true;
+        }
+    }
+}
+
+bool Compressor::Deflate(const char *data, size_t len, std::string &out)
+{
+    if (!Begin_())
+    {
+        return false;
+    }
+    int64_t start = NowNs(CLOCK_THREAD_CPUTIME_ID);
+    out.clear();
+    bool ok = Feed_(data, len, true, out);
+    cpuNs.fetch_add(NowNs(CLOCK_THREAD_CPUTIME_ID) - start, std::memory_order_relaxed);
+    compressed.fetch_add(1, std::memory_order_relaxed);
+    bytesIn.fetch_add(len, std::memory_order_relaxed);
+    bytesOut.fetch_add(out.size(), std::memory_order_relaxed);
+    return ok && out.size() < len;
+}
+
+const CachedFile *Compressor::DeflateFile(const CachedFile *file, const std::string &key)
+{
+    if (memoBytes_)
+    {
+        std::lock_guard<std::mutex> lock(memo.mtx);
+        auto it = memo.index.find(key);
+        if (it != memo.index.end())
+        {
+            memo.lru.splice(memo.lru.begin(), memo.lru, it->second);
+            const CachedFile *hit = it->second->second;
+            if (hit)
+            {
+                FileCache::Pin(hit);
+            }
+            memoHits.fetch_add(1, std::memory_order_relaxed);
+            return hit;
+        }
+    }
+
+    // 未命中：在锁外分块压缩(内容缓存中的副本直接作为一块输入)
+    if (!Begin_())
+    {
+        return nullptr;
+    }
+    int64_t start = NowNs(CLOCK_THREAD_CPUTIME_ID);
+    size_t size = file->Size();
+    std::string out;
+    bool ok = true;
+    if (file->InMemory())
+    {
+        ok = Feed_(file->Data(0), size, true, out);
+    }
+    else
+    {
+        char buf[CHUNK];
+        size_t done = 0;
+        while (ok && done < size)
+        {
+            ssize_t n = pread(file->fd, buf, std::min(size - done, sizeof(buf)), done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                ok = false; // 读取失败或文件已被截断
+                break;
+            }
+            done += n;
+            ok = Feed_(buf, n, done == size, out);
+        }
+    }
+    cpuNs.fetch_add(NowNs(CLOCK_THREAD_CPUTIME_ID) - start, std::memory_order_relaxed);
+    compressed.fetch_add(1, std::memory_order_relaxed);
+    bytesIn.fetch_add(size, std::memory_order_relaxed);
+    bytesOut.fetch_add(out.size(), std::memory_order_relaxed);
+    if (!ok)
+    {
+        return nullptr; // 读取失败不记入缓存，下次重试
+    }
+    if (out.size() >= size)
+    {
+        if (memoBytes_)
+        {
+            memo.Insert(key, nullptr, memoBytes_);
+        }
+        return nullptr;
+    }
+
+    CachedFile *entry = new CachedFile;
+    entry->fd = -1;
+    entry->st = file->st;
+    entry->st.st_size = out.size();
+    entry->data = new char[out.size()];
+    memcpy(entry->data, out.data(), out.size());
+    entry->refs.store(1, std::memory_order_relaxed);
+    if (memoBytes_)
+    {
+        memo.Insert(key, entry, memoBytes_); // 缓存与调用方各一个引用
+    }
+    return entry;
+}
+
+std::string Compressor::Report()
+{
+    size_t entries, bytes;
+    {
+        std::lock_guard<std::mutex> lock(memo.mtx);
+        entries = memo.lru.size();
+        bytes = memo.bytes;
+    }
+    return "compressed=" + std::to_string(compressed.load()) +
+           " bytes=" + std::to_string(bytesIn.load()) + "->" + std::to_string(bytesOut.load()) +
+           " cpuMs=" + std::to_string(cpuNs.load() / 1000000) +
+           " level=" + std::to_string(currentLevel_.load()) +
+           " memoHits=" + std::to_string(memoHits.load()) +
+           " memoEntries=" + std::to_string(entries) +
+           " memoBytes=" + std::to_string(bytes);
+}
@@ -0,0 +1,97 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <zlib.h>
+#include "FileCache.h"
+
+/**
+ * @brief 实时 gzip 压缩：没有预压缩旁路文件的可压缩文件、错误页面与内存正文(处理函数的输出)在生成响应时压缩
+ *        每个连接一个 z_stream：第一次使用时分配，之后 deflateReset 复用，窗口与内部状态大小固定(约 128KB)，
+ *        连接关闭时释放；文件按块读入后送进压缩流，不复制整个原文件
+ *        压缩级别随进程的 CPU 使用率自适应：空闲时用配置的级别，繁忙时降到 1
+ *        文件的压缩结果按 路径 + ino-size-mtime 记在共享的按字节预算的 LRU 中，与内容缓存的条目一样用 Pin 共享
+ */
+class Compressor
+{
+public:
+    /**
+     * @brief 读取配置，只调用一次
+     * @param minBytes  小于它的正文不压缩
+     * @param maxBytes  大于它的正文不实时压缩(大文件用 sendfile 发送原文件更划算)
+     * @param maxLevel  空闲时的压缩级别(1~9)，0 表示关闭实时压缩
+     * @param memoBytes 压缩结果缓存的字节预算，0 表示不缓存
+     */
+    static void Init(size_t minBytes, size_t maxBytes, int maxLevel, size_t memoBytes);
+
+    static bool Enabled() { return maxLevel_ > 0; }
+    static bool Worth(size_t len) { return len >= minBytes_ && len <= maxBytes_; }
+
+    Compressor();
+    ~Compressor();
+    Compressor(const Compressor &) = delete;
+    Compressor &operator=(const Compressor &) = delete;
+
+    /**
+     * @brief 把 [data, data + len) 压缩为 gzip 写入 out
+     * @return 压缩失败或结果不比原文小时返回 false
+     */
+    bool Deflate(const char *data, size_t len, std::string &out);
+
+    /**
+     * @brief 取得文件的 gzip 版本：先查压缩结果缓存，未命中时分块压缩并存入(不值得压缩的结果也记下)
+     * @param key 文件及其版本(路径 + ino-size-mtime)
+     * @return Pin 过的内存条目(调用方 FileCache::Unpin)，失败或不值得压缩时返回 nullptr
+     */
+    const CachedFile *DeflateFile(const CachedFile *file, const std::string &key);
+
+    /**
+     * @brief 释放压缩流(连接关闭时调用)
+     */
+    void Release();
+
+    /**
+     * @brief 压缩次数、字节数、压缩占用的 CPU 时间、当前级别与缓存命中，用于退出时打印日志
+     */
+    static std::string Report();
+
+private:
+    // gzip 头尾 + 16KB 窗口，memLevel 7：每个流约 128KB，对 1MB 以内的文本压缩率损失很小
+    static const int WINDOW_BITS = 14 + 16;
+    static const int MEM_LEVEL = 7;
+    static const size_t CHUNK = 16 * 1024;
+    // 每隔多久重新计算一次 CPU 使用率
+    static const int64_t SAMPLE_NS = 100 * 1000 * 1000;
+
+    /**
+     * @brief 准备压缩流：按需分配，否则重置；级别变化时 deflateParams
+     */
+    bool Begin_();
+
+    /**
+     * @brief 送入一块输入，last 为 true 时结束压缩流
+     */
+    bool Feed_(const char *data, size_t len, bool last, std::string &out);
+
+    /**
+     * @brief 自适应的压缩级别：每 SAMPLE_NS 按 getrusage 计算一次进程的 CPU 使用率
+     */
+    static int Level_();
+
+    z_stream *zs_; // 第一次压缩时分配
+    int level_;    // zs_ 当前的压缩级别
+
+    static size_t minBytes_;
+    static size_t maxBytes_;
+    static int maxLevel_;
+    static size_t memoBytes_;
+    static int cpus_;
+    static std::atomic<int> currentLevel_;
+    static std::atomic<int64_t> sampleAt_;  // 上次采样的单调时钟(ns)
+    static std::atomic<int64_t> sampleCpu_; // 上次采样时进程累计的 CPU 时间(ns)
+};
+
+#endif // COMPRESSOR_H
@@ -0,0 +1,638 @@
+#include "FileCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+namespace
+{
+    // 监视的事件：目录中文件的内容 / 权限变化、增删与改名，以及目录本身被删除 / 移走
+    const uint32_t WATCH_MASK = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    // 打开冷的大文件时预读的字节数
+    const off_t READAHEAD_BYTES = 512 * 1024;
+}
+
+FileCache &FileCache::Instance()
+{
+    static FileCache instance;
+    return instance;
+}
+
+FileCache::FileCache()
+    : shardCapacity_(0),
+      enabled_(false),
+      windowBytes_(0),
+      mainBytes_(0),
+      protectedBytes_(0),
+      maxContentFile_(0),
+      readaheadMin_(0),
+      hits_(0),
+      misses_(0),
+      evictions_(0),
+      rejections_(0),
+      inotifyFd_(-1),
+      stopFd_(-1)
+{
+}
+
+FileCache::~FileCache()
+{
+    if (watcher_.joinable())
+    {
+        uint64_t one = 1;
+        ssize_t n = write(stopFd_, &one, sizeof(one));
+        (void)n;
+        watcher_.join();
+    }
+    if (inotifyFd_ >= 0)
+        close(inotifyFd_);
+    if (stopFd_ >= 0)
+        close(stopFd_);
+    Clear();
+}
+
+void FileCache::Init(const std::string &root, int maxEntries, size_t contentBytes, size_t maxContentFile,
+                     size_t readaheadMin)
+{
+    readaheadMin_ = readaheadMin;
+    root_ = root;
+    if (enabled_ || maxEntries <= 0)
+    {
+        return;
+    }
+    // 没有 inotify 就无法得知文件变化，宁可不缓存也不发送旧内容
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd_ < 0 || stopFd_ < 0)
+    {
+        std::cerr << "inotify init failed, file cache disabled: " << strerror(errno) << std::endl;
+        return;
+    }
+    std::string dir;
+    if (!Normalize_(root, dir))
+    {
+        std::cerr << "srcDir contains \"..\", file cache disabled" << std::endl;
+        return;
+    }
+    Watch_(dir);
+    if (watches_.empty())
+    {
+        std::cerr << "Watch " << root << " failed, file cache disabled" << std::endl;
+        return;
+    }
+    shardCapacity_ = std::max<size_t>(1, static_cast<size_t>(maxEntries) / SHARDS);
+
+    // 预算平分到各片；放不进主区的文件不读入内存
+    size_t shardBytes = contentBytes / SHARDS;
+    windowBytes_ = shardBytes / 100;
+    mainBytes_ = shardBytes - windowBytes_;
+    protectedBytes_ = mainBytes_ / 5 * 4;
+    maxContentFile_ = std::min(maxContentFile, mainBytes_);
+    for (Shard &shard : shards_)
+    {
+        // 按平均 4KB 一个文件估计条目数
+        shard.sketch.Resize(shardBytes / 4096);
+    }
+    enabled_ = true;
+    watcher_ = std::thread(&FileCache::WatchLoop_, this);
+}
+
+bool FileCache::Normalize_(std::string_view path, std::string &key)
+{
+    key.clear();
+    key.reserve(path.size());
+    size_t i = 0;
+    // 开头的 "../" 属于资源目录本身(如默认的 ../resources)，原样保留
+    while (path.compare(i, 3, "../") == 0)
+    {
+        key.append("../");
+        i += 3;
+    }
+    while (i < path.size())
+    {
+        char c = path[i];
+        if (c == '/')
+        {
+            // 合并 "//"，跳过 "/./"
+            if (!key.empty() && key.back() == '/')
+            {
+                i++;
+                continue;
+            }
+            if (path.compare(i, 3, "/./") == 0)
+            {
+                i += 2;
+                continue;
+            }
+            if (path.compare(i, 3, "/..") == 0 && (i + 3 == path.size() || path[i + 3] == '/'))
+            {
+                return false;
+            }
+        }
+        key.push_back(c);
+        i++;
+    }
+    while (key.size() > 1 && key.back() == '/')
+    {
+        key.pop_back();
+    }
+    return true;
+}
+
+const CachedFile *FileCache::Open_(const std::string &path) const
+{
+    // O_NONBLOCK：路径指向 FIFO 时不会阻塞在 open 上
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    CachedFile *file = new CachedFile;
+    file->fd = fd;
+    file->data = nullptr;
+    file->refs.store(1, std::memory_order_relaxed);
+    bool statOk = fstat(fd, &file->st) == 0;
+    if (!statOk || !S_ISREG(file->st.st_mode))
+    {
+        // 目录 / 设备 / FIFO 都不作为静态文件发送
+        int err = !statOk ? errno : S_ISDIR(file->st.st_mode) ? EISDIR : EINVAL;
+        close(fd);
+        delete file;
+        errno = err;
+        return nullptr;
+    }
+    // 刚打开的大文件多半是冷的：加大预读窗口，并让内核立即开始异步读入开头的部分
+    if (readaheadMin_ && file->Size() >= readaheadMin_)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        posix_fadvise(fd, 0, std::min<off_t>(file->st.st_size, READAHEAD_BYTES), POSIX_FADV_WILLNEED);
+    }
+    return file;
+}
+
+void FileCache::Unpin(const CachedFile *file)
+{
+    if (!file || file->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+    delete[] file->data;
+    if (file->fd >= 0)
+    {
+        close(file->fd);
+    }
+    delete file;
+}
+
+const CachedFile *FileCache::Load_(const CachedFile *file)
+{
+    size_t size = file->Size();
+    CachedFile *copy = new CachedFile;
+    copy->fd = -1;
+    copy->st = file->st;
+    copy->data = new char[size];
+    copy->refs.store(1, std::memory_order_relaxed);
+    // pread 由内核从页缓存直接复制
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = pread(file->fd, copy->data + done, size - done, done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            // 读取失败或文件已被截断
+            Unpin(copy);
+            return nullptr;
+        }
+        done += n;
+    }
+    return copy;
+}
+
+bool FileCache::HasDotDot_(std::string_view path)
+{
+    size_t i = 0;
+    // 开头的 "../" 属于资源目录本身(如默认的 ../resources)
+    while (path.compare(i, 3, "../") == 0)
+    {
+        i += 3;
+    }
+    while (i <= path.size())
+    {
+        size_t slash = path.find('/', i);
+        if (slash == std::string_view::npos)
+        {
+            slash = path.size();
+        }
+        if (path.substr(i, slash - i) == "..")
+        {
+            return true;
+        }
+        i = slash + 1;
+    }
+    return false;
+}
+
+const CachedFile *FileCache::Acquire(const std::string &path, bool cacheMissing)
+{
+    // 资源目录之后的 ".." 会越出资源目录，不打开(请求路径已规范化，出现在这里说明拼接有误)
+    std::string_view rel = path;
+    if (!root_.empty() && rel.compare(0, root_.size(), root_) == 0)
+    {
+        rel.remove_prefix(root_.size());
+    }
+    if (HasDotDot_(rel))
+    {
+        errno = ENOENT;
+        return nullptr;
+    }
+
+    std::string key;
+    if (!enabled_ || !Normalize_(path, key))
+    {
+        return Open_(path); // 资源目录本身含 ".." 时不缓存
+    }
+
+    uint64_t hash = std::hash<std::string_view>()(key);
+    Shard &shard = ShardOf_(hash);
+    const CachedFile *file = nullptr;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (maxContentFile_)
+        {
+            // 每次访问都计入频率，包括未命中的，准入时才能认出反复被请求的文件
+            shard.sketch.Increment(hash);
+            if (const CachedFile *hit = ContentHit_(shard, key))
+            {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return hit;
+            }
+        }
+        generation = shard.generation;
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+        {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            file = it->second->second;
+            if (!file)
+            {
+                errno = ENOENT; // 已知不存在
+                return nullptr;
+            }
+            Pin(file);
+        }
+    }
+
+    if (!file)
+    {
+        // 未命中：在锁外打开
+        file = Open_(key);
+        if (!file)
+        {
+            int err = errno;
+            if (cacheMissing && err == ENOENT)
+            {
+                InsertFile_(shard, key, nullptr, generation);
+            }
+            errno = err;
+            return nullptr;
+        }
+        file = InsertFile_(shard, key, file, generation);
+        if (!file)
+        {
+            errno = ENOENT; // 其他线程刚记下了"不存在"
+            return nullptr;
+        }
+    }
+    if (file->Size() == 0 || file->Size() > maxContentFile_)
+    {
+        return file;
+    }
+
+    // 内容未缓存：读入内存，交给窗口；即使没被准入，这次响应也从副本发送
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    const CachedFile *copy = Load_(file);
+    if (!copy)
+    {
+        return file;
+    }
+    Unpin(file);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    if (shard.generation == generation && shard.content.find(key) == shard.content.end())
+    {
+        InsertContent_(shard, key, copy);
+    }
+    return copy;
+}
+
+const CachedFile *FileCache::InsertFile_(Shard &shard, const std::string &key, const CachedFile *file, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    if (shard.generation != generation)
+    {
+        return file; // 打开期间有文件失效，这次不缓存
+    }
+    // 其他线程同时打开了同一文件时只保留先插入的那个
+    auto it = shard.index.find(key);
+    if (it != shard.index.end() && file && !it->second->second)
+    {
+        // 记下"不存在"之后文件刚出现(创建事件尚未处理)：以刚打开的为准
+        it->second->second = file;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        Pin(file);
+        return file;
+    }
+    if (it != shard.index.end())
+    {
+        Unpin(file);
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        file = it->second->second;
+        if (file)
+        {
+            Pin(file);
+        }
+        return file;
+    }
+    if (shard.lru.size() >= shardCapacity_)
+    {
+        auto &victim = shard.lru.back();
+        shard.index.erase(victim.first);
+        Unpin(victim.second);
+        shard.lru.pop_back();
+    }
+    shard.lru.emplace_front(key, file);
+    shard.index.emplace(shard.lru.front().first, shard.lru.begin());
+    if (file)
+    {
+        Pin(file); // 缓存与调用方各一个引用
+    }
+    return file;
+}
+
+const CachedFile *FileCache::ContentHit_(Shard &shard, std::string_view key)
+{
+    auto it = shard.content.find(key);
+    if (it == shard.content.end())
+    {
+        return nullptr;
+    }
+    ContentSlot &slot = it->second;
+    const CachedFile *file = slot.it->second;
+    if (slot.region == PROBATION)
+    {
+        // 试用区再次命中：升入保护区，保护区超出预算时把最久未用的降回试用区
+        shard.regions[PROTECTED].splice(shard.regions[PROTECTED].begin(), shard.regions[PROBATION], slot.it);
+        shard.regionBytes[PROBATION] -= file->Size();
+        shard.regionBytes[PROTECTED] += file->Size();
+        slot.region = PROTECTED;
+        while (shard.regionBytes[PROTECTED] > protectedBytes_ && shard.regions[PROTECTED].size() > 1)
+        {
+            auto last = std::prev(shard.regions[PROTECTED].end());
+            size_t size = last->second->Size();
+            shard.content.find(last->first)->second.region = PROBATION;
+            shard.regions[PROBATION].splice(shard.regions[PROBATION].begin(), shard.regions[PROTECTED], last);
+            shard.regionBytes[PROTECTED] -= size;
+            shard.regionBytes[PROBATION] += size;
+        }
+    }
+    else
+    {
+        LruList &list = shard.regions[slot.region];
+        list.splice(list.begin(), list, slot.it);
+    }
+    Pin(file);
+    return file;
+}
+
+void FileCache::InsertContent_(Shard &shard, const std::string &key, const CachedFile *copy)
+{
+    LruList &window = shard.regions[WINDOW];
+    window.emplace_front(key, copy);
+    shard.content.emplace(window.front().first, ContentSlot{WINDOW, window.begin()});
+    shard.regionBytes[WINDOW] += copy->Size();
+    Pin(copy); // 缓存的引用
+
+    while (shard.regionBytes[WINDOW] > windowBytes_ && !window.empty())
+    {
+        Admit_(shard, std::prev(window.end()));
+    }
+}
+
+void FileCache::Admit_(Shard &shard, LruList::iterator cand)
+{
+    size_t size = cand->second->Size();
+    int freq = shard.sketch.Frequency(std::hash<std::string_view>()(cand->first));
+
+    // 先确认需要挤掉的主区条目(试用区从尾部开始，不够再到保护区)都没有候选者常用，再真正淘汰
+    size_t used = shard.regionBytes[PROBATION] + shard.regionBytes[PROTECTED];
+    bool admit = size <= mainBytes_;
+    size_t freed = 0;
+    for (Region region : {PROBATION, PROTECTED})
+    {
+        LruList &list = shard.regions[region];
+        for (auto it = list.rbegin(); admit && it != list.rend() && used - freed + size > mainBytes_; ++it)
+        {
+            if (freq <= shard.sketch.Frequency(std::hash<std::string_view>()(it->first)))
+            {
+                admit = false;
+            }
+            freed += it->second->Size();
+        }
+    }
+    if (!admit)
+    {
+        rejections_.fetch_add(1, std::memory_order_relaxed);
+        EraseContent_(shard, WINDOW, cand);
+        return;
+    }
+
+    while (shard.regionBytes[PROBATION] + shard.regionBytes[PROTECTED] + size > mainBytes_)
+    {
+        Region region = shard.regions[PROBATION].empty() ? PROTECTED : PROBATION;
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        EraseContent_(shard, region, std::prev(shard.regions[region].end()));
+    }
+    shard.content.find(cand->first)->second.region = PROBATION;
+    shard.regions[PROBATION].splice(shard.regions[PROBATION].begin(), shard.regions[WINDOW], cand);
+    shard.regionBytes[WINDOW] -= size;
+    shard.regionBytes[PROBATION] += size;
+}
+
+void FileCache::EraseContent_(Shard &shard, Region region, LruList::iterator it)
+{
+    const CachedFile *file = it->second;
+    shard.regionBytes[region] -= file->Size();
+    shard.content.erase(it->first);
+    shard.regions[region].erase(it);
+    Unpin(file);
+}
+
+void FileCache::Invalidate_(const std::string &key)
+{
+    Shard &shard = ShardOf_(std::hash<std::string_view>()(key));
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    shard.generation++;
+    auto content = shard.content.find(key);
+    if (content != shard.content.end())
+    {
+        EraseContent_(shard, content->second.region, content->second.it);
+    }
+    auto it = shard.index.find(key);
+    if (it == shard.index.end())
+    {
+        return;
+    }
+    auto node = it->second;
+    shard.index.erase(it);
+    Unpin(node->second);
+    shard.lru.erase(node);
+}
+
+void FileCache::Clear()
+{
+    for (Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.generation++;
+        shard.index.clear();
+        for (auto &entry : shard.lru)
+        {
+            Unpin(entry.second);
+        }
+        shard.lru.clear();
+        shard.content.clear();
+        for (int r = 0; r < REGIONS; r++)
+        {
+            for (auto &entry : shard.regions[r])
+            {
+                Unpin(entry.second);
+            }
+            shard.regions[r].clear();
+            shard.regionBytes[r] = 0;
+        }
+    }
+}
+
+std::string FileCache::Report()
+{
+    size_t bytes = 0;
+    size_t entries = 0;
+    for (Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        for (int r = 0; r < REGIONS; r++)
+        {
+            bytes += shard.regionBytes[r];
+        }
+        entries += shard.content.size();
+    }
+    return "contentHits=" + std::to_string(hits_.load()) +
+           " misses=" + std::to_string(misses_.load()) +
+           " evictions=" + std::to_string(evictions_.load()) +
+           " rejected=" + std::to_string(rejections_.load()) +
+           " entries=" + std::to_string(entries) +
+           " bytes=" + std::to_string(bytes);
+}
+
+void FileCache::Watch_(const std::string &dir)
+{
+    int wd = inotify_add_watch(inotifyFd_, dir.c_str(), WATCH_MASK);
+    if (wd < 0)
+    {
+        std::cerr << "inotify watch " << dir << " failed: " << strerror(errno) << std::endl;
+        return;
+    }
+    watches_[wd] = dir;
+
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+    {
+        return;
+    }
+    while (struct dirent *ent = readdir(d))
+    {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+            continue;
+        std::string sub = dir + "/" + ent->d_name;
+        struct stat st;
+        if (ent->d_type == DT_DIR || (ent->d_type == DT_UNKNOWN && lstat(sub.c_str(), &st) == 0 && S_ISDIR(st.st_mode)))
+        {
+            Watch_(sub);
+        }
+    }
+    closedir(d);
+}
+
+void FileCache::WatchLoop_()
+{
+    alignas(struct inotify_event) char buf[16 * 1024];
+    struct pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {stopFd_, POLLIN, 0}};
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents)
+        {
+            break;
+        }
+        ssize_t n = read(inotifyFd_, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            continue;
+        }
+        for (char *p = buf; p < buf + n;)
+        {
+            const struct inotify_event *ev = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                // 丢了事件，无法知道哪些文件变了
+                Clear();
+                continue;
+            }
+            auto it = watches_.find(ev->wd);
+            if (it == watches_.end())
+            {
+                continue;
+            }
+            if (ev->mask & IN_IGNORED)
+            {
+                watches_.erase(it);
+                continue;
+            }
+            if (ev->len == 0)
+            {
+                // 监视的目录本身被删除 / 移走：其下的条目都可能失效
+                if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                    Clear();
+                continue;
+            }
+
+            std::string path = it->second + "/" + ev->name;
+            if (ev->mask & IN_ISDIR)
+            {
+                // 子目录移入 / 新建：开始监视；开始监视之前可能已缓存了其中的文件，
+                // 移走 / 删除时路径下的条目也都不再对应，统一清空
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                    Watch_(path);
+                Clear();
+                continue;
+            }
+            Invalidate_(path);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <sys/stat.h>
+#include "FrequencySketch.h"
+
+/**
+ * @brief 缓存中的一个静态文件：打开的 fd 与 stat 信息(正文用 sendfile 从 fd 发送)，
+ *        或者(内容缓存)读入内存的文件副本，此时没有 fd，用 writev 发送，不会缺页
+ *        不映射文件：文件被截断时 sendfile 返回错误，而不是访问映射时收到 SIGBUS
+ *        通过引用计数共享：缓存本身持有一个引用，每个正在发送它的响应段各持有一个(Pin)，
+ *        被淘汰 / 失效后最后一个 Unpin 负责释放
+ */
+struct CachedFile
+{
+    int fd;              // O_RDONLY | O_CLOEXEC，内存副本为 -1
+    struct stat st;      // 打开时的 stat 信息
+    char *data;          // 内存副本(new[])，没有时为 nullptr
+    mutable std::atomic<int> refs;
+
+    bool InMemory() const { return data != nullptr; }
+    const char *Data(size_t off) const { return data + off; }
+    size_t Size() const { return static_cast<size_t>(st.st_size); }
+};
+
+/**
+ * @brief 打开文件缓存：按规范化路径共享 fd / stat，热点文件每次请求不再 stat / open / close
+ *        资源目录之后含 ".." 段的路径一律拒绝(ENOENT)；资源目录本身含 ".." 时不缓存，每次打开
+ *        分片的 LRU(每片一把锁)，条目数有上限；资源目录由 inotify 监视，文件变更 / 删除 / 改名时失效
+ *        inotify 不可用或上限为 0 时不缓存，每次 Acquire 打开一个只属于调用方的条目
+ *
+ *        另有按字节预算的内容缓存：不超过 maxContentFile 的文件读入内存，命中时直接从内存发送
+ *        准入与淘汰使用 W-TinyLFU：新条目先进入占预算 1% 的窗口 LRU，被挤出窗口时与主区(试用 / 保护两段 LRU)
+ *        的淘汰候选比较 count-min sketch 估计的访问频率，更常用才能进入主区，爬虫式的一次性扫描挤不掉热点文件
+ */
+class FileCache
+{
+public:
+    static FileCache &Instance();
+
+    /**
+     * @brief 开始监视资源目录(含子目录)，只调用一次
+     * @param root           资源目录
+     * @param maxEntries     缓存的打开文件数上限，0 表示不缓存
+     * @param contentBytes   内容缓存的字节预算，0 表示不缓存内容
+     * @param maxContentFile 读入内容缓存的单个文件大小上限
+     * @param readaheadMin   不小于它的文件在打开时给出顺序读 / 预读提示(posix_fadvise)
+     */
+    void Init(const std::string &root, int maxEntries, size_t contentBytes, size_t maxContentFile,
+              size_t readaheadMin);
+
+    /**
+     * @brief 取得 path 对应的文件并 Pin 一次，调用方用完后 Unpin
+     * @param cacheMissing 文件不存在时也记入缓存(如预压缩的旁路文件，大多数不存在)，
+     *                     之后的查询不再 open，文件出现时由 inotify 清除
+     * @return 失败返回 nullptr，errno 说明原因(ENOENT / EACCES / EISDIR ...)；
+     *         资源目录之后含 ".." 段时返回 nullptr 且 errno 为 ENOENT
+     */
+    const CachedFile *Acquire(const std::string &path, bool cacheMissing = false);
+
+    static void Pin(const CachedFile *file) { file->refs.fetch_add(1, std::memory_order_relaxed); }
+    static void Unpin(const CachedFile *file);
+
+    /**
+     * @brief 丢弃所有缓存的条目(正在发送的条目在最后一个 Unpin 时释放)
+     */
+    void Clear();
+
+    /**
+     * @brief 内容缓存的统计：命中 / 未命中 / 淘汰 / 拒绝准入次数与当前字节数，用于退出时打印日志
+     */
+    std::string Report();
+
+    ~FileCache();
+
+private:
+    static const int SHARDS = 16;
+
+    using LruList = std::list<std::pair<std::string, const CachedFile *>>; // 最近使用的在前，文件为空表示不存在
+
+    // 内容缓存的三个区域
+    enum Region : uint8_t
+    {
+        WINDOW,    // 新条目
+        PROBATION, // 主区：进入主区后尚未再次命中
+        PROTECTED, // 主区：在试用区再次命中过
+        REGIONS,
+    };
+
+    struct ContentSlot
+    {
+        Region region;
+        LruList::iterator it;
+    };
+
+    struct Shard
+    {
+        std::mutex mtx;
+        LruList lru;
+        std::unordered_map<std::string_view, LruList::iterator> index;
+        uint64_t generation = 0; // 每次失效加一：打开文件期间发生失效时不插入，避免缓存旧内容
+
+        LruList regions[REGIONS];
+        size_t regionBytes[REGIONS] = {};
+        std::unordered_map<std::string_view, ContentSlot> content;
+        FrequencySketch sketch;
+    };
+
+    FileCache();
+
+    /**
+     * @brief 打开文件，返回引用计数为 1 的条目；大文件(此时多半不在页缓存中)给出预读提示
+     */
+    const CachedFile *Open_(const std::string &path) const;
+
+    /**
+     * @brief 合并重复的 '/'、去掉 "/./"；含 ".." 的路径返回 false(资源目录本身含 ".." 时不缓存，inotify 事件无法对应)
+     */
+    static bool Normalize_(std::string_view path, std::string &key);
+
+    /**
+     * @brief 是否含 ".." 段(开头属于资源目录的 "../" 除外)
+     */
+    static bool HasDotDot_(std::string_view path);
+
+    Shard &ShardOf_(uint64_t hash) { return shards_[(hash >> 32) % SHARDS]; }
+
+    /**
+     * @brief 打开文件后插入打开文件缓存(打开期间没有发生失效时)，返回调用方持有的条目；
+     *        file 为空表示记下"文件不存在"
+     */
+    const CachedFile *InsertFile_(Shard &shard, const std::string &key, const CachedFile *file, uint64_t generation);
+
+    /**
+     * @brief 把文件内容读入内存，返回引用计数为 1 的副本
+     */
+    static const CachedFile *Load_(const CachedFile *file);
+
+    /**
+     * @brief 内容缓存命中：更新所在区域的 LRU 位置(试用区命中升入保护区)，Pin 后返回
+     */
+    const CachedFile *ContentHit_(Shard &shard, std::string_view key);
+
+    /**
+     * @brief 新条目放入窗口，窗口超出预算时把最旧的条目交给 Admit_
+     */
+    void InsertContent_(Shard &shard, const std::string &key, const CachedFile *copy);
+
+    /**
+     * @brief TinyLFU 准入：候选者的频率高于需要挤掉的每个主区条目时进入试用区，否则丢弃
+     */
+    void Admit_(Shard &shard, LruList::iterator cand);
+
+    void EraseContent_(Shard &shard, Region region, LruList::iterator it);
+
+    void Invalidate_(const std::string &key);
+
+    /**
+     * @brief 递归地为目录及其子目录添加监视
+     */
+    void Watch_(const std::string &dir);
+
+    /**
+     * @brief 监视线程：读取 inotify 事件，使对应的条目失效
+     */
+    void WatchLoop_();
+
+    Shard shards_[SHARDS];
+    size_t shardCapacity_; // 每片的条目数上限，0 表示不缓存
+    bool enabled_;
+
+    // 每片的内容缓存预算：窗口 1%，其余为主区，其中保护区最多占 80%
+    size_t windowBytes_;
+    size_t mainBytes_;
+    size_t protectedBytes_;
+    size_t maxContentFile_; // 0 表示不缓存内容
+    size_t readaheadMin_;   // 0 表示不给预读提示
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> evictions_;
+    std::atomic<uint64_t> rejections_;
+
+    std::string root_; // 资源目录(Init 传入的原样)
+    int inotifyFd_;
+    int stopFd_; // eventfd：析构时唤醒监视线程
+    std::unordered_map<int, std::string> watches_; // wd -> 目录(只在监视线程与 Init 中访问)
+    std::thread watcher_;
+};
+
+#endif // FILE_CACHE_H
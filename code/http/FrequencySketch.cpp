@@ -0,0 +1,77 @@
+#include "FrequencySketch.h"
+#include <algorithm>
+
+namespace
+{
+    // 每行使用不同的奇数乘子打散 hash
+    const uint64_t SEEDS[] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                              0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL};
+}
+
+FrequencySketch::FrequencySketch(size_t expectedEntries)
+    : width_(0),
+      additions_(0),
+      sampleSize_(0)
+{
+    Resize(expectedEntries);
+}
+
+void FrequencySketch::Resize(size_t expectedEntries)
+{
+    width_ = 64;
+    while (width_ < expectedEntries)
+    {
+        width_ <<= 1;
+    }
+    table_.assign(DEPTH * width_ / 2, 0);
+    additions_ = 0;
+    sampleSize_ = 10 * width_;
+}
+
+size_t FrequencySketch::Index_(uint64_t hash, int row) const
+{
+    uint64_t h = hash * SEEDS[row];
+    h ^= h >> 32;
+    return row * width_ + (h & (width_ - 1));
+}
+
+void FrequencySketch::Increment(uint64_t hash)
+{
+    bool added = false;
+    for (int row = 0; row < DEPTH; row++)
+    {
+        size_t idx = Index_(hash, row);
+        uint8_t &cell = table_[idx >> 1];
+        int shift = (idx & 1) * 4;
+        if (((cell >> shift) & 0xf) < MAX_COUNT)
+        {
+            cell += 1 << shift;
+            added = true;
+        }
+    }
+    if (added && ++additions_ >= sampleSize_)
+    {
+        Reset_();
+    }
+}
+
+int FrequencySketch::Frequency(uint64_t hash) const
+{
+    int freq = MAX_COUNT;
+    for (int row = 0; row < DEPTH; row++)
+    {
+        size_t idx = Index_(hash, row);
+        freq = std::min(freq, (table_[idx >> 1] >> ((idx & 1) * 4)) & 0xf);
+    }
+    return freq;
+}
+
+void FrequencySketch::Reset_()
+{
+    // 两个 4 位计数器同时右移一位，去掉从高位计数器移进低位计数器的那一位
+    for (uint8_t &cell : table_)
+    {
+        cell = (cell >> 1) & 0x77;
+    }
+    additions_ /= 2;
+}
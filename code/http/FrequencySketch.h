@@ -0,0 +1,50 @@
+#ifndef FREQUENCY_SKETCH_H
+#define FREQUENCY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief TinyLFU 的访问频率估计：4 行 count-min sketch，计数器 4 位(饱和于 15)
+ *        累计记录次数达到 10 倍宽度时所有计数器减半，使频率随时间衰减，旧的热点不会一直占着缓存
+ *        不加锁，由调用方(FileCache 的分片锁)保护
+ */
+class FrequencySketch
+{
+public:
+    /**
+     * @param expectedEntries 预计同时缓存的条目数，决定每行的计数器个数(向上取 2 的幂)
+     */
+    explicit FrequencySketch(size_t expectedEntries = 0);
+
+    void Resize(size_t expectedEntries);
+
+    /**
+     * @brief 记录一次访问
+     */
+    void Increment(uint64_t hash);
+
+    /**
+     * @brief 估计的访问次数(各行计数的最小值)
+     */
+    int Frequency(uint64_t hash) const;
+
+private:
+    static const int DEPTH = 4;
+    static const int MAX_COUNT = 15;
+
+    size_t Index_(uint64_t hash, int row) const;
+
+    /**
+     * @brief 所有计数器减半(衰减)
+     */
+    void Reset_();
+
+    std::vector<uint8_t> table_; // DEPTH 行，每行 width_ 个计数器(每个字节存两个 4 位计数器)
+    size_t width_;               // 每行计数器数，2 的幂
+    size_t additions_;           // 上次衰减后的记录次数
+    size_t sampleSize_;          // 达到后衰减
+};
+
+#endif // FREQUENCY_SKETCH_H
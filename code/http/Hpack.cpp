@@ -0,0 +1,470 @@
+#include "Hpack.h"
+#include <cstdio>
+
+namespace
+{
+    /**
+     * @brief 静态表(RFC 7541 附录 A)，下标 + 1 即索引
+     */
+    const Hpack::StaticEntry STATIC_TABLE[] = {
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""},
+    };
+    const size_t STATIC_COUNT = sizeof(STATIC_TABLE) / sizeof(STATIC_TABLE[0]);
+
+    /**
+     * @brief Huffman 编码表(RFC 7541 附录 B)：符号 0~255 的码字与位数，EOS(256)为 30 个 1
+     */
+    const uint32_t HUFFMAN_CODES[256] = {
+        0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+        0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+        0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+        0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+        0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+        0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+        0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+        0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+        0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+        0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+        0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+        0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+        0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+        0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+        0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+        0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+        0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+        0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+        0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+        0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+        0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+        0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+        0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+        0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+        0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+        0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+        0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+        0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+        0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+        0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+        0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+        0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+    };
+    const uint8_t HUFFMAN_LENS[256] = {
+        13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+        28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+        6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+        5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+        13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+        7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+        15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+        6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+        20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+        24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+        22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+        21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+        26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+        19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+        20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+        26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    };
+
+    // 整数 / 字符串长度的上限：远大于任何合法的头部，防止溢出
+    const uint64_t MAX_INTEGER = 1u << 30;
+
+    // Huffman 解码树：节点 child[0/1] 为子节点下标(0 表示没有)，叶子的 sym >= 0(256 为 EOS)
+    // 257 个叶子的满二叉树共 2 * 257 - 1 个节点
+    struct HuffmanNode
+    {
+        int16_t child[2];
+        int16_t sym;
+    };
+
+    struct HuffmanTree
+    {
+        HuffmanNode nodes[2 * 257 - 1];
+        int count;
+
+        HuffmanTree() : nodes(), count(1)
+        {
+            nodes[0] = {{0, 0}, -1};
+            for (int sym = 0; sym <= 256; sym++)
+            {
+                uint32_t code = sym < 256 ? HUFFMAN_CODES[sym] : 0x3fffffff;
+                int len = sym < 256 ? HUFFMAN_LENS[sym] : 30;
+                int cur = 0;
+                for (int i = len - 1; i >= 0; i--)
+                {
+                    int bit = (code >> i) & 1;
+                    if (!nodes[cur].child[bit])
+                    {
+                        nodes[count] = {{0, 0}, -1};
+                        nodes[cur].child[bit] = static_cast<int16_t>(count++);
+                    }
+                    cur = nodes[cur].child[bit];
+                }
+                nodes[cur].sym = static_cast<int16_t>(sym);
+            }
+        }
+    };
+
+    const HuffmanTree &Tree()
+    {
+        static const HuffmanTree tree;
+        return tree;
+    }
+
+    /**
+     * @brief 解码带 prefixBits 位前缀的整数，pos 前进到整数之后
+     */
+    bool DecodeInteger(const uint8_t *data, size_t len, size_t &pos, int prefixBits, uint64_t &value)
+    {
+        if (pos >= len)
+            return false;
+        uint64_t mask = (1u << prefixBits) - 1;
+        value = data[pos++] & mask;
+        if (value < mask)
+            return true;
+        int shift = 0;
+        while (pos < len)
+        {
+            uint8_t b = data[pos++];
+            value += static_cast<uint64_t>(b & 0x7f) << shift;
+            if (value > MAX_INTEGER)
+                return false;
+            if (!(b & 0x80))
+                return true;
+            shift += 7;
+            // 0x80 续字节(值为 0)不会让 value 超限，单独限制位移，避免移位超过 64 位
+            if (shift > 28)
+                return false;
+        }
+        return false;
+    }
+
+    bool DecodeString(const uint8_t *data, size_t len, size_t &pos, std::string &out)
+    {
+        if (pos >= len)
+            return false;
+        bool huffman = data[pos] & 0x80;
+        uint64_t n;
+        if (!DecodeInteger(data, len, pos, 7, n) || n > len - pos)
+            return false;
+        out.clear();
+        if (huffman)
+        {
+            if (!Hpack::HuffmanDecode(data + pos, n, out))
+                return false;
+        }
+        else
+        {
+            out.assign(reinterpret_cast<const char *>(data + pos), n);
+        }
+        pos += n;
+        return true;
+    }
+
+    void EncodeString(std::string_view s, std::string &out)
+    {
+        size_t huffLen = Hpack::HuffmanLength(s);
+        if (huffLen < s.size())
+        {
+            Hpack::EncodeInteger(huffLen, 7, 0x80, out);
+            Hpack::HuffmanEncode(s, out);
+        }
+        else
+        {
+            Hpack::EncodeInteger(s.size(), 7, 0x00, out);
+            out.append(s.data(), s.size());
+        }
+    }
+}
+
+namespace Hpack
+{
+    /* ---------------- Huffman ---------------- */
+
+    bool HuffmanDecode(const uint8_t *data, size_t len, std::string &out)
+    {
+        const HuffmanTree &tree = Tree();
+        int cur = 0;
+        int depth = 0;      // 自上一个符号以来的位数
+        bool allOnes = true; // 这些位是否全为 1(合法的填充)
+        for (size_t i = 0; i < len; i++)
+        {
+            for (int b = 7; b >= 0; b--)
+            {
+                int bit = (data[i] >> b) & 1;
+                cur = tree.nodes[cur].child[bit];
+                if (!cur)
+                    return false;
+                depth++;
+                allOnes = allOnes && bit;
+                int sym = tree.nodes[cur].sym;
+                if (sym >= 0)
+                {
+                    if (sym == 256)
+                        return false; // EOS 不能出现在数据中
+                    out.push_back(static_cast<char>(sym));
+                    cur = 0;
+                    depth = 0;
+                    allOnes = true;
+                }
+            }
+        }
+        // 填充必须是 EOS 的前缀(全 1)且不超过 7 位
+        return depth <= 7 && allOnes;
+    }
+
+    size_t HuffmanLength(std::string_view s)
+    {
+        size_t bits = 0;
+        for (char ch : s)
+        {
+            bits += HUFFMAN_LENS[static_cast<uint8_t>(ch)];
+        }
+        return (bits + 7) / 8;
+    }
+
+    void HuffmanEncode(std::string_view s, std::string &out)
+    {
+        uint64_t acc = 0;
+        int bits = 0;
+        for (char ch : s)
+        {
+            uint8_t sym = static_cast<uint8_t>(ch);
+            acc = (acc << HUFFMAN_LENS[sym]) | HUFFMAN_CODES[sym];
+            bits += HUFFMAN_LENS[sym];
+            while (bits >= 8)
+            {
+                bits -= 8;
+                out.push_back(static_cast<char>(acc >> bits));
+            }
+        }
+        if (bits > 0)
+        {
+            // 用 EOS 的高位(全 1)填满最后一个字节
+            out.push_back(static_cast<char>((acc << (8 - bits)) | (0xff >> bits)));
+        }
+    }
+
+    /* ---------------- 整数 ---------------- */
+
+    void EncodeInteger(uint64_t value, int prefixBits, uint8_t first, std::string &out)
+    {
+        uint64_t mask = (1u << prefixBits) - 1;
+        if (value < mask)
+        {
+            out.push_back(static_cast<char>(first | value));
+            return;
+        }
+        out.push_back(static_cast<char>(first | mask));
+        value -= mask;
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /* ---------------- 解码器 ---------------- */
+
+    Decoder::Decoder(size_t maxTableSize)
+        : size_(0), maxSize_(maxTableSize), settingsMax_(maxTableSize)
+    {
+    }
+
+    bool Decoder::Lookup_(uint64_t index, Header &out) const
+    {
+        if (index == 0)
+            return false;
+        if (index <= STATIC_COUNT)
+        {
+            const StaticEntry &e = STATIC_TABLE[index - 1];
+            out.name.assign(e.name.data(), e.name.size());
+            out.value.assign(e.value.data(), e.value.size());
+            return true;
+        }
+        index -= STATIC_COUNT + 1;
+        if (index >= dynamic_.size())
+            return false;
+        out = dynamic_[index];
+        return true;
+    }
+
+    void Decoder::Evict_(size_t limit)
+    {
+        while (size_ > limit && !dynamic_.empty())
+        {
+            const Header &h = dynamic_.back();
+            size_ -= h.name.size() + h.value.size() + 32;
+            dynamic_.pop_back();
+        }
+    }
+
+    void Decoder::Insert_(Header header)
+    {
+        size_t entrySize = header.name.size() + header.value.size() + 32;
+        if (entrySize > maxSize_)
+        {
+            // 比整张表还大：清空表，不插入(RFC 7541 4.4)
+            Evict_(0);
+            return;
+        }
+        Evict_(maxSize_ - entrySize);
+        size_ += entrySize;
+        dynamic_.push_front(std::move(header));
+    }
+
+    bool Decoder::Decode(const uint8_t *data, size_t len, std::vector<Header> &headers, size_t maxListSize)
+    {
+        size_t pos = 0;
+        size_t listSize = 0;
+        bool fieldSeen = false;
+        while (pos < len)
+        {
+            uint8_t b = data[pos];
+            Header header;
+            uint64_t index;
+            if (b & 0x80)
+            {
+                // 索引字段
+                if (!DecodeInteger(data, len, pos, 7, index) || !Lookup_(index, header))
+                    return false;
+            }
+            else if ((b & 0xe0) == 0x20)
+            {
+                // 动态表大小更新：只能出现在头块开头
+                if (fieldSeen || !DecodeInteger(data, len, pos, 5, index) || index > settingsMax_)
+                    return false;
+                maxSize_ = index;
+                Evict_(maxSize_);
+                continue;
+            }
+            else
+            {
+                // 字面量：01 增量索引(6 位前缀)，0000 不索引 / 0001 永不索引(4 位前缀)
+                bool indexing = b & 0x40;
+                if (!DecodeInteger(data, len, pos, indexing ? 6 : 4, index))
+                    return false;
+                if (index)
+                {
+                    Header named;
+                    if (!Lookup_(index, named))
+                        return false;
+                    header.name = std::move(named.name);
+                }
+                else if (!DecodeString(data, len, pos, header.name))
+                {
+                    return false;
+                }
+                if (!DecodeString(data, len, pos, header.value))
+                    return false;
+                if (indexing)
+                    Insert_(header);
+            }
+            fieldSeen = true;
+            listSize += header.name.size() + header.value.size() + 32;
+            if (listSize > maxListSize)
+                return false;
+            headers.push_back(std::move(header));
+        }
+        return true;
+    }
+
+    /* ---------------- 编码 ---------------- */
+
+    void EncodeStatus(int code, std::string &out)
+    {
+        // 静态表 8~14 为 :status 200/204/206/304/400/404/500
+        static const int INDEXED[] = {200, 204, 206, 304, 400, 404, 500};
+        for (int i = 0; i < 7; i++)
+        {
+            if (INDEXED[i] == code)
+            {
+                EncodeInteger(8 + i, 7, 0x80, out);
+                return;
+            }
+        }
+        char buf[8];
+        int n = snprintf(buf, sizeof(buf), "%03d", code);
+        EncodeInteger(8, 4, 0x00, out);
+        EncodeString(std::string_view(buf, n), out);
+    }
+
+    void EncodeHeader(std::string_view name, std::string_view value, std::string &out)
+    {
+        uint64_t nameIndex = 0;
+        for (size_t i = 0; i < STATIC_COUNT; i++)
+        {
+            if (STATIC_TABLE[i].name == name)
+            {
+                nameIndex = i + 1;
+                break;
+            }
+        }
+        EncodeInteger(nameIndex, 4, 0x00, out);
+        if (!nameIndex)
+            EncodeString(name, out);
+        EncodeString(value, out);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef HPACK_H
+#define HPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief HPACK(RFC 7541)头部压缩：解码客户端的请求头块，编码响应头
+ */
+namespace Hpack
+{
+    struct Header
+    {
+        std::string name;
+        std::string value;
+    };
+
+    struct StaticEntry
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /**
+     * @brief 解码器：每个连接一个，动态表跨头块保持
+     */
+    class Decoder
+    {
+    public:
+        /**
+         * @param maxTableSize 我方 SETTINGS_HEADER_TABLE_SIZE(默认 4096)，动态表大小更新不能超过它
+         */
+        explicit Decoder(size_t maxTableSize = 4096);
+
+        /**
+         * @brief 解码一个完整的头块(HEADERS + CONTINUATION 拼接后)，结果追加到 headers
+         * @param maxListSize 解码后的头部总大小上限(每个字段按 名字 + 值 + 32 计)
+         * @return false 表示压缩错误(连接错误 COMPRESSION_ERROR)或超过上限
+         */
+        bool Decode(const uint8_t *data, size_t len, std::vector<Header> &headers, size_t maxListSize);
+
+    private:
+        bool Lookup_(uint64_t index, Header &out) const;
+        void Insert_(Header header);
+        void Evict_(size_t limit);
+
+        std::deque<Header> dynamic_; // 最新的在前
+        size_t size_;                // 动态表当前大小
+        size_t maxSize_;             // 编码方设定的动态表上限
+        size_t settingsMax_;         // 我方允许的上限
+    };
+
+    /**
+     * @brief 编码 :status(常用状态码使用静态表索引)
+     */
+    void EncodeStatus(int code, std::string &out);
+
+    /**
+     * @brief 以"不索引的字面量"编码一个响应头(name 为小写)：名字在静态表中时使用索引，
+     *        值在 Huffman 编码更短时使用 Huffman；不写入动态表，编码端不需要维护状态
+     */
+    void EncodeHeader(std::string_view name, std::string_view value, std::string &out);
+
+    /**
+     * @brief 带 prefixBits 位前缀的整数编码，first 为首字节中前缀之外的高位
+     */
+    void EncodeInteger(uint64_t value, int prefixBits, uint8_t first, std::string &out);
+
+    /**
+     * @brief Huffman 解码，填充位不合法或遇到 EOS 时返回 false
+     */
+    bool HuffmanDecode(const uint8_t *data, size_t len, std::string &out);
+
+    /**
+     * @brief Huffman 编码后的字节数
+     */
+    size_t HuffmanLength(std::string_view s);
+
+    void HuffmanEncode(std::string_view s, std::string &out);
+}
+
+#endif // HPACK_H
@@ -0,0 +1,1188 @@
+#include "Http2Session.h"
+#include "HttpConn.h"
+#include <algorithm>
+#include <cstring>
+
+const char Http2Session::PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+namespace
+{
+    // 帧标志
+    const uint8_t FLAG_END_STREAM = 0x1;
+    const uint8_t FLAG_ACK = 0x1;
+    const uint8_t FLAG_END_HEADERS = 0x4;
+    const uint8_t FLAG_PADDED = 0x8;
+    const uint8_t FLAG_PRIORITY = 0x20;
+
+    // SETTINGS 参数
+    const uint16_t SETTINGS_ENABLE_PUSH = 0x2;
+    const uint16_t SETTINGS_MAX_CONCURRENT_STREAMS = 0x3;
+    const uint16_t SETTINGS_INITIAL_WINDOW_SIZE = 0x4;
+    const uint16_t SETTINGS_MAX_FRAME_SIZE = 0x5;
+    const uint16_t SETTINGS_MAX_HEADER_LIST_SIZE = 0x6;
+
+    uint32_t Get32(const uint8_t *p)
+    {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    void Put16(char *p, uint32_t v)
+    {
+        p[0] = static_cast<char>(v >> 8);
+        p[1] = static_cast<char>(v);
+    }
+
+    void Put32(char *p, uint32_t v)
+    {
+        p[0] = static_cast<char>(v >> 24);
+        p[1] = static_cast<char>(v >> 16);
+        p[2] = static_cast<char>(v >> 8);
+        p[3] = static_cast<char>(v);
+    }
+
+    /**
+     * @brief HTTP2-Settings 为 base64url 编码(可省略填充)
+     */
+    bool Base64UrlDecode(std::string_view in, std::string &out)
+    {
+        uint32_t acc = 0;
+        int bits = 0;
+        for (char ch : in)
+        {
+            int v;
+            if (ch >= 'A' && ch <= 'Z')
+                v = ch - 'A';
+            else if (ch >= 'a' && ch <= 'z')
+                v = ch - 'a' + 26;
+            else if (ch >= '0' && ch <= '9')
+                v = ch - '0' + 52;
+            else if (ch == '-')
+                v = 62;
+            else if (ch == '_')
+                v = 63;
+            else if (ch == '=')
+                break;
+            else
+                return false;
+            acc = (acc << 6) | static_cast<uint32_t>(v);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                out.push_back(static_cast<char>(acc >> bits));
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief HTTP/2 中禁止出现的逐跳(连接相关)头部，响应转换时同样丢弃
+     */
+    bool IsConnectionHeader(std::string_view name)
+    {
+        return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+               name == "transfer-encoding" || name == "upgrade";
+    }
+}
+
+Http2Session::Http2Session(HttpConn &conn)
+    : conn_(conn),
+      decoder_(4096),
+      prefaceReceived_(false),
+      settingsReceived_(false),
+      goAwaySent_(false),
+      peerGoAway_(false),
+      failed_(false),
+      closing_(false),
+      lastStreamId_(0),
+      connSendWindow_(DEFAULT_WINDOW),
+      connRecvWindow_(DEFAULT_WINDOW),
+      initialWindow_(DEFAULT_WINDOW),
+      peerMaxFrame_(16384),
+      connCredit_(0),
+      vtime_(0),
+      blockStream_(0),
+      blockFlags_(0),
+      blockHasPriority_(false),
+      blockPriority_{0, 16, false}
+{
+}
+
+Http2Session::~Http2Session()
+{
+    // 段队列已由 HttpConn 清空，流仍持有的文件引用在这里释放
+    while (!streams_.empty())
+    {
+        EraseStream_(streams_.begin()->first);
+    }
+}
+
+int Http2Session::MatchPreface(const Buffer &buff)
+{
+    size_t n = std::min(buff.ReadableBytes(), static_cast<size_t>(PREFACE_LEN));
+    if (memcmp(buff.Peek(), PREFACE, n) != 0)
+    {
+        return -1;
+    }
+    return n == PREFACE_LEN ? 1 : 0;
+}
+
+bool Http2Session::ApplyUpgradeSettings(std::string_view settings)
+{
+    std::string payload;
+    if (!Base64UrlDecode(settings, payload) || payload.size() % 6 != 0)
+    {
+        return false;
+    }
+    return ApplySettings_(reinterpret_cast<const uint8_t *>(payload.data()),
+                          static_cast<uint32_t>(payload.size())) == NO_ERROR;
+}
+
+void Http2Session::Start(bool upgraded)
+{
+    SendSettings_();
+    // 连接级窗口只能用 WINDOW_UPDATE 调大：放到请求体缓存上限
+    if (ConnRecvLimit_() > connRecvWindow_)
+    {
+        SendWindowUpdate_(0, static_cast<uint32_t>(ConnRecvLimit_() - connRecvWindow_));
+        connRecvWindow_ = ConnRecvLimit_();
+    }
+    if (upgraded)
+    {
+        // 升级请求隐式成为流 1，已处于半关闭(远端)状态(RFC 7540 3.2)
+        lastStreamId_ = 1;
+        Stream &stream = streams_[1];
+        stream.id = 1;
+        stream.remoteClosed = true;
+        stream.sendWindow = initialWindow_;
+        stream.pass = vtime_;
+        Respond_(stream, HttpRequest::GET_REQUEST);
+    }
+}
+
+bool Http2Session::HasPendingOutput() const
+{
+    if (closing_ || !prefaceReceived_ || connSendWindow_ <= 0)
+    {
+        return false;
+    }
+    for (const auto &kv : streams_)
+    {
+        if (Sendable_(kv.second))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Http2Session::HasDataFrame(const Buffer &in) const
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(in.Peek());
+    size_t n = in.ReadableBytes();
+    size_t pos = prefaceReceived_ ? 0 : PREFACE_LEN;
+    while (pos + 9 <= n)
+    {
+        if (p[pos + 3] == DATA)
+        {
+            return true;
+        }
+        pos += 9 + ((static_cast<size_t>(p[pos]) << 16) | (p[pos + 1] << 8) | p[pos + 2]);
+    }
+    return false;
+}
+
+/* =====================================================================
+ * 输入：帧解析
+ * ===================================================================== */
+
+void Http2Session::Process(Buffer &in)
+{
+    if (!failed_ && !prefaceReceived_)
+    {
+        int preface = MatchPreface(in);
+        if (preface < 0)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+        }
+        else if (preface > 0)
+        {
+            in.Retrieve(PREFACE_LEN);
+            prefaceReceived_ = true;
+        }
+    }
+
+    while (!failed_ && prefaceReceived_ && in.ReadableBytes() >= 9)
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(in.Peek());
+        uint32_t len = (static_cast<uint32_t>(p[0]) << 16) | (p[1] << 8) | p[2];
+        if (len > MAX_FRAME_SIZE)
+        {
+            ConnectionError_(FRAME_SIZE_ERROR);
+            break;
+        }
+        if (in.ReadableBytes() < 9 + len)
+        {
+            break; // 帧不完整，继续读
+        }
+        OnFrame_(p[3], p[4], Get32(p + 5) & 0x7fffffff, p + 9, len);
+        in.Retrieve(9 + len);
+    }
+
+    if (failed_)
+    {
+        in.Clear();
+        closing_ = true;
+        return;
+    }
+
+    // 单个流的请求体不会超过上限，窗口耗尽说明多个流同时上传：对缓存最多的流回 413，
+    // 否则没有流能收齐，客户端会一直等待窗口
+    if (connRecvWindow_ + connCredit_ <= 0)
+    {
+        Stream *largest = nullptr;
+        for (auto &kv : streams_)
+        {
+            if (!kv.second.remoteClosed && (!largest || kv.second.body.size() > largest->body.size()))
+            {
+                largest = &kv.second;
+            }
+        }
+        if (largest && !largest->body.empty())
+        {
+            RejectBody_(*largest);
+        }
+    }
+
+    // 已交付或丢弃的 DATA 归还连接级窗口；仍缓存在流中的请求体继续占用窗口
+    if (connCredit_ > 0)
+    {
+        SendWindowUpdate_(0, connCredit_);
+        connRecvWindow_ += connCredit_;
+        connCredit_ = 0;
+    }
+
+    // 排空(热升级 / 优雅退出)或对端 GOAWAY：不再接受新流，已有的流完成后关闭
+    if (!goAwaySent_ && (peerGoAway_ || HttpConn::isDraining.load(std::memory_order_relaxed)))
+    {
+        SendGoAway_(NO_ERROR);
+    }
+
+    // 升级的连接在收到客户端前言之前只发送 SETTINGS 与流 1 的响应头(客户端在 101 之后缓冲的数据有限)
+    if (prefaceReceived_)
+    {
+        EmitData_();
+    }
+
+    if (goAwaySent_ && streams_.empty() && blockStream_ == 0)
+    {
+        closing_ = true;
+    }
+}
+
+void Http2Session::OnFrame_(uint8_t type, uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    // 头块必须连续：HEADERS 之后只能是同一个流的 CONTINUATION
+    if (blockStream_ && type != CONTINUATION)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    // 连接前言之后的第一个帧必须是 SETTINGS
+    if (!settingsReceived_ && (type != SETTINGS || (flags & FLAG_ACK)))
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+
+    switch (type)
+    {
+    case DATA:
+        OnData_(flags, id, payload, len);
+        break;
+    case HEADERS:
+        OnHeaders_(flags, id, payload, len);
+        break;
+    case PRIORITY:
+        OnPriority_(id, payload, len);
+        break;
+    case RST_STREAM:
+        OnRstStream_(id, payload, len);
+        break;
+    case SETTINGS:
+        OnSettings_(flags, id, payload, len);
+        break;
+    case PUSH_PROMISE:
+        ConnectionError_(PROTOCOL_ERROR); // 客户端不能推送
+        break;
+    case PING:
+        OnPing_(flags, id, payload, len);
+        break;
+    case GOAWAY:
+        OnGoAway_(id, payload, len);
+        break;
+    case WINDOW_UPDATE:
+        OnWindowUpdate_(id, payload, len);
+        break;
+    case CONTINUATION:
+        OnContinuation_(flags, id, payload, len);
+        break;
+    default:
+        break; // 未知类型的帧必须忽略
+    }
+}
+
+void Http2Session::OnData_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (id == 0)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    // 流量控制按整个负载(含填充)计算；超出我方通告的连接级窗口是连接错误
+    if (len > connRecvWindow_)
+    {
+        ConnectionError_(FLOW_CONTROL_ERROR);
+        return;
+    }
+    connRecvWindow_ -= len;
+    const uint8_t *data = payload;
+    uint32_t n = len;
+    if (flags & FLAG_PADDED)
+    {
+        if (n < 1 || payload[0] > n - 1)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+            return;
+        }
+        data++;
+        n -= 1 + payload[0];
+    }
+    // 只有请求体本身会被缓存，填充立即归还
+    connCredit_ += len - n;
+
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        // 空闲的流上不能有 DATA；已关闭 / 已重置的流上的 DATA 直接丢弃
+        if (id > lastStreamId_)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+        }
+        connCredit_ += n;
+        return;
+    }
+    Stream &stream = it->second;
+    if (stream.remoteClosed)
+    {
+        connCredit_ += n;
+        ResetStream_(id, STREAM_CLOSED);
+        return;
+    }
+    if (len > stream.recvWindow)
+    {
+        connCredit_ += n;
+        ResetStream_(id, FLOW_CONTROL_ERROR);
+        return;
+    }
+    stream.recvWindow -= len;
+    if (flags & FLAG_END_STREAM)
+    {
+        stream.remoteClosed = true;
+    }
+    if (stream.bodyTooLarge)
+    {
+        connCredit_ += n;
+    }
+    else if (stream.body.size() + n > HttpRequest::maxBodyBytes)
+    {
+        connCredit_ += n;
+        RejectBody_(stream);
+        return;
+    }
+    else
+    {
+        stream.body.append(reinterpret_cast<const char *>(data), n);
+    }
+    if (stream.remoteClosed)
+    {
+        if (!stream.bodyTooLarge)
+        {
+            Dispatch_(stream);
+        }
+    }
+    else if (len > 0)
+    {
+        // 流级窗口随收下的数据归还，缓存总量由连接级窗口限制
+        SendWindowUpdate_(id, len);
+        stream.recvWindow += len;
+    }
+}
+
+void Http2Session::OnHeaders_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    // 客户端发起的流必须为奇数
+    if (id == 0 || !(id & 1))
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    const uint8_t *p = payload;
+    uint32_t n = len;
+    uint32_t pad = 0;
+    if (flags & FLAG_PADDED)
+    {
+        if (n < 1)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+            return;
+        }
+        pad = p[0];
+        p++;
+        n--;
+    }
+    blockHasPriority_ = false;
+    if (flags & FLAG_PRIORITY)
+    {
+        if (n < 5)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+            return;
+        }
+        uint32_t dep = Get32(p);
+        blockPriority_ = {dep & 0x7fffffff, p[4] + 1, (dep >> 31) != 0};
+        blockHasPriority_ = true;
+        p += 5;
+        n -= 5;
+    }
+    if (pad > n)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+
+    blockStream_ = id;
+    blockFlags_ = flags;
+    headerBlock_.assign(reinterpret_cast<const char *>(p), n - pad);
+    if (flags & FLAG_END_HEADERS)
+    {
+        OnHeaderBlock_();
+    }
+}
+
+void Http2Session::OnContinuation_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (blockStream_ == 0 || id != blockStream_)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    headerBlock_.append(reinterpret_cast<const char *>(payload), len);
+    if (headerBlock_.size() > MAX_HEADER_BLOCK)
+    {
+        ConnectionError_(ENHANCE_YOUR_CALM);
+        return;
+    }
+    if (flags & FLAG_END_HEADERS)
+    {
+        OnHeaderBlock_();
+    }
+}
+
+void Http2Session::OnHeaderBlock_()
+{
+    uint32_t id = blockStream_;
+    bool endStream = blockFlags_ & FLAG_END_STREAM;
+    blockStream_ = 0;
+
+    // 无论流最终是否被接受，头块都要解码，保持 HPACK 动态表与客户端一致
+    std::vector<Hpack::Header> headers;
+    bool ok = decoder_.Decode(reinterpret_cast<const uint8_t *>(headerBlock_.data()), headerBlock_.size(),
+                              headers, MAX_HEADER_LIST_SIZE);
+    headerBlock_.clear();
+    if (!ok)
+    {
+        ConnectionError_(COMPRESSION_ERROR);
+        return;
+    }
+
+    auto it = streams_.find(id);
+    if (it != streams_.end())
+    {
+        // 已打开的流上的第二个头块只能是请求体之后的 trailer，且必须结束流；trailer 内容不使用
+        Stream &stream = it->second;
+        if (stream.remoteClosed)
+        {
+            ResetStream_(id, STREAM_CLOSED);
+        }
+        else if (!endStream)
+        {
+            ResetStream_(id, PROTOCOL_ERROR);
+        }
+        else
+        {
+            stream.remoteClosed = true;
+            if (!stream.bodyTooLarge)
+            {
+                Dispatch_(stream);
+            }
+        }
+        return;
+    }
+    if (id <= lastStreamId_)
+    {
+        return; // 已关闭 / 已重置的流
+    }
+    lastStreamId_ = id;
+    if (goAwaySent_)
+    {
+        return; // GOAWAY 之后的新流不处理
+    }
+    if (streams_.size() >= MAX_CONCURRENT_STREAMS)
+    {
+        ResetStream_(id, REFUSED_STREAM);
+        return;
+    }
+    if (!ValidRequest_(headers) || (blockHasPriority_ && blockPriority_.parent == id))
+    {
+        ResetStream_(id, PROTOCOL_ERROR);
+        return;
+    }
+
+    Stream &stream = streams_[id];
+    stream.id = id;
+    stream.headers = std::move(headers);
+    stream.sendWindow = initialWindow_;
+    stream.pass = vtime_;
+    if (blockHasPriority_)
+    {
+        SetPriority_(stream, blockPriority_);
+    }
+    if (endStream)
+    {
+        stream.remoteClosed = true;
+        Dispatch_(stream);
+    }
+}
+
+void Http2Session::OnPriority_(uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (id == 0)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    if (len != 5)
+    {
+        ResetStream_(id, FRAME_SIZE_ERROR);
+        return;
+    }
+    uint32_t dep = Get32(payload);
+    Priority priority{dep & 0x7fffffff, payload[4] + 1, (dep >> 31) != 0};
+    if (priority.parent == id)
+    {
+        ResetStream_(id, PROTOCOL_ERROR);
+        return;
+    }
+    // 只记录已打开的流；依赖空闲 / 已关闭的流时按依赖根节点处理
+    auto it = streams_.find(id);
+    if (it != streams_.end())
+    {
+        SetPriority_(it->second, priority);
+    }
+}
+
+void Http2Session::OnRstStream_(uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    (void)payload;
+    if (id == 0 || id > lastStreamId_)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    if (len != 4)
+    {
+        ConnectionError_(FRAME_SIZE_ERROR);
+        return;
+    }
+    EraseStream_(id);
+}
+
+void Http2Session::OnSettings_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (id != 0)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    if (flags & FLAG_ACK)
+    {
+        if (len != 0)
+        {
+            ConnectionError_(FRAME_SIZE_ERROR);
+        }
+        return;
+    }
+    if (len % 6 != 0)
+    {
+        ConnectionError_(FRAME_SIZE_ERROR);
+        return;
+    }
+    ErrorCode error = ApplySettings_(payload, len);
+    if (error != NO_ERROR)
+    {
+        ConnectionError_(error);
+        return;
+    }
+    settingsReceived_ = true;
+    WriteFrame_(SETTINGS, FLAG_ACK, 0, nullptr, 0);
+}
+
+Http2Session::ErrorCode Http2Session::ApplySettings_(const uint8_t *payload, uint32_t len)
+{
+    for (uint32_t i = 0; i + 6 <= len; i += 6)
+    {
+        uint16_t key = static_cast<uint16_t>((payload[i] << 8) | payload[i + 1]);
+        uint32_t value = Get32(payload + i + 2);
+        switch (key)
+        {
+        case SETTINGS_ENABLE_PUSH:
+            if (value > 1)
+                return PROTOCOL_ERROR;
+            break;
+        case SETTINGS_INITIAL_WINDOW_SIZE:
+        {
+            if (value > MAX_WINDOW)
+                return FLOW_CONTROL_ERROR;
+            // 新的初始窗口按差值作用于所有已打开的流，可以使窗口变为负数
+            int64_t delta = static_cast<int64_t>(value) - initialWindow_;
+            for (auto &kv : streams_)
+            {
+                kv.second.sendWindow += delta;
+                if (kv.second.sendWindow > MAX_WINDOW)
+                    return FLOW_CONTROL_ERROR;
+            }
+            initialWindow_ = value;
+            break;
+        }
+        case SETTINGS_MAX_FRAME_SIZE:
+            if (value < 16384 || value > 16777215)
+                return PROTOCOL_ERROR;
+            peerMaxFrame_ = value;
+            break;
+        default:
+            break; // 头部表大小：编码时不使用动态表；其余参数与服务端无关
+        }
+    }
+    return NO_ERROR;
+}
+
+void Http2Session::OnPing_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (id != 0)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    if (len != 8)
+    {
+        ConnectionError_(FRAME_SIZE_ERROR);
+        return;
+    }
+    if (!(flags & FLAG_ACK))
+    {
+        WriteFrame_(PING, FLAG_ACK, 0, reinterpret_cast<const char *>(payload), 8);
+    }
+}
+
+void Http2Session::OnGoAway_(uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    (void)payload;
+    if (id != 0)
+    {
+        ConnectionError_(PROTOCOL_ERROR);
+        return;
+    }
+    if (len < 8)
+    {
+        ConnectionError_(FRAME_SIZE_ERROR);
+        return;
+    }
+    peerGoAway_ = true;
+}
+
+void Http2Session::OnWindowUpdate_(uint32_t id, const uint8_t *payload, uint32_t len)
+{
+    if (len != 4)
+    {
+        ConnectionError_(FRAME_SIZE_ERROR);
+        return;
+    }
+    uint32_t increment = Get32(payload) & 0x7fffffff;
+    if (id == 0)
+    {
+        if (increment == 0)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+            return;
+        }
+        connSendWindow_ += increment;
+        if (connSendWindow_ > MAX_WINDOW)
+        {
+            ConnectionError_(FLOW_CONTROL_ERROR);
+        }
+        return;
+    }
+
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        if (id > lastStreamId_)
+        {
+            ConnectionError_(PROTOCOL_ERROR);
+        }
+        return;
+    }
+    if (increment == 0)
+    {
+        ResetStream_(id, PROTOCOL_ERROR);
+        return;
+    }
+    it->second.sendWindow += increment;
+    if (it->second.sendWindow > MAX_WINDOW)
+    {
+        ResetStream_(id, FLOW_CONTROL_ERROR);
+    }
+}
+
+/* =====================================================================
+ * 请求 -> HttpConn -> 响应
+ * ===================================================================== */
+
+bool Http2Session::ValidRequest_(std::vector<Hpack::Header> &headers)
+{
+    int method = 0, scheme = 0, path = 0, authority = 0;
+    bool regular = false;
+    for (const Hpack::Header &h : headers)
+    {
+        if (h.name.empty() || h.name.find_first_of(std::string_view("\r\n\0", 3)) != std::string::npos ||
+            h.value.find_first_of(std::string_view("\r\n\0", 3)) != std::string::npos)
+        {
+            return false;
+        }
+        for (char ch : h.name)
+        {
+            if (ch >= 'A' && ch <= 'Z')
+                return false; // 字段名必须是小写
+        }
+        if (h.name[0] == ':')
+        {
+            // 伪头部必须在普通头部之前，且各出现一次
+            if (regular)
+                return false;
+            if (h.name == ":method")
+                method++;
+            else if (h.name == ":scheme")
+                scheme++;
+            else if (h.name == ":path")
+            {
+                // origin-form 或 "*"(RFC 9113 8.3.1)；合成请求行时不能含空白。点段与转义由 HttpRequest 规范化
+                if (h.value != "*" && (h.value.empty() || h.value[0] != '/' ||
+                                       h.value.find_first_of(" \t") != std::string::npos))
+                    return false;
+                path++;
+            }
+            else if (h.name == ":authority")
+                authority++;
+            else
+                return false;
+            continue;
+        }
+        regular = true;
+        if (IsConnectionHeader(h.name) || (h.name == "te" && h.value != "trailers"))
+        {
+            return false;
+        }
+    }
+    return method == 1 && scheme == 1 && path == 1 && authority <= 1;
+}
+
+void Http2Session::Dispatch_(Stream &stream)
+{
+    // 合成 HTTP/1.1 请求：请求行 + Host(来自 :authority)+ 普通头部 + Content-Length + 请求体
+    std::string_view method, path, authority;
+    std::string cookie;
+    for (const Hpack::Header &h : stream.headers)
+    {
+        if (h.name == ":method")
+            method = h.value;
+        else if (h.name == ":path")
+            path = h.value;
+        else if (h.name == ":authority")
+            authority = h.value;
+        else if (h.name == "cookie")
+            cookie += (cookie.empty() ? "" : "; ") + h.value; // 拆开发送的 cookie 重新拼接(RFC 9113 8.2.3)
+        else if (h.name == "content-length" && h.value != std::to_string(stream.body.size()))
+        {
+            ResetStream_(stream.id, PROTOCOL_ERROR);
+            return;
+        }
+    }
+
+    scratchIn_.Clear();
+    scratchIn_.Append(method.data(), method.size());
+    scratchIn_.Append(" ", 1);
+    scratchIn_.Append(path.data(), path.size());
+    scratchIn_.Append(" HTTP/1.1\r\n", 11);
+    if (!authority.empty())
+    {
+        scratchIn_.Append("host: " + std::string(authority) + "\r\n");
+    }
+    for (const Hpack::Header &h : stream.headers)
+    {
+        if (h.name[0] == ':' || h.name == "cookie" || h.name == "content-length" || h.name == "expect" ||
+            (h.name == "host" && !authority.empty()))
+        {
+            continue;
+        }
+        scratchIn_.Append(h.name + ": " + h.value + "\r\n");
+    }
+    if (!cookie.empty())
+    {
+        scratchIn_.Append("cookie: " + cookie + "\r\n");
+    }
+    if (!stream.body.empty() || method == "POST" || method == "PUT" || method == "PATCH")
+    {
+        scratchIn_.Append("content-length: " + std::to_string(stream.body.size()) + "\r\n");
+    }
+    scratchIn_.Append("\r\n", 2);
+    scratchIn_.Append(stream.body);
+    connCredit_ += stream.body.size();
+    std::string().swap(stream.body);
+    std::vector<Hpack::Header>().swap(stream.headers);
+
+    HttpRequest &request = conn_.request_;
+    request.Init();
+    HttpRequest::HTTP_CODE ret = request.parse(scratchIn_);
+    if (ret == HttpRequest::NO_REQUEST)
+    {
+        ret = HttpRequest::BAD_REQUEST; // 合成的请求总是完整的
+    }
+    Respond_(stream, ret);
+    request.Init();
+    scratchIn_.Clear();
+}
+
+void Http2Session::Respond_(Stream &stream, HttpRequest::HTTP_CODE ret)
+{
+    uint32_t id = stream.id;
+    scratchOut_.Clear();
+    conn_.Respond_(ret, true, scratchOut_);
+    HttpResponse &response = conn_.response_;
+
+    // 状态行与响应头在第一段文本中，到空行为止
+    std::string_view text(scratchOut_.Peek(), scratchOut_.ReadableBytes());
+    size_t headerEnd = text.find("\r\n\r\n");
+    if (text.size() < 12 || headerEnd == std::string_view::npos)
+    {
+        response.ReleaseFile();
+        ResetStream_(id, INTERNAL_ERROR);
+        return;
+    }
+
+    std::string block;
+    Hpack::EncodeStatus(std::atoi(std::string(text.substr(9, 3)).c_str()), block);
+    size_t pos = text.find("\r\n") + 2;
+    while (pos < headerEnd + 2)
+    {
+        size_t eol = text.find("\r\n", pos);
+        std::string_view line = text.substr(pos, eol - pos);
+        pos = eol + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos)
+            continue;
+        std::string name(line.substr(0, colon));
+        std::transform(name.begin(), name.end(), name.begin(), HttpTables::Lower);
+        if (IsConnectionHeader(name))
+            continue;
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ')
+            value.remove_prefix(1);
+        Hpack::EncodeHeader(name, value, block);
+    }
+
+    // 正文：第一段文本中空行之后的部分与其余各段；文件引用的所有权交给流
+    size_t textPos = 0;
+    size_t bodyStart = headerEnd + 4;
+    for (int i = 0; i < response.PieceCount(); i++)
+    {
+        const HttpResponse::Piece &piece = response.Pieces()[i];
+        if (piece.file)
+        {
+            if (piece.len > 0)
+                stream.out.push_back({piece.file, piece.off, piece.len, std::string()});
+            else
+                FileCache::Unpin(piece.file);
+            continue;
+        }
+        size_t begin = std::max(textPos, bodyStart);
+        size_t end = textPos + piece.len;
+        if (begin < end)
+        {
+            stream.out.push_back({nullptr, 0, end - begin, std::string(text.substr(begin, end - begin))});
+        }
+        textPos = end;
+    }
+    response.ReleasePieces();
+    scratchOut_.Clear();
+
+    // HEADERS(+ CONTINUATION)：没有正文时 END_STREAM 放在 HEADERS 上
+    bool endStream = stream.out.empty();
+    size_t off = 0;
+    bool first = true;
+    do
+    {
+        size_t n = std::min<size_t>(block.size() - off, peerMaxFrame_);
+        uint8_t flags = (off + n == block.size() ? FLAG_END_HEADERS : 0) | (first && endStream ? FLAG_END_STREAM : 0);
+        WriteFrame_(first ? HEADERS : CONTINUATION, flags, id, block.data() + off, n);
+        off += n;
+        first = false;
+    } while (off < block.size());
+    stream.responded = true;
+
+    if (endStream)
+    {
+        FinishStream_(id);
+    }
+}
+
+/* =====================================================================
+ * 输出：优先级调度与 DATA 帧
+ * ===================================================================== */
+
+void Http2Session::SetPriority_(Stream &stream, const Priority &priority)
+{
+    // 新的父节点是自己的后代：先把它挂到自己原来的父节点上，避免形成环
+    uint32_t p = priority.parent;
+    for (size_t depth = 0; p != 0 && depth <= streams_.size(); depth++)
+    {
+        auto it = streams_.find(p);
+        if (it == streams_.end())
+            break;
+        if (it->second.parent == stream.id)
+        {
+            streams_[priority.parent].parent = stream.parent;
+            break;
+        }
+        p = it->second.parent;
+    }
+    if (priority.exclusive)
+    {
+        // 独占：父节点原有的子节点改为依赖本流
+        for (auto &kv : streams_)
+        {
+            if (kv.first != stream.id && kv.second.parent == priority.parent)
+                kv.second.parent = stream.id;
+        }
+    }
+    stream.parent = priority.parent;
+    stream.weight = priority.weight;
+}
+
+Http2Session::Stream *Http2Session::PickStream_()
+{
+    Stream *best = nullptr;
+    for (auto &kv : streams_)
+    {
+        Stream &stream = kv.second;
+        if (!Sendable_(stream))
+            continue;
+        // 祖先还有数据可发时先发祖先(依赖关系)
+        bool blocked = false;
+        uint32_t p = stream.parent;
+        for (size_t depth = 0; p != 0 && depth < streams_.size(); depth++)
+        {
+            auto it = streams_.find(p);
+            if (it == streams_.end())
+                break;
+            if (Sendable_(it->second))
+            {
+                blocked = true;
+                break;
+            }
+            p = it->second.parent;
+        }
+        // 兄弟之间按权重分配带宽：虚拟时间最小者先发
+        if (!blocked && (!best || stream.pass < best->pass))
+            best = &stream;
+    }
+    return best;
+}
+
+void Http2Session::EmitData_()
+{
+    size_t budget = MAX_BATCH_BYTES;
+    // 每个 DATA 帧最多占两段：帧头(文本) + 负载(文本或文件)
+    while (budget > 0 && connSendWindow_ > 0 && conn_.segCnt_ + 2 <= HttpConn::MAX_SEGMENTS)
+    {
+        Stream *stream = PickStream_();
+        if (!stream)
+            break;
+        Chunk &chunk = stream->out.front();
+        size_t n = std::min({chunk.len, static_cast<size_t>(connSendWindow_),
+                             static_cast<size_t>(stream->sendWindow), static_cast<size_t>(peerMaxFrame_), budget});
+        bool chunkDone = n == chunk.len;
+        bool last = chunkDone && stream->out.size() == 1;
+
+        WriteFrameHeader_(DATA, last ? FLAG_END_STREAM : 0, stream->id, n);
+        if (chunk.file)
+        {
+            // 文件按帧切片，每片持有一个引用：最后一片直接接过流的引用
+            if (!chunkDone)
+                FileCache::Pin(chunk.file);
+            conn_.AddSegment_(chunk.file, chunk.off, n);
+            if (chunkDone)
+                chunk.file = nullptr;
+        }
+        else
+        {
+            conn_.writeBuff_.Append(chunk.text.data() + chunk.off, n);
+            conn_.AddSegment_(nullptr, 0, n);
+        }
+        chunk.off += n;
+        chunk.len -= n;
+        connSendWindow_ -= n;
+        stream->sendWindow -= n;
+        budget -= n;
+        vtime_ = stream->pass;
+        stream->pass += n * 256 / stream->weight + 1;
+
+        if (chunkDone)
+            stream->out.pop_front();
+        if (last)
+            FinishStream_(stream->id);
+    }
+}
+
+void Http2Session::FinishStream_(uint32_t id)
+{
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        return;
+    }
+    if (!it->second.remoteClosed)
+    {
+        // 响应已完整但请求体还没发完(如 413)：通知客户端停止发送
+        ResetStream_(id, NO_ERROR);
+        return;
+    }
+    EraseStream_(id);
+}
+
+void Http2Session::RejectBody_(Stream &stream)
+{
+    // 请求体超限：不等请求结束，直接回 413，发完后用 RST_STREAM 让客户端停止发送
+    stream.bodyTooLarge = true;
+    connCredit_ += stream.body.size();
+    std::string().swap(stream.body);
+    conn_.request_.Init();
+    Respond_(stream, HttpRequest::PAYLOAD_TOO_LARGE);
+}
+
+int64_t Http2Session::ConnRecvLimit_()
+{
+    // 比单个请求体的上限多一帧：单个流在窗口耗尽之前一定能收齐或触发 413
+    int64_t limit = static_cast<int64_t>(std::min<size_t>(HttpRequest::maxBodyBytes, MAX_WINDOW - MAX_FRAME_SIZE));
+    limit += MAX_FRAME_SIZE;
+    return limit > DEFAULT_WINDOW ? limit : DEFAULT_WINDOW;
+}
+
+void Http2Session::EraseStream_(uint32_t id)
+{
+    auto it = streams_.find(id);
+    if (it == streams_.end())
+    {
+        return;
+    }
+    connCredit_ += it->second.body.size();
+    for (Chunk &chunk : it->second.out)
+    {
+        if (chunk.file)
+            FileCache::Unpin(chunk.file);
+    }
+    streams_.erase(it);
+}
+
+void Http2Session::ResetStream_(uint32_t id, ErrorCode error)
+{
+    char payload[4];
+    Put32(payload, error);
+    WriteFrame_(RST_STREAM, 0, id, payload, 4);
+    EraseStream_(id);
+}
+
+void Http2Session::ConnectionError_(ErrorCode error)
+{
+    if (failed_)
+    {
+        return;
+    }
+    SendGoAway_(error);
+    failed_ = true;
+    blockStream_ = 0;
+    while (!streams_.empty())
+    {
+        EraseStream_(streams_.begin()->first);
+    }
+}
+
+void Http2Session::SendGoAway_(ErrorCode error)
+{
+    char payload[8];
+    Put32(payload, lastStreamId_);
+    Put32(payload + 4, error);
+    WriteFrame_(GOAWAY, 0, 0, payload, 8);
+    goAwaySent_ = true;
+}
+
+void Http2Session::SendWindowUpdate_(uint32_t id, uint32_t increment)
+{
+    char payload[4];
+    Put32(payload, increment);
+    WriteFrame_(WINDOW_UPDATE, 0, id, payload, 4);
+}
+
+void Http2Session::SendSettings_()
+{
+    char payload[12];
+    Put16(payload, SETTINGS_MAX_CONCURRENT_STREAMS);
+    Put32(payload + 2, MAX_CONCURRENT_STREAMS);
+    Put16(payload + 6, SETTINGS_MAX_HEADER_LIST_SIZE);
+    Put32(payload + 8, MAX_HEADER_LIST_SIZE);
+    WriteFrame_(SETTINGS, 0, 0, payload, sizeof(payload));
+}
+
+void Http2Session::WriteFrameHeader_(uint8_t type, uint8_t flags, uint32_t id, size_t len)
+{
+    char header[9];
+    header[0] = static_cast<char>(len >> 16);
+    header[1] = static_cast<char>(len >> 8);
+    header[2] = static_cast<char>(len);
+    header[3] = static_cast<char>(type);
+    header[4] = static_cast<char>(flags);
+    Put32(header + 5, id & 0x7fffffff);
+    conn_.writeBuff_.Append(header, sizeof(header));
+    conn_.AddSegment_(nullptr, 0, sizeof(header));
+}
+
+void Http2Session::WriteFrame_(uint8_t type, uint8_t flags, uint32_t id, const char *payload, size_t len)
+{
+    WriteFrameHeader_(type, flags, id, len);
+    if (len > 0)
+    {
+        conn_.writeBuff_.Append(payload, len);
+        conn_.AddSegment_(nullptr, 0, len);
+    }
+}
@@ -0,0 +1,275 @@
+#ifndef HTTP2_SESSION_H
+#define HTTP2_SESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../buffer/Buffer.h"
+#include "FileCache.h"
+#include "Hpack.h"
+#include "HttpRequest.h"
+
+class HttpConn;
+
+/**
+ * @brief 一个 h2c(明文 HTTP/2，RFC 9113)连接的会话状态：帧解析、HPACK、流量控制与流优先级
+ *        挂在 HttpConn 上，沿用其读写缓冲与段队列：读缓冲中的帧由 Process 消费，
+ *        输出的帧头 / 控制帧作为文本段追加到 writeBuff_，静态文件的 DATA 负载直接引用缓存的文件(零拷贝)
+ *        每个流收齐后合成一份 HTTP/1.1 请求，交给 HttpConn 原有的解析 / 路由 / 响应逻辑，
+ *        再把生成的响应头转成 HEADERS 帧、正文按窗口切成 DATA 帧
+ *        Process 只在段队列为空时被调用(写完之前不会处理新的输入)，重置流时可以直接释放文件引用
+ */
+class Http2Session
+{
+public:
+    // 客户端连接前言
+    static const char PREFACE[];
+    static const size_t PREFACE_LEN = 24;
+
+    enum FrameType : uint8_t
+    {
+        DATA = 0x0,
+        HEADERS = 0x1,
+        PRIORITY = 0x2,
+        RST_STREAM = 0x3,
+        SETTINGS = 0x4,
+        PUSH_PROMISE = 0x5,
+        PING = 0x6,
+        GOAWAY = 0x7,
+        WINDOW_UPDATE = 0x8,
+        CONTINUATION = 0x9,
+    };
+
+    enum ErrorCode : uint32_t
+    {
+        NO_ERROR = 0x0,
+        PROTOCOL_ERROR = 0x1,
+        INTERNAL_ERROR = 0x2,
+        FLOW_CONTROL_ERROR = 0x3,
+        STREAM_CLOSED = 0x5,
+        FRAME_SIZE_ERROR = 0x6,
+        REFUSED_STREAM = 0x7,
+        CANCEL = 0x8,
+        COMPRESSION_ERROR = 0x9,
+        ENHANCE_YOUR_CALM = 0xb,
+    };
+
+    explicit Http2Session(HttpConn &conn);
+    ~Http2Session();
+
+    /**
+     * @brief buff 开头是否为连接前言
+     * @return 1 完整匹配；0 数据不足但目前为前言的前缀；-1 不是前言
+     */
+    static int MatchPreface(const Buffer &buff);
+
+    /**
+     * @brief Upgrade: h2c 时解析 HTTP2-Settings(base64url 编码的 SETTINGS 负载)并应用
+     * @return false 表示头部非法，不应升级
+     */
+    bool ApplyUpgradeSettings(std::string_view settings);
+
+    /**
+     * @brief 开始会话：发送服务器的 SETTINGS
+     * @param upgraded 由 HTTP/1.1 升级而来：HttpConn 当前已解析的请求作为流 1，立即生成其响应
+     */
+    void Start(bool upgraded);
+
+    /**
+     * @brief 消费 in 中完整的帧并生成输出(控制帧 / 响应头 / 窗口允许的 DATA)
+     */
+    void Process(Buffer &in);
+
+    /**
+     * @brief 是否有无需读取新输入即可发送的数据(已收到前言，有流的正文排队且窗口未耗尽)
+     */
+    bool HasPendingOutput() const;
+
+    /**
+     * @brief 是否有尚未结束的流(客户端在发送请求体，或等待 WINDOW_UPDATE)
+     */
+    bool HasOpenStreams() const { return !streams_.empty(); }
+
+    /**
+     * @brief 已发出 GOAWAY 且没有未完成的流：本批输出写完后关闭连接
+     */
+    bool IsClosing() const { return closing_; }
+
+    /**
+     * @brief in 中是否有 DATA 帧(带请求体的请求可能命中阻塞的路由，如登录 / 注册)
+     */
+    bool HasDataFrame(const Buffer &in) const;
+
+private:
+    // 我方 SETTINGS：最大并发流数、头部列表上限；帧大小与窗口使用协议默认值
+    static const uint32_t MAX_CONCURRENT_STREAMS = 100;
+    static const uint32_t MAX_HEADER_LIST_SIZE = 64 * 1024;
+    static const uint32_t MAX_FRAME_SIZE = 16384;
+    static const int64_t DEFAULT_WINDOW = 65535;
+    static const int64_t MAX_WINDOW = 0x7fffffff;
+    // 未拼完的头块上限(超过视为攻击)
+    static const size_t MAX_HEADER_BLOCK = 4 * MAX_HEADER_LIST_SIZE;
+    // 一次 Process 最多生成的 DATA 字节数，避免一个大文件长时间占住写循环
+    static const size_t MAX_BATCH_BYTES = 256 * 1024;
+
+    /**
+     * @brief 响应正文的一段：file 为空时为 text[off, off + len)，否则为缓存文件中的一段(持有一个引用)
+     */
+    struct Chunk
+    {
+        const CachedFile *file;
+        size_t off;
+        size_t len;
+        std::string text;
+    };
+
+    struct Stream
+    {
+        uint32_t id = 0;
+        bool remoteClosed = false;  // 已收到 END_STREAM
+        bool responded = false;     // 响应头已发出
+        bool bodyTooLarge = false;  // 请求体超过上限，已回 413
+        std::vector<Hpack::Header> headers; // 请求头(伪头部在前)
+        std::string body;           // 请求体
+        int64_t sendWindow = DEFAULT_WINDOW;
+        int64_t recvWindow = DEFAULT_WINDOW; // 流级接收窗口
+        uint32_t parent = 0;        // 依赖的流，0 为根
+        int weight = 16;            // 1 ~ 256
+        uint64_t pass = 0;          // 加权公平调度的虚拟时间
+        std::deque<Chunk> out;      // 待发送的正文
+    };
+
+    struct Priority
+    {
+        uint32_t parent;
+        int weight;
+        bool exclusive;
+    };
+
+    void OnFrame_(uint8_t type, uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnData_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnHeaders_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnContinuation_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnPriority_(uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnRstStream_(uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnSettings_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnPing_(uint8_t flags, uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnGoAway_(uint32_t id, const uint8_t *payload, uint32_t len);
+    void OnWindowUpdate_(uint32_t id, const uint8_t *payload, uint32_t len);
+
+    /**
+     * @brief 应用对端的 SETTINGS 参数，非法时返回对应的错误码
+     */
+    ErrorCode ApplySettings_(const uint8_t *payload, uint32_t len);
+
+    /**
+     * @brief 一个完整的头块(HEADERS + CONTINUATION)：HPACK 解码后打开流或作为 trailer
+     */
+    void OnHeaderBlock_();
+
+    /**
+     * @brief 请求头是否合法(RFC 9113 8.2 / 8.3)：伪头部、小写字段名、禁止的连接头部等
+     */
+    static bool ValidRequest_(std::vector<Hpack::Header> &headers);
+
+    /**
+     * @brief 请求收齐：合成 HTTP/1.1 请求交给 HttpConn 处理，生成响应
+     */
+    void Dispatch_(Stream &stream);
+
+    /**
+     * @brief 把 HttpConn 生成到 scratchOut_ 的 HTTP/1.1 响应转成 HEADERS 帧与待发送的正文
+     */
+    void Respond_(Stream &stream, HttpRequest::HTTP_CODE ret);
+
+    /**
+     * @brief 更新流的依赖关系(依赖自己的后代时先把后代挂到原父节点，RFC 7540 5.3.3)
+     */
+    void SetPriority_(Stream &stream, const Priority &priority);
+
+    /**
+     * @brief 按窗口与优先级生成 DATA 帧
+     */
+    void EmitData_();
+
+    /**
+     * @brief 选出下一个发送的流：可发送，且没有同样可发送的祖先；其中虚拟时间最小者
+     */
+    Stream *PickStream_();
+
+    bool Sendable_(const Stream &stream) const { return !stream.out.empty() && stream.sendWindow > 0; }
+
+    /**
+     * @brief 响应正文全部排队后结束流；客户端尚未发完请求时用 RST_STREAM(NO_ERROR) 通知其停止
+     */
+    void FinishStream_(uint32_t id);
+
+    /**
+     * @brief 请求体超限：丢弃已缓存的部分(归还连接级窗口)，回 413
+     */
+    void RejectBody_(Stream &stream);
+
+    /**
+     * @brief 连接级接收窗口，即每个连接缓存的请求体上限：单个请求体上限加一帧(不小于协议默认窗口)
+     */
+    static int64_t ConnRecvLimit_();
+
+    /**
+     * @brief 删除流，释放其仍持有的文件引用，未交付的请求体归还连接级窗口
+     */
+    void EraseStream_(uint32_t id);
+
+    void ResetStream_(uint32_t id, ErrorCode error);
+
+    /**
+     * @brief 连接错误：发送 GOAWAY，丢弃所有流，输出写完后关闭
+     */
+    void ConnectionError_(ErrorCode error);
+
+    void SendGoAway_(ErrorCode error);
+    void SendWindowUpdate_(uint32_t id, uint32_t increment);
+    void SendSettings_();
+
+    /**
+     * @brief 追加一个帧头(9 字节)与文本负载，作为文本段排队
+     */
+    void WriteFrame_(uint8_t type, uint8_t flags, uint32_t id, const char *payload, size_t len);
+    void WriteFrameHeader_(uint8_t type, uint8_t flags, uint32_t id, size_t len);
+
+private:
+    HttpConn &conn_;
+    Hpack::Decoder decoder_;
+
+    bool prefaceReceived_;   // 已收到连接前言
+    bool settingsReceived_;  // 已收到对端第一个 SETTINGS
+    bool goAwaySent_;        // 已发送 GOAWAY，不再接受新流
+    bool peerGoAway_;        // 对端发来 GOAWAY
+    bool failed_;            // 已发生连接错误
+    bool closing_;
+
+    uint32_t lastStreamId_;  // 已接受的最大流 id
+    int64_t connSendWindow_; // 连接级发送窗口
+    int64_t connRecvWindow_; // 连接级接收窗口(缓存的请求体占用，交付后才归还)
+    int64_t initialWindow_;  // 对端 SETTINGS_INITIAL_WINDOW_SIZE
+    uint32_t peerMaxFrame_;  // 对端 SETTINGS_MAX_FRAME_SIZE
+    uint32_t connCredit_;    // 本批已消费(交付 / 丢弃)的 DATA 字节数，统一发送连接级 WINDOW_UPDATE
+    uint64_t vtime_;         // 调度器的虚拟时间，新流从这里开始
+
+    // 正在接收的头块(CONTINUATION 拼接)：流 id 为 0 表示没有
+    uint32_t blockStream_;
+    uint8_t blockFlags_;
+    bool blockHasPriority_;
+    Priority blockPriority_;
+    std::string headerBlock_;
+
+    std::map<uint32_t, Stream> streams_;
+
+    Buffer scratchIn_;  // 合成的 HTTP/1.1 请求
+    Buffer scratchOut_; // HttpConn 生成的 HTTP/1.1 响应
+};
+
+#endif // HTTP2_SESSION_H
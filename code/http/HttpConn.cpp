@@ -1,31 +1,74 @@
 #include "HttpConn.h"
+#include "Http2Session.h"
 #include <unistd.h>     // close()
 #include <sys/socket.h> // recv(), send()
+#include <sys/sendfile.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/stat.h> // mkdir
 #include <cassert>
+#include <algorithm>
 #include <atomic>
 #include <iostream> // 可选：日志/调试输出
 
 // 静态成员定义
 const char *HttpConn::srcDir = nullptr;
+std::shared_ptr<const Router> HttpConn::router;
 std::atomic<int> HttpConn::userCount{0};
+int HttpConn::keepAliveTimeoutSec = 120;
+int HttpConn::keepAliveMax = 6;
+std::atomic<bool> HttpConn::isDraining{false};
 
 HttpConn::HttpConn()
     : isWriting_(false),
       isClose_(true),
+      requestCount_(0),
       fd_(-1),
-      iovCnt_(0)
+      keepAlive_(false),
+      segHead_(0),
+      segCnt_(0),
+      toWrite_(0)
 {
-    // 初始化内存
-    iov_[0].iov_base = nullptr;
-    iov_[0].iov_len = 0;
-    iov_[1].iov_base = nullptr;
-    iov_[1].iov_len = 0;
 
-    // 获取配置的单例实例
-    Config &config = Config::GetInstance();
-    srcDir = config.GetServerSrcDir().c_str();
+    // 获取配置的单例实例；连接槽会预分配大量 HttpConn，目录只读取一次，
+    // 且必须指向生命周期足够长的字符串(不能取临时 string 的 c_str())
+    static const std::string dir = Config::GetInstance().GetServerSrcDir();
+    srcDir = dir.c_str();
+    static const int timeoutSec = Config::GetInstance().GetKeepAliveTimeoutSec();
+    static const int maxRequests = Config::GetInstance().GetKeepAliveMax();
+    keepAliveTimeoutSec = timeoutSec;
+    keepAliveMax = maxRequests;
+    // 打开文件 / 内容缓存：开始监视资源目录(各 Reactor 共享，只初始化一次)
+    static const bool cacheReady = []()
+    {
+        Config &config = Config::GetInstance();
+        FileCache::Instance().Init(dir, config.GetCacheOpenFiles(),
+                                   static_cast<size_t>(config.GetCacheContentMB()) * 1024 * 1024,
+                                   static_cast<size_t>(config.GetCacheContentMaxFileKB()) * 1024,
+                                   static_cast<size_t>(config.GetReadaheadMinKB()) * 1024);
+        HttpResponse::inlineMaxBytes = config.GetInlineMaxBytes();
+        Compressor::Init(config.GetCompressMinBytes(), static_cast<size_t>(config.GetCompressMaxKB()) * 1024,
+                         config.GetCompressLevel(), static_cast<size_t>(config.GetCompressMemoMB()) * 1024 * 1024);
+        return true;
+    }();
+    (void)cacheReady;
+    static const int maxBody = Config::GetInstance().GetMaxBodyBytes();
+    HttpRequest::maxBodyBytes = maxBody;
+    static const bool uploadReady = []()
+    {
+        Config &config = Config::GetInstance();
+        HttpRequest::uploadPath = config.GetUploadPath();
+        HttpRequest::uploadDir = config.GetUploadDir();
+        HttpRequest::maxUploadBytes = static_cast<size_t>(config.GetUploadMaxMB()) * 1024 * 1024;
+        // 落盘目录不存在时创建；创建失败则不接收上传
+        if (!HttpRequest::uploadDir.empty() && mkdir(HttpRequest::uploadDir.c_str(), 0755) < 0 && errno != EEXIST)
+        {
+            std::cerr << "Create upload dir " << HttpRequest::uploadDir << " failed, uploads disabled\n";
+            HttpRequest::uploadDir.clear();
+        }
+        return true;
+    }();
+    (void)uploadReady;
 }
 
 HttpConn::~HttpConn()
@@ -43,13 +86,16 @@ void HttpConn::init(int sockFd, const sockaddr_in &addr)
 
     isClose_ = false;
     isWriting_ = false;
-    iovCnt_ = 0;
+    requestCount_ = 0;
+    keepAlive_ = false;
+    ClearSegments_();
+    h2_.reset();
 
     // 缓冲区/请求/响应初始化
     readBuff_.Clear();
     writeBuff_.Clear();
     request_.Init();
-    response_.UnmapFile();
+    response_.ReleaseFile();
 
     // 设置默认资源目录(如果你的项目不需要动态修改，可直接在 HttpConn.h 中写死)
     // HttpConn::srcDir = "/home/xxx/your_project/resources"; // 也可在 main 中初始化
@@ -61,6 +107,10 @@ void HttpConn::Close()
     {
         isClose_ = true;
         userCount--;
+        ClearSegments_();
+        h2_.reset();                   // 段队列清空后再释放流持有的文件引用
+        response_.ReleaseCompressor(); // 压缩流只在连接存活期间保留
+        request_.Init();               // 未完成的上传在这里删除半截文件
         if (fd_ >= 0)
             close(fd_);
         fd_ = -1;
@@ -74,16 +124,26 @@ int HttpConn::GetFd() const
 
 int HttpConn::GetPort() const
 {
-    return ntohs(addr_.sin_port);
+    return ntohs(PeerAddr_().sin_port);
 }
 
 const char *HttpConn::GetIP() const
 {
-    return inet_ntoa(addr_.sin_addr);
+    return inet_ntoa(PeerAddr_().sin_addr);
 }
 
 sockaddr_in HttpConn::GetAddr() const
 {
+    return PeerAddr_();
+}
+
+const sockaddr_in &HttpConn::PeerAddr_() const
+{
+    if (addr_.sin_family != AF_INET && fd_ >= 0)
+    {
+        socklen_t len = sizeof(addr_);
+        getpeername(fd_, (sockaddr *)&addr_, &len);
+    }
     return addr_;
 }
 
@@ -105,7 +165,7 @@ ssize_t HttpConn::read(int *saveErrno)
     {
         len = readBuff_.ReadFd(fd_, saveErrno);
         totalLen += len;
-        if (len <= 0)
+        if (len <= 0 || readBuff_.ReadableBytes() >= MAX_READ_BATCH)
         {
             break;
         }
@@ -115,7 +175,8 @@ ssize_t HttpConn::read(int *saveErrno)
 }
 
 /**
- * @brief 将响应数据写到 socket，支持 writev 合并发送头部和映射文件
+ * @brief 将排队中的响应写到 socket：连续的内存段(响应头 / 内容缓存中的正文)合并成一次 sendmsg，
+ *        只在 fd 中的文件段用 sendfile；部分写出时由 Consume_ 推进各段
  * @param saveErrno 若发生错误，记录在此
  * @return 累计写了多少
  */
@@ -126,84 +187,398 @@ ssize_t HttpConn::write(int *saveErrno)
         return 0;
     }
     ssize_t totalLen = 0; // 记录总共写入的字节数
-    ssize_t len = -1;
 
-    while (true)
+    while (toWrite_ > 0)
     {
-        len = writev(fd_, iov_, iovCnt_); // 执行写操作
-        totalLen += len;                  // 累计写入的字节数
+        // 响应头在 writeBuff_ 中依次排列，从 Peek() 开始按段长度切分；遇到需要 sendfile 的段时停下
+        struct iovec iov[MAX_SEGMENTS];
+        int iovCnt = 0;
+        const char *head = writeBuff_.Peek();
+        int i = segHead_;
+        for (; i < segCnt_; i++)
+        {
+            Segment &seg = segs_[i];
+            if (seg.len == 0)
+                continue;
+            if (seg.file && !seg.file->InMemory())
+                break;
+            if (seg.file)
+            {
+                iov[iovCnt].iov_base = const_cast<char *>(seg.file->Data(seg.off));
+            }
+            else
+            {
+                iov[iovCnt].iov_base = const_cast<char *>(head);
+                head += seg.len;
+            }
+            iov[iovCnt].iov_len = seg.len;
+            iovCnt++;
+        }
 
+        ssize_t len;
+        if (iovCnt > 0)
+        {
+            // 后面紧跟 sendfile 段时带 MSG_MORE，让响应头与正文开头合进同一个报文
+            struct msghdr msg = {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iovCnt;
+            len = sendmsg(fd_, &msg, MSG_NOSIGNAL | (i < segCnt_ ? MSG_MORE : 0));
+        }
+        else
+        {
+            Segment &seg = segs_[i];
+            off_t off = seg.off;
+            len = sendfile(fd_, seg.file->fd, &off, seg.len);
+            if (len == 0)
+            {
+                // 文件在发送途中被截断，已发出的 Content-Length 无法兑现，只能断开连接
+                *saveErrno = EIO;
+                break;
+            }
+        }
         if (len <= 0)
         {
             *saveErrno = errno;
             break;
         }
-        if (iov_[0].iov_len + iov_[1].iov_len == 0)
+        totalLen += len;
+        Consume_(len);
+    }
+
+    return totalLen; // 返回总共写入的字节数
+}
+
+bool HttpConn::HasBufferedRequest() const
+{
+    return readBuff_.ReadableBytes() > 0 || (h2_ && h2_->HasPendingOutput());
+}
+
+bool HttpConn::IsReadingBody() const
+{
+    return h2_ ? h2_->HasOpenStreams() : request_.IsReadingBody();
+}
+
+bool HttpConn::IsBlockingRequest() const
+{
+    if (!router)
+    {
+        return false;
+    }
+    // HTTP/2 在解码头块之前看不到路径：带请求体的流(表单提交)交给线程池
+    if (h2_)
+    {
+        return h2_->HasDataFrame(readBuff_);
+    }
+    // 请求行：METHOD SP target SP ...，查询串不参与路由
+    const char *begin = readBuff_.Peek();
+    const char *end = begin + readBuff_.ReadableBytes();
+    const char *sp = std::find(begin, end, ' ');
+    if (sp == end)
+    {
+        return false;
+    }
+    const char *pathEnd = std::find(sp + 1, end, ' ');
+    std::string_view target(sp + 1, pathEnd - sp - 1);
+    target = target.substr(0, target.find('?'));
+
+    RouteMatch match;
+    return router->Match(Router::MethodOf(std::string_view(begin, sp - begin)), target, match) &&
+           match.route->blocking;
+}
+
+void HttpConn::Dispatch_()
+{
+    std::string_view method = request_.method();
+    if (!router)
+    {
+        // 没有路由表：GET / HEAD / POST 按请求路径发送静态文件
+        if (method != "GET" && method != "HEAD" && method != "POST")
         {
-            break;
-        } /* 传输结束 */
-        else if (static_cast<size_t>(len) > iov_[0].iov_len)
+            response_.SetFile(405, request_.path());
+        }
+        return;
+    }
+
+    RouteMatch match;
+    if (!router->Match(Router::MethodOf(method), request_.path(), match))
+    {
+        // 路径存在但方法不允许 => 405 并列出允许的方法
+        if (match.allow)
         {
-            iov_[1].iov_base = (uint8_t *)iov_[1].iov_base + (len - iov_[0].iov_len);
-            iov_[1].iov_len -= (len - iov_[0].iov_len);
-            if (iov_[0].iov_len)
-            {
-                writeBuff_.Clear();
-                iov_[0].iov_len = 0;
-            }
+            response_.SetFile(405, request_.path());
+            response_.SetAllow(Router::AllowOf(match.allow));
         }
         else
         {
-            iov_[0].iov_base = (uint8_t *)iov_[0].iov_base + len;
-            iov_[0].iov_len -= len;
-            writeBuff_.Retrieve(len);
+            response_.SetFile(404, request_.path());
         }
+        return;
     }
 
-    return totalLen; // 返回总共写入的字节数
+    const Route &route = *match.route;
+    switch (route.kind)
+    {
+    case Route::STATIC:
+        if (route.catchAll)
+        {
+            std::string_view tail = match.values[match.paramCount - 1];
+            response_.SetFile(200, route.target + std::string(tail));
+        }
+        else
+        {
+            response_.SetFile(200, route.target);
+        }
+        break;
+    case Route::REDIRECT:
+        response_.SetRedirect(route.code, route.target);
+        break;
+    case Route::CALLBACK:
+        route.handler(request_, match, response_);
+        break;
+    }
 }
 
-/**
- * @brief 解析请求，并生成响应
- * @return 若解析成功且有数据需要发送，返回 true，否则 false
- */
-bool HttpConn::process()
+std::string HttpConn::UploadSummary_() const
 {
-    request_.Init();
-    // 1. 解析请求(把 readBuff_ 中的数据解析到 request_)
-    if (readBuff_.ReadableBytes() <= 0)
+    // 每个文件一行：字段名 文件名 字节数 落盘文件名(不暴露目录)
+    std::string summary;
+    for (const MultipartParser::FilePart &file : request_.Upload().Files())
     {
-        return false;
+        std::string stored = file.spoolPath.substr(file.spoolPath.rfind('/') + 1);
+        summary += file.name + " " + file.filename + " " + std::to_string(file.size) + " " + stored + "\n";
     }
-    bool ret = request_.parse(readBuff_);
+    return summary;
+}
 
-    if (!ret)
+void HttpConn::AddSegment_(const CachedFile *file, size_t off, size_t len)
+{
+    if (!file && segCnt_ > segHead_ && !segs_[segCnt_ - 1].file)
     {
-        // 解析失败 => 返回 400
-        response_.Init(srcDir, request_.path(), false, 400);
-        return false;
+        segs_[segCnt_ - 1].len += len;
+        toWrite_ += len;
+        return;
+    }
+    Segment &seg = segs_[segCnt_++];
+    seg.file = file;
+    seg.off = off;
+    seg.len = len;
+    toWrite_ += len;
+}
+
+void HttpConn::Consume_(size_t n)
+{
+    toWrite_ -= n;
+    while (n > 0 && segHead_ < segCnt_)
+    {
+        Segment &seg = segs_[segHead_];
+        size_t take = std::min(n, seg.len);
+        if (seg.file)
+        {
+            seg.off += take;
+        }
+        else
+        {
+            writeBuff_.Retrieve(take);
+        }
+        seg.len -= take;
+        n -= take;
+        if (seg.len == 0)
+        {
+            if (seg.file)
+            {
+                FileCache::Unpin(seg.file);
+            }
+            seg.file = nullptr;
+            segHead_++;
+        }
+    }
+    // 跳过空段；全部写完后复位
+    while (segHead_ < segCnt_ && segs_[segHead_].len == 0)
+    {
+        segHead_++;
+    }
+    if (segHead_ == segCnt_)
+    {
+        segHead_ = segCnt_ = 0;
+    }
+}
+
+void HttpConn::ClearSegments_()
+{
+    for (int i = segHead_; i < segCnt_; i++)
+    {
+        if (segs_[i].file)
+        {
+            FileCache::Unpin(segs_[i].file);
+        }
+        segs_[i].file = nullptr;
+    }
+    segHead_ = segCnt_ = 0;
+    toWrite_ = 0;
+    writeBuff_.Clear();
+}
+
+void HttpConn::Respond_(HttpRequest::HTTP_CODE ret, bool keepAlive, Buffer &out)
+{
+    if (ret != HttpRequest::GET_REQUEST)
+    {
+        // 解析失败 / 请求体超限 / 上传写盘失败 => 400 / 413 / 500
+        int code = ret == HttpRequest::PAYLOAD_TOO_LARGE ? 413 : ret == HttpRequest::INTERNAL_ERROR ? 500 : 400;
+        response_.Init(srcDir, request_.path(), false, code);
     }
     else
     {
-        // 解析成功 => 构造 response
-        response_.Init(srcDir, request_.path(), request_.IsKeepAlive(), 200);
+        std::string_view method = request_.method();
+        bool head = method == "HEAD";
+        response_.Init(srcDir, request_.path(), keepAlive, 200);
+        response_.SetKeepAlive(keepAliveTimeoutSec, keepAliveMax - requestCount_);
+        if (method == "GET" || head)
+        {
+            response_.SetConditional(head, request_.GetHeader(HttpTables::H_IF_NONE_MATCH),
+                                     request_.GetHeader(HttpTables::H_IF_MODIFIED_SINCE));
+        }
+        if (method == "GET")
+        {
+            response_.SetRange(request_.GetHeader(HttpTables::H_RANGE),
+                               request_.GetHeader(HttpTables::H_IF_RANGE));
+        }
+        if (request_.IsUpload())
+        {
+            response_.SetContent(201, UploadSummary_(), "text/plain");
+        }
+        else
+        {
+            Dispatch_();
+        }
     }
+    // 错误页面与处理函数的输出同样按 Accept-Encoding 压缩
+    response_.SetAcceptEncoding(request_.GetHeader(HttpTables::H_ACCEPT_ENCODING));
+    // 生成响应头(追加到 out)，并 mmap 文件(若需要)
+    response_.MakeResponse(out);
+}
 
-    // 2. 生成响应头(写入 writeBuff_), 并 mmap 文件(若需要)
-    response_.MakeResponse(writeBuff_);
+bool HttpConn::ProcessH2_()
+{
+    // 正文还在按窗口发送时，读缓冲不会因可读事件而更新：先读一次，及时处理 WINDOW_UPDATE 与新的流
+    if (h2_->HasPendingOutput())
+    {
+        int err = 0;
+        read(&err);
+    }
+    h2_->Process(readBuff_);
+    keepAlive_ = !h2_->IsClosing();
+    // 会话要关闭时即使没有输出也返回 true，写循环随即关闭连接
+    return toWrite_ > 0 || !keepAlive_;
+}
 
-    // 3. 准备 iovec: [0] => writeBuff_  [1] => mmap file
-    //    在 write() 时统一发送
-    iov_[0].iov_base = const_cast<char *>(writeBuff_.Peek());
-    iov_[0].iov_len = writeBuff_.ReadableBytes();
-    iovCnt_ = 1;
+/**
+ * @brief 解析读缓冲中所有完整的请求，并依次生成响应
+ * @return 若有响应需要发送，返回 true，否则 false
+ */
+bool HttpConn::process(bool inlineOnly)
+{
+    if (h2_)
+    {
+        return ProcessH2_();
+    }
+    // 第一个请求之前：以 HTTP/2 连接前言开头的连接直接使用 HTTP/2(prior knowledge)
+    if (requestCount_ == 0 && !request_.IsReadingBody() && readBuff_.ReadableBytes() > 0)
+    {
+        int preface = Http2Session::MatchPreface(readBuff_);
+        if (preface == 0)
+        {
+            return false; // 目前是前言的前缀，等待更多数据
+        }
+        if (preface > 0)
+        {
+            h2_.reset(new Http2Session(*this));
+            h2_->Start(false);
+            return ProcessH2_();
+        }
+    }
 
-    if (response_.FileLen() > 0 && response_.File())
+    int produced = 0;
+    // 每个响应最多占 MAX_PIECES 段(多区间响应)
+    while (segCnt_ + HttpResponse::MAX_PIECES <= MAX_SEGMENTS && readBuff_.ReadableBytes() > 0)
     {
-        iov_[1].iov_base = response_.File();
-        iov_[1].iov_len = response_.FileLen();
-        iovCnt_ = 2;
+        // 流水线中后面的请求要查数据库等：不在 Reactor 线程上执行，先发送已生成的响应
+        if (inlineOnly && produced > 0 && IsBlockingRequest())
+        {
+            break;
+        }
+        // 上一个请求已处理完才开始新请求；不完整的请求保留解析进度，从断点继续
+        if (request_.IsFinish())
+        {
+            request_.Init();
+        }
+        // 1. 解析请求(直接在 readBuff_ 上解析)
+        HttpRequest::HTTP_CODE ret = request_.parse(readBuff_);
+        if (ret == HttpRequest::NO_REQUEST)
+        {
+            // 请求头已收齐、客户端在等 100 Continue 才发请求体：临时响应不影响连接状态
+            if (request_.TakeExpectContinue())
+            {
+                static const char CONTINUE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+                writeBuff_.Append(CONTINUE, sizeof(CONTINUE) - 1);
+                AddSegment_(nullptr, 0, sizeof(CONTINUE) - 1);
+                keepAlive_ = true;
+                produced++;
+            }
+            // 数据不完整 => 先发送已生成的响应，剩余部分继续读
+            break;
+        }
+
+        if (ret == HttpRequest::GET_REQUEST && request_.IsH2cUpgrade())
+        {
+            // Upgrade: h2c => 101 之后切换到 HTTP/2，本请求作为流 1 在新协议上响应
+            std::unique_ptr<Http2Session> session(new Http2Session(*this));
+            if (session->ApplyUpgradeSettings(request_.GetHeader(HttpTables::H_HTTP2_SETTINGS)))
+            {
+                static const char SWITCHING[] =
+                    "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+                writeBuff_.Append(SWITCHING, sizeof(SWITCHING) - 1);
+                AddSegment_(nullptr, 0, sizeof(SWITCHING) - 1);
+                requestCount_++;
+                h2_ = std::move(session);
+                h2_->Start(true);
+                readBuff_.Retrieve(request_.Length());
+                request_.Init();
+                ProcessH2_();
+                return true;
+            }
+        }
+
+        bool keepAlive = false;
+        if (ret == HttpRequest::GET_REQUEST)
+        {
+            // 达到最大请求数的这一次响应会带上 Connection: close
+            requestCount_++;
+            keepAlive = request_.IsKeepAlive() && requestCount_ < keepAliveMax &&
+                        !isDraining.load(std::memory_order_relaxed);
+        }
+
+        // 2. 生成响应；文件引用的所有权转给段队列
+        Respond_(ret, keepAlive, writeBuff_);
+        for (int i = 0; i < response_.PieceCount(); i++)
+        {
+            const HttpResponse::Piece &piece = response_.Pieces()[i];
+            AddSegment_(piece.file, piece.off, piece.len);
+        }
+        response_.ReleasePieces();
+        produced++;
+        keepAlive_ = keepAlive;
+
+        // 3. 请求已处理完，从读缓冲移除；不再保持连接时其后的数据全部丢弃
+        if (ret == HttpRequest::GET_REQUEST && keepAlive)
+        {
+            readBuff_.Retrieve(request_.Length());
+        }
+        else
+        {
+            readBuff_.Clear();
+            break;
+        }
     }
 
-    return true; // 有响应要发送
+    return produced > 0; // 有响应要发送
 }
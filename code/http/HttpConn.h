@@ -5,13 +5,18 @@
 #include <sys/types.h>
 #include <sys/uio.h> // readv, writev
 #include <atomic>    // std::atomic
+#include <memory>
 #include "../buffer/Buffer.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "Router.h"
 #include "config.h"
 
+class Http2Session;
+
 /**
  * @brief HttpConn 连接类，管理一个客户端 socket 的 HTTP 请求/响应
+ *        连接以 HTTP/2 前言开头(prior knowledge)或经 Upgrade: h2c 升级后，由 Http2Session 接管帧的收发
  */
 class HttpConn
 {
@@ -32,14 +37,15 @@ public:
     void Close();
 
     /**
-     * @brief 从 fd 中读取数据
+     * @brief 从 fd 中读取数据；读缓冲超过 MAX_READ_BATCH 时先停下，交给 process 消费
+     *        (连接以 EPOLLONESHOT 重新注册时内核会再次检查可读，剩余数据不会丢失事件)
      * @param saveErrno 若发生错误，将错误码写入该指针
      * @return 读取字节数；若 0 表示对端关闭；-1 表示发生错误
      */
     ssize_t read(int* saveErrno);
 
     /**
-     * @brief 向 fd 写出数据(支持多块缓冲：头部+文件映射)
+     * @brief 向 fd 写出数据：内存中的段合并成一次 sendmsg，fd 中的文件段用 sendfile
      * @param saveErrno 若发生错误，将错误码写入该指针
      * @return 写出字节数；若 -1 且 errno==EAGAIN/WBLOCK，需要等待下次可写事件
      */
@@ -66,25 +72,47 @@ public:
     sockaddr_in GetAddr() const;
 
     /**
-     * @brief 解析请求并生成响应
+     * @brief 解析读缓冲中所有完整的请求(流水线)，按顺序生成响应并排队等待写出
+     *        一批最多 MAX_PIPELINE 个；遇到不保持连接的请求后，其后的数据全部丢弃
+     *        HTTP/2 连接交给 Http2Session 处理读缓冲中的帧
+     * @param inlineOnly 运行到完成模式下在 Reactor 线程处理：批中后面的请求命中阻塞路由时在它之前停下，
+     *                   由调用方交给线程池(第一个请求由调用方事先检查)
      * @return 若需要写响应数据返回 true，否则 false
      */
-    bool process();
+    bool process(bool inlineOnly = false);
+
+    /**
+     * @brief 读缓冲中是否还有未处理的数据(流水线请求的剩余部分)，
+     *        或 HTTP/2 连接上还有窗口允许发送的正文
+     */
+    bool HasBufferedRequest() const;
+
+    /**
+     * @brief 请求头已收齐，正在等待请求体(超时按停滞时间计算)；HTTP/2 连接上有未结束的流
+     */
+    bool IsReadingBody() const;
+
+    /**
+     * @brief 只看请求行，判断读缓冲中的请求命中的路由是否会阻塞(如查询数据库)
+     *        用于运行到完成模式下决定是否把请求交给线程池
+     */
+    bool IsBlockingRequest() const;
 
     /**
-     * @brief 剩余待写字节数（含响应头和文件映射部分）
+     * @brief 剩余待写字节数（含响应头和文件正文部分）
      */
-    int ToWriteBytes() const
+    size_t ToWriteBytes() const
     {
-        return iov_[0].iov_len + iov_[1].iov_len;
+        return toWrite_;
     }
 
     /**
-     * @brief 是否保持长连接
+     * @brief 最近一批响应写完后是否保持长连接
+     *        (请求要求长连接，未超过单连接最大请求数，且生成响应时进程不在排空中)
      */
     bool IsKeepAlive() const
     {
-        return request_.IsKeepAlive();
+        return keepAlive_;
     }
 
     /**
@@ -104,29 +132,104 @@ public:
      */
     static const char *srcDir;
 
+    /**
+     * @brief 路由表：启动时由 Server 注册并冻结，之后只读，各 Reactor 线程共享
+     *        为空时按请求路径直接发送静态文件
+     */
+    static std::shared_ptr<const Router> router;
+
     /**
      * @brief 全局的活跃连接数
      */
     static std::atomic<int> userCount;
 
+    /**
+     * @brief 长连接参数：空闲超时(秒)与单连接最大请求数，来自配置
+     */
+    static int keepAliveTimeoutSec;
+    static int keepAliveMax;
+
+    /**
+     * @brief 进程正在排空(热升级 / 优雅退出)：之后的响应都带 Connection: close
+     */
+    static std::atomic<bool> isDraining;
+
+private:
+    friend class Http2Session;
+
+    // 一批最多处理的流水线请求数
+    static const int MAX_PIPELINE = 16;
+    // 段数组容量：前 MAX_PIPELINE - 1 个响应各占两段(头 + 文件)，最后一个最多占 MAX_PIECES 段
+    static const int MAX_SEGMENTS = 2 * (MAX_PIPELINE - 1) + HttpResponse::MAX_PIECES;
+    // 一次可读事件最多读入的字节数
+    static const size_t MAX_READ_BATCH = 256 * 1024;
+
+    /**
+     * @brief 待写出的一段数据：file 为空时表示 writeBuff_ 中的一段响应文本，否则为缓存文件中的一段
+     *        (内存副本与文本一起 sendmsg，否则 sendfile)
+     */
+    struct Segment
+    {
+        const CachedFile *file; // 已 Pin 的文件(写完后 Unpin)
+        size_t off;             // 待写数据在文件中的偏移
+        size_t len;             // 剩余字节数
+    };
+
+    // 追加一段(文件段的引用转给段队列)：紧跟在文本段之后的文本合并为一段
+    void AddSegment_(const CachedFile *file, size_t off, size_t len);
+    // 已写出 n 字节：推进各段，写完的文件段释放引用
+    void Consume_(size_t n);
+    // 丢弃所有未写出的段
+    void ClearSegments_();
+    // 返回客户端地址，还没有时用 getpeername 取得
+    const sockaddr_in &PeerAddr_() const;
+
+    /**
+     * @brief 为 request_ 中解析完的请求生成响应追加到 out，各段由 response_ 记录
+     * @param ret       解析结果，不是 GET_REQUEST 时返回 400 / 413 / 500
+     * @param keepAlive 响应是否保持连接
+     */
+    void Respond_(HttpRequest::HTTP_CODE ret, bool keepAlive, Buffer &out);
+
+    /**
+     * @brief HTTP/2 连接：先非阻塞地读一次 socket，再交给会话处理
+     */
+    bool ProcessH2_();
+
+    /**
+     * @brief 按路由表决定请求的处理方式：静态文件 / 重定向 / 回调 / 404 / 405
+     */
+    void Dispatch_();
+
+    /**
+     * @brief 上传完成后的响应正文：列出落盘的文件
+     */
+    std::string UploadSummary_() const;
+
 private:
     bool isWriting_; // 是否正在写数据
     bool isClose_;   // 连接是否已关闭
+    int requestCount_; // 本连接已处理的请求数
 
     int fd_;           // 客户端 socket
-    sockaddr_in addr_; // 客户端地址
+    // 客户端地址；multishot accept 交来的连接没有地址，首次使用时由 getpeername 补上
+    mutable sockaddr_in addr_;
 
-    // iovec 相关：一次 writev() 可以写两块数据
-    //  - iov_[0]: 存放响应头和部分内容
-    //  - iov_[1]: 可能是文件映射的内容(如静态文件)
-    struct iovec iov_[2];
-    int iovCnt_;
+    bool keepAlive_;   // 最近一批响应之后是否保持连接
+
+    // 排队中的响应：[头1][文件1][头2][文件2]...，文本段依次存放在 writeBuff_ 中
+    Segment segs_[MAX_SEGMENTS];
+    int segHead_;    // 第一个未写完的段
+    int segCnt_;     // 段数
+    size_t toWrite_; // 剩余待写字节数
 
     Buffer readBuff_;  // 读缓冲
     Buffer writeBuff_; // 写缓冲
 
     HttpRequest request_;   // HTTP 请求
     HttpResponse response_; // HTTP 响应
+
+    std::unique_ptr<Http2Session> h2_; // HTTP/2 会话，HTTP/1.x 连接为空
 };
 
 #endif // HTTP_CONN_H
@@ -1,21 +1,15 @@
 #include "HttpRequest.h"
+#include "HttpScan.h"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <strings.h> // strncasecmp
 #include <iostream>
 
-/**
- * @brief 一些静态资源名的示例
- */
-const std::unordered_set<std::string> HttpRequest::DEFAULT_HTML{
-    "/index", "/register", "/login", "/welcome", "/video", "/picture"};
-
-/**
- * @brief 对应的标识
- */
-const std::unordered_map<std::string, int> HttpRequest::DEFAULT_HTML_TAG{
-    {"/register.html", 0},
-    {"/login.html", 1},
-};
+size_t HttpRequest::maxBodyBytes = 1024 * 1024;
+std::string HttpRequest::uploadPath = "/upload";
+std::string HttpRequest::uploadDir;
+size_t HttpRequest::maxUploadBytes = 512 * 1024 * 1024;
 
 /* =====================================================================
  * 构造 / 析构 / 初始化
@@ -29,11 +23,28 @@ HttpRequest::HttpRequest()
 void HttpRequest::Init()
 {
     state_ = REQUEST_LINE;
-    method_.clear();
+    base_ = nullptr;
+    data_ = nullptr;
+    lineOff_ = 0;
+    scanOff_ = 0;
+    bodyOff_ = 0;
+    contentLength_ = 0;
+    remain_ = 0;
+    length_ = 0;
+    chunked_ = false;
+    expectContinue_ = false;
+    streaming_ = false;
+    headerCopy_.clear();
+    upload_.Reset(); // 未完成的上传删除已写入的文件
+    method_ = {0, 0};
+    target_ = {0, 0};
+    query_ = {0, 0};
+    version_ = {0, 0};
     path_.clear();
-    version_.clear();
     body_.clear();
-    header_.clear();
+    keepAlive_ = false;
+    headerCount_ = 0;
+    memset(known_, 0, sizeof(known_));
     post_.clear();
 }
 
@@ -41,61 +52,165 @@ void HttpRequest::Init()
  * 对外接口
  * ===================================================================== */
 
-bool HttpRequest::parse(Buffer &buff)
+HttpRequest::HTTP_CODE HttpRequest::parse(Buffer &buff)
 {
-    // 循环，从缓冲区里按行读取数据，然后依次解析 请求行 -> 头 -> 体
-    const char CRLF[] = "\r\n";
-    if (buff.ReadableBytes() <= 0)
-    { // 如果缓冲区没有数据，返回false
-        return false;
+    // 缓冲可能在两次调用之间扩容或前移，每次都重新取起点，内部只用偏移
+    data_ = buff.Peek();
+    if (!streaming_)
+    {
+        base_ = data_;
+    }
+    HTTP_CODE ret = Parse_(buff.ReadableBytes());
+
+    // 上传：已处理的数据立即移出读缓冲，只留下不完整的一行(分块长度行等)
+    if (streaming_ && lineOff_ > 0)
+    {
+        buff.Retrieve(lineOff_);
+        scanOff_ -= lineOff_;
+        length_ = length_ > lineOff_ ? length_ - lineOff_ : 0;
+        lineOff_ = 0;
     }
+    return ret;
+}
 
-    while (buff.ReadableBytes() && state_ != FINISH)
+HttpRequest::HTTP_CODE HttpRequest::Parse_(size_t total)
+{
+    while (state_ != FINISH)
     {
-        if (state_ == BODY)
+        if (state_ == BODY && !streaming_)
         {
-            // 直接处理整个请求体
-            std::string body(buff.Peek(), buff.Peek() + buff.ReadableBytes());
-            ParseBody_(body);                    // 解析请求体
-            buff.Retrieve(buff.ReadableBytes()); // 清空已读取的 body 数据
-            state_ = FINISH;                     // BODY 解析完成，状态置为 FINISH
+            if (total - bodyOff_ < contentLength_)
+            {
+                return NO_REQUEST; // 请求体还没收全
+            }
+            length_ = bodyOff_ + contentLength_;
+            state_ = FINISH;
             break;
         }
 
-        // 其他状态（REQUEST_LINE 和 HEADERS）
-        const char *lineEnd = std::search(buff.Peek(), buff.Peek() + buff.ReadableBytes(), CRLF, CRLF + 2);
-        if (lineEnd == buff.Peek() + buff.ReadableBytes())
+        if (state_ == BODY || state_ == CHUNK_DATA)
         {
-            // 没有找到 "\r\n"，等待更多数据
-            break;
+            // 分块数据 / 上传的请求体按长度跳过，不做行扫描
+            size_t take = std::min(total - lineOff_, remain_);
+            HTTP_CODE ret = OnBodyData_(data_ + lineOff_, take);
+            if (ret != NO_REQUEST)
+            {
+                return ret;
+            }
+            lineOff_ += take;
+            scanOff_ = lineOff_;
+            remain_ -= take;
+            if (remain_ > 0)
+            {
+                return NO_REQUEST;
+            }
+            if (state_ == BODY)
+            {
+                length_ = lineOff_;
+                state_ = FINISH;
+                break;
+            }
+            state_ = CHUNK_END;
+            continue;
+        }
+
+        // 请求行 / 请求头整体受 MAX_HEADER_BYTES 限制，分块长度行 / trailer 逐行受 MAX_CHUNK_LINE 限制
+        const bool inHeader = state_ == REQUEST_LINE || state_ == HEADERS;
+        const size_t lineLimit = inHeader ? MAX_HEADER_BYTES : lineOff_ + MAX_CHUNK_LINE;
+
+        // 从上次扫描到的位置继续找行尾，不重复扫描；同一遍扫描中发现的其他控制字符说明报文非法
+        const char *end = data_ + total;
+        const char *lf = HttpScan::FindSpecial(data_ + scanOff_, end);
+        if (lf != end && *lf == '\r')
+        {
+            if (lf + 1 == end)
+            {
+                lf = end; // CR 恰好在末尾：下次从 CR 处继续
+            }
+            else if (lf[1] == '\n')
+            {
+                lf++;
+            }
+            else
+            {
+                return BAD_REQUEST; // 单独的 CR
+            }
+        }
+        if (lf == end)
+        {
+            scanOff_ = (total > scanOff_ && end[-1] == '\r') ? total - 1 : total;
+            return total > lineLimit ? BAD_REQUEST : NO_REQUEST;
+        }
+        if (*lf != '\n')
+        {
+            return BAD_REQUEST; // 其他控制字符
+        }
+        size_t next = lf - data_ + 1;
+        if (next > lineLimit)
+        {
+            return BAD_REQUEST;
         }
 
-        std::string line(buff.Peek(), lineEnd); // 提取当前行
+        // 行尾兼容单独的 \n
+        const char *lineBegin = data_ + lineOff_;
+        const char *lineEnd = lf;
+        if (lineEnd > lineBegin && lineEnd[-1] == '\r')
+        {
+            lineEnd--;
+        }
 
+        HTTP_CODE ret = NO_REQUEST;
         switch (state_)
         {
         case REQUEST_LINE:
-            if (!ParseRequestLine_(line))
+            // 请求行之前的空行忽略(RFC 9112 2.2)
+            if (lineEnd != lineBegin)
             {
-                return false; // 解析请求行失败，返回false
+                if (!ParseRequestLine_(lineBegin, lineEnd) || !ParsePath_())
+                {
+                    return BAD_REQUEST;
+                }
+                state_ = HEADERS;
             }
-            ParsePath_(); // 解析路径（如果需要）
-            // state_ = PARSE_STATE::HEADERS;
             break;
 
         case HEADERS:
-            ParseHeader_(line); // 解析请求头
+            if (lineEnd == lineBegin)
+            {
+                // 空行：请求头结束
+                ret = OnHeadersComplete_(next);
+            }
+            else if (!ParseHeader_(lineBegin, lineEnd))
+            {
+                return BAD_REQUEST;
+            }
+            break;
+
+        case CHUNK_SIZE:
+            ret = ParseChunkSize_(lineBegin, lineEnd);
+            break;
 
-            // 检查是否遇到空行，表示请求头结束
-            if (line.empty())
+        case CHUNK_END:
+            if (lineEnd != lineBegin)
             {
-                if (method_ == "POST")
-                {
-                    state_ = BODY; // 如果是 POST 请求，转到 BODY 状态
-                }
-                else
+                return BAD_REQUEST; // 分块数据比声明的长
+            }
+            state_ = CHUNK_SIZE;
+            break;
+
+        case TRAILERS:
+            // trailer 字段不合并进请求头，只校验格式；空行表示请求结束
+            if (lineEnd == lineBegin)
+            {
+                length_ = next;
+                state_ = FINISH;
+            }
+            else
+            {
+                const char *colon = HttpScan::FindTokenEnd(lineBegin, lineEnd);
+                if (colon == lineBegin || colon == lineEnd || *colon != ':')
                 {
-                    state_ = FINISH; // 否则，解析完成
+                    return BAD_REQUEST;
                 }
             }
             break;
@@ -103,24 +218,61 @@ bool HttpRequest::parse(Buffer &buff)
         default:
             break;
         }
+        if (ret != NO_REQUEST)
+        {
+            return ret;
+        }
+        lineOff_ = scanOff_ = next;
 
-        // 安全检查 lineEnd 是否有效
-        if (lineEnd >= buff.Peek() && lineEnd <= buff.Peek() + buff.ReadableBytes())
+        // 分块编码的帧开销(长度行 / CRLF / trailer)同样计入上限，防止大量极小分块撑大读缓冲；
+        // 上传时已处理的数据不留在读缓冲中
+        if (chunked_ && !streaming_ && next - bodyOff_ > maxBodyBytes + MAX_HEADER_BYTES)
         {
-            size_t lineLength = lineEnd - buff.Peek() + 2; // 行长度，包括 \r\n
-            buff.Retrieve(lineLength);                     // 从缓冲区中删除已读取的数据
+            return PAYLOAD_TOO_LARGE;
         }
-        else
+    }
+
+    // 请求体结束时 multipart 也必须结束
+    if (streaming_ && !upload_.IsDone())
+    {
+        return BAD_REQUEST;
+    }
+    OnFinish_();
+    return GET_REQUEST;
+}
+
+HttpRequest::HTTP_CODE HttpRequest::OnBodyData_(const char *data, size_t len)
+{
+    if (streaming_)
+    {
+        switch (upload_.Feed(data, len))
         {
-            // std::cerr << "Invalid lineEnd pointer detected." << std::endl;
-            return false; // 如果 lineEnd 无效，返回 false 避免段错误
+        case MultipartParser::OK:
+            return NO_REQUEST;
+        case MultipartParser::TOO_LARGE:
+            return PAYLOAD_TOO_LARGE;
+        case MultipartParser::IO_ERROR:
+            return INTERNAL_ERROR;
+        default:
+            return BAD_REQUEST;
         }
     }
+    // 只有 POST 表单需要解码后的请求体
+    if (View_(method_) == "POST")
+    {
+        body_.append(data, len);
+    }
+    return NO_REQUEST;
+}
 
-    return true;
+bool HttpRequest::TakeExpectContinue()
+{
+    bool expect = expectContinue_;
+    expectContinue_ = false;
+    return expect;
 }
 
-std::string HttpRequest::path() const
+const std::string &HttpRequest::path() const
 {
     return path_;
 }
@@ -130,14 +282,37 @@ void HttpRequest::path(const std::string &path)
     path_ = path;
 }
 
-std::string HttpRequest::method() const
+std::string_view HttpRequest::method() const
 {
-    return method_;
+    return View_(method_);
 }
 
-std::string HttpRequest::version() const
+std::string_view HttpRequest::version() const
 {
-    return version_;
+    return View_(version_);
+}
+
+std::string_view HttpRequest::query() const
+{
+    return View_(query_);
+}
+
+std::string_view HttpRequest::GetHeader(std::string_view name) const
+{
+    HttpTables::HeaderId id = HttpTables::LookupHeader(name);
+    if (id != HttpTables::H_UNKNOWN)
+    {
+        return GetHeader(id);
+    }
+    for (int i = 0; i < headerCount_; i++)
+    {
+        std::string_view key = View_(headers_[i].name);
+        if (key.size() == name.size() && strncasecmp(key.data(), name.data(), name.size()) == 0)
+        {
+            return View_(headers_[i].value);
+        }
+    }
+    return std::string_view();
 }
 
 std::string HttpRequest::GetPost(const std::string &key) const
@@ -151,60 +326,287 @@ std::string HttpRequest::GetPost(const std::string &key) const
 
 bool HttpRequest::IsKeepAlive() const
 {
-    auto it = header_.find("Connection");
-    if (it != header_.end())
+    return keepAlive_;
+}
+
+bool HttpRequest::IsH2cUpgrade() const
+{
+    if (View_(version_) != "HTTP/1.1" || contentLength_ > 0 || chunked_)
     {
-        return it->second == "keep-alive";
+        return false;
     }
-    return false; // 默认为短连接
+    std::string_view connection = GetHeader(HttpTables::H_CONNECTION);
+    return HasToken_(GetHeader(HttpTables::H_UPGRADE), "h2c") &&
+           HasToken_(connection, "upgrade") && HasToken_(connection, "http2-settings") &&
+           known_[HttpTables::H_HTTP2_SETTINGS];
 }
 
 /* =====================================================================
  * 解析核心逻辑
  * ===================================================================== */
 
+namespace
+{
+    bool IsDigit(char ch)
+    {
+        return ch >= '0' && ch <= '9';
+    }
+}
+
 /**
  * @brief 解析请求行: 例如 "GET /index.html HTTP/1.1"
+ *        method = token，target = 非空白可见字符，version = HTTP/数字.数字
  */
-bool HttpRequest::ParseRequestLine_(const std::string &line)
+bool HttpRequest::ParseRequestLine_(const char *begin, const char *end)
 {
-    // 正则：(\S+)匹配方法，(\S+)匹配路径，(HTTP/\d\.\d)匹配版本
-    std::regex pattern(R"((GET|POST) (\S+) (HTTP/\d\.\d))");
-    std::smatch match;
-    if (std::regex_match(line, match, pattern))
+    const char *p = HttpScan::FindTokenEnd(begin, end);
+    if (p == begin || p == end || *p != ' ')
     {
-        method_ = match[1];
-        path_ = match[2];
-        version_ = match[3];
-        return true;
+        return false;
     }
-    return false;
+    method_ = {static_cast<uint32_t>(begin - base_), static_cast<uint32_t>(p - begin)};
+
+    // 整行已确认没有控制字符，target 到下一个空格为止
+    const char *targetBegin = ++p;
+    p = static_cast<const char *>(memchr(targetBegin, ' ', end - targetBegin));
+    if (!p || p == targetBegin)
+    {
+        return false;
+    }
+    target_ = {static_cast<uint32_t>(targetBegin - base_), static_cast<uint32_t>(p - targetBegin)};
+
+    const char *versionBegin = ++p;
+    if (end - versionBegin != 8 || memcmp(versionBegin, "HTTP/", 5) != 0 ||
+        !IsDigit(versionBegin[5]) || versionBegin[6] != '.' || !IsDigit(versionBegin[7]))
+    {
+        return false;
+    }
+    version_ = {static_cast<uint32_t>(versionBegin - base_), 8};
+    return true;
 }
 
 /**
- * @brief 解析请求头：形如 "Connection: keep-alive"
+ * @brief 解析请求头：形如 "Connection: keep-alive"，值去掉首尾空白
  */
-void HttpRequest::ParseHeader_(const std::string &line)
+bool HttpRequest::ParseHeader_(const char *begin, const char *end)
 {
-    size_t pos = line.find(':');
-    if (pos != std::string::npos)
+    const char *colon = HttpScan::FindTokenEnd(begin, end);
+    // 名字为空、名字后有空白(RFC 9112 5.1)或以空白开头的折行，都视为非法
+    if (colon == begin || colon == end || *colon != ':')
     {
-        std::string key = line.substr(0, pos);
-        std::string value = line.substr(pos + 2); // 忽略": "部分
-        header_[key] = value;
+        return false;
+    }
+
+    const char *valueBegin = colon + 1;
+    const char *valueEnd = end;
+    while (valueBegin < valueEnd && (*valueBegin == ' ' || *valueBegin == '\t'))
+    {
+        valueBegin++;
     }
+    while (valueEnd > valueBegin && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+    {
+        valueEnd--;
+    }
+
+    // 超出上限的头部直接忽略
+    if (headerCount_ < MAX_HEADERS)
+    {
+        HeaderField &field = headers_[headerCount_++];
+        field.name = {static_cast<uint32_t>(begin - base_), static_cast<uint32_t>(colon - begin)};
+        field.value = {static_cast<uint32_t>(valueBegin - base_), static_cast<uint32_t>(valueEnd - valueBegin)};
+        field.id = HttpTables::LookupHeader(std::string_view(begin, colon - begin));
+        if (field.id != HttpTables::H_UNKNOWN && !known_[field.id])
+        {
+            known_[field.id] = static_cast<uint8_t>(headerCount_);
+        }
+    }
+    return true;
 }
 
-/**
- * @brief 解析请求体
- */
-void HttpRequest::ParseBody_(const std::string &line)
+HttpRequest::HTTP_CODE HttpRequest::OnHeadersComplete_(size_t headerEnd)
+{
+    bodyOff_ = headerEnd;
+    length_ = headerEnd;
+
+    // Content-Length 可能出现多次，值必须一致；与 Transfer-Encoding 同时出现时拒绝(RFC 9112 6.3，防止请求走私)
+    std::string_view len;
+    std::string_view te;
+    for (int i = 0; i < headerCount_; i++)
+    {
+        std::string_view value = View_(headers_[i].value);
+        if (headers_[i].id == HttpTables::H_CONTENT_LENGTH)
+        {
+            if (!len.empty() && len != value)
+            {
+                return BAD_REQUEST;
+            }
+            len = value;
+        }
+        else if (headers_[i].id == HttpTables::H_TRANSFER_ENCODING)
+        {
+            if (!te.empty())
+            {
+                return BAD_REQUEST;
+            }
+            te = value;
+        }
+    }
+
+    // POST multipart/form-data 到上传路径：请求体流式落盘，不留在读缓冲中
+    std::string_view boundary;
+    if (!uploadDir.empty() && path_ == uploadPath && View_(method_) == "POST")
+    {
+        boundary = MultipartParser::Boundary(GetHeader(HttpTables::H_CONTENT_TYPE));
+    }
+    if (!boundary.empty() && (!te.empty() || !len.empty()))
+    {
+        upload_.Init(boundary, uploadDir, maxUploadBytes);
+        // 请求头拷贝出来，之后读缓冲中的请求头可以被移除
+        headerCopy_.assign(data_, headerEnd);
+        base_ = headerCopy_.data();
+        streaming_ = true;
+    }
+
+    if (!te.empty())
+    {
+        // 只支持 chunked 一种传输编码，且 HTTP/1.0 不允许使用
+        if (!len.empty() || View_(version_) != "HTTP/1.1" ||
+            te.size() != 7 || strncasecmp(te.data(), "chunked", 7) != 0)
+        {
+            return BAD_REQUEST;
+        }
+        chunked_ = true;
+        state_ = CHUNK_SIZE;
+    }
+    else if (!len.empty())
+    {
+        size_t value = 0;
+        for (char ch : len)
+        {
+            if (!IsDigit(ch) || value > (SIZE_MAX - 9) / 10)
+            {
+                return BAD_REQUEST;
+            }
+            value = value * 10 + (ch - '0');
+        }
+        // 声明的长度超限时直接拒绝，不再接收请求体
+        if (value > BodyLimit_())
+        {
+            return PAYLOAD_TOO_LARGE;
+        }
+        contentLength_ = value;
+        remain_ = value;
+        state_ = contentLength_ > 0 ? BODY : FINISH;
+    }
+    else
+    {
+        state_ = FINISH;
+    }
+
+    // 请求体还没到时，客户端可能在等 100 Continue 才发送
+    if (state_ != FINISH && View_(version_) == "HTTP/1.1")
+    {
+        std::string_view expect = GetHeader(HttpTables::H_EXPECT);
+        expectContinue_ = expect.size() == 12 && strncasecmp(expect.data(), "100-continue", 12) == 0;
+    }
+    return NO_REQUEST;
+}
+
+HttpRequest::HTTP_CODE HttpRequest::ParseChunkSize_(const char *begin, const char *end)
 {
-    body_ = line;
-    ParsePost_();
+    // chunk-size = 1*HEXDIG，其后可带 ;扩展(忽略)
+    size_t size = 0;
+    const char *p = begin;
+    for (; p < end; p++)
+    {
+        int digit = ConverHex(*p);
+        if (digit < 0)
+        {
+            break;
+        }
+        if (size > BodyLimit_())
+        {
+            return PAYLOAD_TOO_LARGE; // 防止溢出：已经超限就不必再累加
+        }
+        size = size * 16 + digit;
+    }
+    if (p == begin)
+    {
+        return BAD_REQUEST;
+    }
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    if (p < end && *p != ';')
+    {
+        return BAD_REQUEST;
+    }
 
-    // 状态置为 FINISH
-    state_ = FINISH;
+    if (size > BodyLimit_() - contentLength_)
+    {
+        return PAYLOAD_TOO_LARGE;
+    }
+    contentLength_ += size;
+    remain_ = size;
+    state_ = size > 0 ? CHUNK_DATA : TRAILERS; // 长度为 0 的分块表示请求体结束
+    return NO_REQUEST;
+}
+
+void HttpRequest::OnFinish_()
+{
+    // HTTP/1.1 默认长连接，除非 Connection 中带 close；HTTP/1.0 需要显式 keep-alive
+    std::string_view conn = GetHeader(HttpTables::H_CONNECTION);
+    if (View_(version_) == "HTTP/1.1")
+    {
+        keepAlive_ = !HasToken_(conn, "close");
+    }
+    else
+    {
+        keepAlive_ = HasToken_(conn, "keep-alive");
+    }
+
+    // 上传的普通字段与表单一样通过 GetPost 取得
+    if (streaming_)
+    {
+        for (const auto &field : upload_.Fields())
+        {
+            post_[field.first] = field.second;
+        }
+        return;
+    }
+
+    // 只有 POST 表单才拷贝请求体；分块编码的请求体已在解码时拷贝
+    if (View_(method_) == "POST" && contentLength_ > 0)
+    {
+        if (!chunked_)
+        {
+            body_.assign(data_ + bodyOff_, contentLength_);
+        }
+        ParsePost_();
+    }
+}
+
+bool HttpRequest::HasToken_(std::string_view list, std::string_view token)
+{
+    // 逗号分隔、不区分大小写，忽略两侧空白
+    while (!list.empty())
+    {
+        size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+            item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+            item.remove_suffix(1);
+        if (item.size() == token.size() && strncasecmp(item.data(), token.data(), token.size()) == 0)
+        {
+            return true;
+        }
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
 }
 
 /* =====================================================================
@@ -214,27 +616,11 @@ void HttpRequest::ParseBody_(const std::string &line)
 void HttpRequest::ParsePost_()
 {
     //  根据 header["content-type"] 判断表单类型：application/x-www-form-urlencoded 或 multipart/form-data
-    if (method_ == "POST" && header_["Content-Type"] == "application/x-www-form-urlencoded")
+    std::string_view type = GetHeader(HttpTables::H_CONTENT_TYPE);
+    if (type.substr(0, 33) == "application/x-www-form-urlencoded")
     {
-
+        // 表单字段交给路由的处理函数(如登录 / 注册)通过 GetPost 读取
         ParseFromUrlencoded_();
-
-        if (DEFAULT_HTML_TAG.count(path_))
-        {
-            int tag = DEFAULT_HTML_TAG.find(path_)->second;
-            if (tag == 0 || tag == 1)
-            {
-                bool isLogin = (tag == 1);
-                if (UserVerify(post_["username"], post_["password"], isLogin))
-                {
-                    path_ = "/welcome.html";
-                }
-                else
-                {
-                    path_ = "/error.html";
-                }
-            }
-        }
     }
 }
 
@@ -288,24 +674,97 @@ void HttpRequest::ParseFromUrlencoded_()
  * 解析路径 / 资源等
  * ===================================================================== */
 
-void HttpRequest::ParsePath_()
+bool HttpRequest::ParsePath_()
 {
-    if (path_ == "/")
+    // 去掉查询串
+    std::string_view target = View_(target_);
+    size_t q = target.find('?');
+    if (q != std::string_view::npos)
     {
-        path_ = "/index.html";
+        query_ = {static_cast<uint32_t>(target_.off + q + 1), static_cast<uint32_t>(target.size() - q - 1)};
+        target = target.substr(0, q);
     }
-    else
+    // absolute-form(http://host/path，RFC 9112 3.2.2)只取路径部分
+    if (!target.empty() && target[0] != '/')
     {
-        for (auto &item : DEFAULT_HTML)
+        size_t scheme = target.find("://");
+        std::string_view name = target.substr(0, scheme);
+        if (scheme == std::string_view::npos ||
+            !(HttpTables::EqualNoCase(name, "http") || HttpTables::EqualNoCase(name, "https")))
         {
-            if (item == path_)
+            return false; // 不支持 asterisk-form 与 authority-form
+        }
+        size_t slash = target.find('/', scheme + 3);
+        target = slash == std::string_view::npos ? std::string_view("/") : target.substr(slash);
+    }
+    return NormalizePath(target, path_);
+}
+
+bool HttpRequest::NormalizePath(std::string_view path, std::string &out)
+{
+    out.clear();
+    if (path.empty() || path[0] != '/')
+    {
+        return false;
+    }
+    // 先解码，编码过的 "%2e%2e%2f" 与字面的 "../" 一样处理
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        char ch = path[i];
+        if (ch == '%')
+        {
+            int hi = i + 2 < path.size() ? ConverHex(path[i + 1]) : -1;
+            int lo = hi >= 0 ? ConverHex(path[i + 2]) : -1;
+            if (lo < 0)
             {
-                path_ += ".html";
-                break;
+                return false;
+            }
+            ch = static_cast<char>(hi * 16 + lo);
+            i += 2;
+        }
+        if (ch == '\0')
+        {
+            return false;
+        }
+        out.push_back(ch);
+    }
+
+    // 去掉点段：逐段拷贝到写位置 w 之前，w 不会超过读位置，可以原地进行
+    size_t w = 0;
+    size_t i = 0;
+    size_t n = out.size();
+    while (i < n)
+    {
+        size_t j = out.find('/', i + 1);
+        if (j == std::string::npos)
+        {
+            j = n;
+        }
+        std::string_view seg(out.data() + i + 1, j - i - 1);
+        if (seg == "." || seg == "..")
+        {
+            if (seg == "..")
+            {
+                if (w == 0)
+                {
+                    return false; // 越过根目录
+                }
+                w = out.rfind('/', w - 1);
+            }
+            if (j == n)
+            {
+                out[w++] = '/'; // "/a/." 与 "/a/b/.." 都以 '/' 结尾
             }
         }
+        else
+        {
+            memmove(&out[w], &out[i], j - i);
+            w += j - i;
+        }
+        i = j;
     }
-    this->state_ = PARSE_STATE::HEADERS;
+    out.resize(w);
+    return true;
 }
 
 /* =====================================================================
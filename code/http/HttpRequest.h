@@ -2,18 +2,24 @@
 #define HTTP_REQUEST_H
 
 #include <unordered_map>
-#include <unordered_set>
 #include <string>
-#include <regex>
-#include <sstream>
+#include <string_view>
+#include <cstdint>
 #include <mysql/mysql.h> // MySQL 连接池支持
 
 #include "../buffer/Buffer.h"
+#include "MultipartParser.h"
+#include "HttpTables.h"
 #include "../pool/SqlConnRAII.h"
 #include "../pool/SqlConnPool.h"
 
 /**
  * @brief 表示一个 HTTP 请求的解析过程和结果
+ *        增量解析：直接在读缓冲上按行推进，数据不完整时记住扫描位置，下次从断点继续，
+ *        请求在任意字节处被拆开都能正确解析；
+ *        方法 / 版本 / 请求头只记录在缓冲中的偏移，通过 string_view 访问，常见路径上不分配堆内存；
+ *        上传(POST multipart/form-data 到 uploadPath)时请求头拷贝一份，请求体边到达边交给
+ *        MultipartParser 落盘并从读缓冲移除，读缓冲不随上传大小增长
  */
 class HttpRequest
 {
@@ -25,7 +31,11 @@ public:
     {
         REQUEST_LINE, // 正在解析请求行
         HEADERS,      // 正在解析请求头
-        BODY,         // 正在解析请求体
+        BODY,         // 正在接收请求体(Content-Length)
+        CHUNK_SIZE,   // 正在解析分块长度行(Transfer-Encoding: chunked)
+        CHUNK_DATA,   // 正在接收分块数据
+        CHUNK_END,    // 分块数据之后的 CRLF
+        TRAILERS,     // 最后一个分块之后的 trailer 字段
         FINISH,       // 解析完成
     };
 
@@ -42,6 +52,7 @@ public:
         FILE_REQUEST,      // 静态文件请求
         INTERNAL_ERROR,    // 服务器内部错误
         CLOSED_CONNECTION, // 客户端关闭连接
+        PAYLOAD_TOO_LARGE, // 请求体超过上限(413)
     };
 
 public:
@@ -54,16 +65,46 @@ public:
     void Init();
 
     /**
-     * @brief 从 buff 中解析 HTTP 请求内容
-     * @param buff 存放请求数据的缓冲区
-     * @return 是否解析成功
+     * @brief 从 buff 中增量解析 HTTP 请求
+     *        普通请求不移动 buff 的读指针，完整后由调用方 Retrieve(Length())；
+     *        上传请求的请求头和已处理的请求体会在解析过程中从 buff 移除
+     * @param buff 存放请求数据的缓冲区，请求从 buff.Peek() 开始
+     * @return NO_REQUEST 数据不完整，需要继续读；GET_REQUEST 请求完整；BAD_REQUEST 请求非法；
+     *         PAYLOAD_TOO_LARGE 请求体超过 maxBodyBytes(Content-Length 超限时不等请求体到达就返回)
      */
-    bool parse(Buffer &buff);
+    HTTP_CODE parse(Buffer &buff);
 
     /**
-     * @brief 获取解析后的请求路径
+     * @brief 请求是否已完整解析
      */
-    std::string path() const;
+    bool IsFinish() const { return state_ == FINISH; }
+
+    /**
+     * @brief 请求头已收齐，正在接收请求体
+     */
+    bool IsReadingBody() const { return state_ >= BODY && state_ < FINISH; }
+
+    /**
+     * @brief 是否为流式上传请求；完整后可通过 Upload() 取得落盘的文件
+     */
+    bool IsUpload() const { return streaming_; }
+    const MultipartParser &Upload() const { return upload_; }
+
+    /**
+     * @brief 完整请求(请求行 + 头 + 体)在缓冲中占用的字节数，处理完后由调用方 Retrieve
+     */
+    size_t Length() const { return length_; }
+
+    /**
+     * @brief 请求头已收齐、请求体未到，且客户端带了 Expect: 100-continue，需要先回 100 Continue
+     *        每个请求只返回一次 true
+     */
+    bool TakeExpectContinue();
+
+    /**
+     * @brief 获取解析后的请求路径(不含查询串)
+     */
+    const std::string &path() const;
 
     /**
      * @brief 设置(重置)请求路径
@@ -71,14 +112,44 @@ public:
     void path(const std::string &path);
 
     /**
-     * @brief 获取请求方法(GET/POST等)
+     * @brief 规范化 origin-form 的路径(不含查询串)：先解码 %xx(含 %2e / %2f)，
+     *        再按 RFC 3986 5.2.4 去掉 "." / ".." 段；路由与 h2 合成的请求都经过这里
+     * @return false 表示不以 '/' 开头、转义非法、含 NUL，或 ".." 越过了根目录
+     */
+    static bool NormalizePath(std::string_view path, std::string &out);
+
+    /**
+     * 以下 string_view 指向读缓冲，在缓冲被 Retrieve / 再次读入之前有效
+     */
+
+    /**
+     * @brief 获取请求方法(任意 token，如 GET / POST / PUT)
      */
-    std::string method() const;
+    std::string_view method() const;
 
     /**
      * @brief 获取 HTTP 版本(HTTP/1.1)
      */
-    std::string version() const;
+    std::string_view version() const;
+
+    /**
+     * @brief 获取查询串('?' 之后的部分，不含 '?')
+     */
+    std::string_view query() const;
+
+    /**
+     * @brief 按名字(不区分大小写)查找请求头；已知头经完美哈希转成 id 后 O(1) 查找
+     * @return 头部值(已去掉首尾空白)；不存在返回空
+     */
+    std::string_view GetHeader(std::string_view name) const;
+
+    /**
+     * @brief 按 id 查找已知请求头(同名头出现多次时返回第一个)
+     */
+    std::string_view GetHeader(HttpTables::HeaderId id) const
+    {
+        return known_[id] ? View_(headers_[known_[id] - 1].value) : std::string_view();
+    }
 
     /**
      * @brief 获取表单中 key 对应的值(仅适用于 POST)
@@ -86,10 +157,16 @@ public:
     std::string GetPost(const std::string &key) const;
 
     /**
-     * @brief 是否为长连接
+     * @brief 是否为长连接(HTTP/1.1 默认是，Connection: close 除外；HTTP/1.0 需要 keep-alive)
      */
     bool IsKeepAlive() const;
 
+    /**
+     * @brief 是否为合法的 h2c 升级请求(RFC 7540 3.2)：HTTP/1.1、没有请求体，
+     *        Upgrade 含 h2c，Connection 含 Upgrade 与 HTTP2-Settings，且带 HTTP2-Settings 头
+     */
+    bool IsH2cUpgrade() const;
+
     /**
      * @brief 静态函数，用于模拟用户验证或登录
      * @param name 用户名
@@ -99,21 +176,81 @@ public:
      */
     static bool UserVerify(const std::string &name, const std::string &pwd, bool isLogin);
 
+    // 请求体(解码后)的最大字节数，由配置 http.maxBodyBytes 设置
+    static size_t maxBodyBytes;
+    // 上传：接收路径、落盘目录(为空时不接收上传)、单个请求的字节配额
+    static std::string uploadPath;
+    static std::string uploadDir;
+    static size_t maxUploadBytes;
+
 private:
+    // 请求中一段数据在缓冲中的位置(相对请求起点)
+    struct Span
+    {
+        uint32_t off;
+        uint32_t len;
+    };
+
+    struct HeaderField
+    {
+        Span name;
+        Span value;
+        HttpTables::HeaderId id;
+    };
+
+    // 请求行 + 请求头的最大字节数，超过视为非法请求
+    static const size_t MAX_HEADER_BYTES = 16 * 1024;
+    // 最多记录的请求头个数
+    static const int MAX_HEADERS = 64;
+    // 分块长度行 / trailer 行的最大字节数
+    static const size_t MAX_CHUNK_LINE = 1024;
+
+    std::string_view View_(Span span) const { return std::string_view(base_ + span.off, span.len); }
+
     /**
      * @brief 解析请求行: GET /index.html HTTP/1.1
      */
-    bool ParseRequestLine_(const std::string &line);
+    bool ParseRequestLine_(const char *begin, const char *end);
+
+    /**
+     * @brief 解析一行请求头："Name: value"
+     */
+    bool ParseHeader_(const char *begin, const char *end);
 
     /**
-     * @brief 解析请求头
+     * @brief 请求头结束：确定是否有请求体及其长度
      */
-    void ParseHeader_(const std::string &line);
+    HTTP_CODE OnHeadersComplete_(size_t headerEnd);
 
     /**
-     * @brief 解析请求体
+     * @brief 解析分块长度行："1a2b;ext=1"(忽略扩展)
      */
-    void ParseBody_(const std::string &line);
+    HTTP_CODE ParseChunkSize_(const char *begin, const char *end);
+
+    /**
+     * @brief 解析循环，offset 均相对 data_
+     */
+    HTTP_CODE Parse_(size_t total);
+
+    /**
+     * @brief 收到一段(解码后的)请求体：上传交给 multipart 解析器，POST 表单拷贝
+     */
+    HTTP_CODE OnBodyData_(const char *data, size_t len);
+
+    /**
+     * @brief 当前请求体的字节上限
+     */
+    size_t BodyLimit_() const { return streaming_ ? maxUploadBytes : maxBodyBytes; }
+
+    /**
+     * @brief 请求完整后的收尾：长连接标志、POST 表单
+     */
+    void OnFinish_();
+
+    /**
+     * @brief 逗号分隔的列表(如 Connection 头)中是否包含某个选项，不区分大小写
+     */
+    static bool HasToken_(std::string_view list, std::string_view token);
 
     /**
      * @brief 补充解析：当 method_ == POST 时，解析表单数据
@@ -121,9 +258,11 @@ private:
     void ParsePost_();
 
     /**
-     * @brief 解析路径(可能需要默认添加index.html等)
+     * @brief 解析路径：去掉查询串，absolute-form 去掉 scheme 与 authority，再规范化
+     *        (路径到资源的映射由 Router 决定)
+     * @return false 表示请求目标非法(400)
      */
-    void ParsePath_();
+    bool ParsePath_();
 
     /**
      * @brief 解析 URL 中的 %xx 转义字符
@@ -137,20 +276,35 @@ private:
 
 private:
     PARSE_STATE state_;   // 状态机当前所处阶段
-    std::string method_;  // 请求方法
-    std::string path_;    // 请求目标路径
-    std::string version_; // HTTP版本
-    std::string body_;    // 请求体(POST 数据)
+    const char *base_;    // 方法 / 请求头等 Span 的基址：本次 parse 时请求在缓冲中的起点，上传时为 headerCopy_
+    const char *data_;    // 本次 parse 时缓冲的起点(缓冲可能扩容搬移，只保存偏移)
+    size_t lineOff_;      // 当前行的起点
+    size_t scanOff_;      // 当前行已扫描到的位置，数据不完整时从这里继续找行尾
+    size_t bodyOff_;      // 请求体起点
+    size_t contentLength_; // 请求体长度(分块编码时为已解码的长度)
+    size_t remain_;       // 当前分块(上传时为整个 Content-Length 请求体)还未收到的字节数
+    size_t length_;       // 完整请求的长度
+    bool chunked_;        // Transfer-Encoding: chunked
+    bool expectContinue_; // 待发送 100 Continue
+    bool streaming_;      // 流式上传
+    std::string headerCopy_; // 上传时请求行 + 请求头的拷贝
+    MultipartParser upload_;
+
+    Span method_;  // 请求方法
+    Span target_;  // 请求目标(含查询串)
+    Span query_;   // 查询串
+    Span version_; // HTTP版本
+    std::string path_; // 规范化后的请求路径(不含查询串，容量在多次请求间复用)
+    std::string body_; // 请求体(仅 POST 表单时拷贝)
+    bool keepAlive_;   // 请求完整时确定
 
-    // 请求头字段集合
-    std::unordered_map<std::string, std::string> header_;
+    // 请求头字段(定长数组，不分配堆内存)
+    HeaderField headers_[MAX_HEADERS];
+    int headerCount_;
+    // 已知请求头 id -> 第一次出现的下标 + 1，0 表示没有
+    uint8_t known_[HttpTables::HEADER_ID_COUNT];
     // POST表单解析后存放的键值对
     std::unordered_map<std::string, std::string> post_;
-
-    // 一些默认资源名配置(示例)
-    static const std::unordered_set<std::string> DEFAULT_HTML;
-    // 和一些资源对应的标识(示例)
-    static const std::unordered_map<std::string, int> DEFAULT_HTML_TAG;
 };
 
 #endif // HTTP_REQUEST_H
@@ -1,30 +1,34 @@
 #include "HttpResponse.h"
+#include "Precompressor.h"
+#include "HttpTables.h"
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
+#include <ctime>
 #include <iostream>
-
-// 不同文件后缀 -> MIME 类型
-const std::unordered_map<std::string, std::string> HttpResponse::SUFFIX_TYPE = {
-    {".html", "text/html"},
-    {".xml", "text/xml"},
-    {".xhtml", "application/xhtml+xml"},
-    {".txt", "text/plain"},
-    {".rtf", "application/rtf"},
-    {".pdf", "application/pdf"},
-    {".word", "application/msword"},
-    {".png", "image/png"},
-    {".gif", "image/gif"},
-    {".jpg", "image/jpeg"},
-    {".jpeg", "image/jpeg"},
-    {".css", "text/css"},
-    {".js", "text/javascript"}};
+#include <random>
+#include <strings.h> // strncasecmp
+#include <unistd.h>  // pread
 
 // 状态码 -> 状态描述
 const std::unordered_map<int, std::string> HttpResponse::CODE_STATUS = {
     {200, "OK"},
+    {201, "Created"},
+    {206, "Partial Content"},
+    {301, "Moved Permanently"},
+    {302, "Found"},
+    {303, "See Other"},
+    {304, "Not Modified"},
+    {307, "Temporary Redirect"},
+    {308, "Permanent Redirect"},
     {400, "Bad Request"},
     {403, "Forbidden"},
     {404, "Not Found"},
+    {405, "Method Not Allowed"},
+    {413, "Content Too Large"},
+    {416, "Range Not Satisfiable"},
     {500, "Internal Server Error"}};
 
 // 部分错误码 -> 错误页面路径(相对 srcDir_)
@@ -32,92 +36,744 @@ const std::unordered_map<int, std::string> HttpResponse::CODE_PATH = {
     {400, "/400.html"},
     {403, "/403.html"},
     {404, "/404.html"},
+    {405, "/405.html"},
+    {413, "/413.html"},
     {500, "/500.html"}};
 
+size_t HttpResponse::inlineMaxBytes = 4096;
+
 HttpResponse::HttpResponse()
     : code_(-1),
       isKeepAlive_(false),
+      keepAliveTimeout_(120),
+      keepAliveMax_(6),
       path_(""),
       srcDir_(""),
-      mmFile_(nullptr)
+      hasContent_(false),
+      headOnly_(false),
+      vary_(false),
+      liveGzip_(false),
+      rangeCnt_(0),
+      file_(nullptr),
+      pieceCnt_(0),
+      textMark_(0)
 {
+    etag_[0] = '\0';
+    lastModified_[0] = '\0';
     memset(&mmFileStat_, 0, sizeof(mmFileStat_));
 }
 
 HttpResponse::~HttpResponse()
 {
-    UnmapFile();
+    ReleaseFile();
 }
 
 void HttpResponse::Init(const std::string &srcDir, const std::string &path, bool isKeepAlive, int code)
 {
-    // 如果之前已映射过文件，先释放
-    if (mmFile_)
-    {
-        UnmapFile();
-    }
+    // 如果之前还持有文件引用，先释放
+    ReleaseFile();
     srcDir_ = srcDir;
     path_ = path;
     isKeepAlive_ = isKeepAlive;
     code_ = code;
+    hasContent_ = false;
+    content_.clear();
+    location_.clear();
+    allow_ = "GET, HEAD, POST";
+    headOnly_ = false;
+    ifNoneMatch_ = std::string_view();
+    ifModifiedSince_ = std::string_view();
+    etag_[0] = '\0';
+    lastModified_[0] = '\0';
+    acceptEncoding_ = std::string_view();
+    encoding_ = std::string_view();
+    vary_ = false;
+    liveGzip_ = false;
+    range_ = std::string_view();
+    ifRange_ = std::string_view();
 
-    // 重置文件映射信息
-    mmFile_ = nullptr;
+    // 重置文件信息
     memset(&mmFileStat_, 0, sizeof(mmFileStat_));
 }
 
+void HttpResponse::SetKeepAlive(int timeoutSec, int maxRequests)
+{
+    keepAliveTimeout_ = timeoutSec;
+    keepAliveMax_ = maxRequests;
+}
+
+void HttpResponse::SetContent(int code, std::string body, const std::string &type)
+{
+    code_ = code;
+    hasContent_ = true;
+    content_ = std::move(body);
+    contentType_ = type;
+}
+
+void HttpResponse::SetFile(int code, const std::string &path)
+{
+    code_ = code;
+    path_ = path;
+}
+
+void HttpResponse::SetRedirect(int code, const std::string &location)
+{
+    SetContent(code, std::string(), "text/html");
+    location_ = location;
+}
+
+void HttpResponse::SetAllow(std::string allow)
+{
+    allow_ = std::move(allow);
+}
+
+void HttpResponse::SetConditional(bool headOnly, std::string_view ifNoneMatch, std::string_view ifModifiedSince)
+{
+    headOnly_ = headOnly;
+    ifNoneMatch_ = ifNoneMatch;
+    ifModifiedSince_ = ifModifiedSince;
+}
+
+void HttpResponse::SetAcceptEncoding(std::string_view acceptEncoding)
+{
+    acceptEncoding_ = acceptEncoding;
+}
+
+void HttpResponse::SetRange(std::string_view range, std::string_view ifRange)
+{
+    range_ = range;
+    ifRange_ = ifRange;
+}
+
 void HttpResponse::MakeResponse(Buffer &buff)
 {
-    // 1. 检测文件状态
-    if (stat((srcDir_ + path_).data(), &mmFileStat_) < 0 || S_ISDIR(mmFileStat_.st_mode))
-    {
-        // 文件不存在 或者 path 指向目录
-        code_ = 404;
-    }
-    else if (!(mmFileStat_.st_mode & S_IROTH))
+    ReleaseFile();
+    textMark_ = buff.ReadableBytes();
+    BuildResponse_(buff);
+    FlushText_(buff);
+    // 各段已各自 Pin 住文件
+    UnpinFile_();
+}
+
+void HttpResponse::BuildResponse_(Buffer &buff)
+{
+    // 内存正文直接跟在响应头后面
+    if (hasContent_)
     {
-        // 文件不可读 => 403
-        code_ = 403;
+        // 处理函数的输出等：可压缩时实时压缩(不缓存)
+        vary_ = HttpTables::CompressibleType(contentType_) && Compressor::Worth(content_.size());
+        std::string gz;
+        if (vary_ && AcceptsGzip_() && compressor_.Deflate(content_.data(), content_.size(), gz))
+        {
+            content_.swap(gz);
+            encoding_ = "gzip";
+        }
+        AddStateLine_(buff);
+        AddHeader_(buff);
+        buff.Append("Content-Length: " + std::to_string(content_.size()) + "\r\n\r\n");
+        buff.Append(content_);
+        return;
     }
-    else if (code_ == -1)
+
+    // 1. 检测文件状态(调用方已指定错误码时不再检查请求的文件)；stat 信息来自 FileCache，命中时没有系统调用
+    if (code_ < 400)
     {
-        // 如果用户未指定 code, 默认 200
-        code_ = 200;
+        int err = AcquireFile_();
+        if (err == EACCES || err == EPERM)
+        {
+            code_ = 403;
+        }
+        else if (err == ENOMEM || err == EMFILE || err == ENFILE)
+        {
+            // fd / 内存耗尽
+            code_ = 500;
+        }
+        else if (err)
+        {
+            // 文件不存在 或者 path 指向目录
+            code_ = 404;
+        }
+        else if (!(mmFileStat_.st_mode & S_IROTH))
+        {
+            // 文件不可读 => 403
+            code_ = 403;
+        }
+        else if (code_ == -1)
+        {
+            // 如果用户未指定 code, 默认 200
+            code_ = 200;
+        }
+
+        // 校验器只由 stat 结果生成；客户端缓存仍有效时回 304，不打开文件
+        if (code_ == 200)
+        {
+            MakeValidators_();
+            ChooseEncoding_();
+            if (NotModified_())
+            {
+                code_ = 304;
+            }
+            // Range 只作用于 GET 的 200；If-Range 不匹配时返回完整文件
+            else if (!headOnly_ && !range_.empty() && IfRangeMatches_())
+            {
+                int n = ParseRange_();
+                if (n == 0)
+                {
+                    code_ = 416;
+                }
+                else if (n > 0)
+                {
+                    code_ = 206;
+                }
+            }
+        }
+        // 没有可用的旁路文件：发送前实时压缩(304 没有正文，不压缩)；失败时改回原文件
+        if (code_ == 200 && liveGzip_ && !CompressFile_())
+        {
+            encoding_ = std::string_view();
+            MakeValidators_();
+        }
     }
 
     // 2. 如果是错误码(如404), 替换成对应的错误页面
     if (CODE_PATH.count(code_))
     {
         path_ = CODE_PATH.find(code_)->second;
-        // 再次 stat
-        stat((srcDir_ + path_).data(), &mmFileStat_);
+        UnpinFile_();
+        AcquireFile_();
+        // 错误页面也是静态文件：实时压缩，结果按文件版本缓存
+        vary_ = file_ && HttpTables::Compressible(HttpTables::MimeOfPath(path_)) && Compressor::Worth(file_->Size());
+        if (vary_ && AcceptsGzip_())
+        {
+            CompressFile_();
+        }
     }
 
     // 3. 写响应行
     AddStateLine_(buff);
     // 4. 写响应头
     AddHeader_(buff);
-    // 5. 写正文(可能是 mmap 文件，也可能是简易错误内容)
+    if (code_ == 304)
+    {
+        buff.Append("\r\n"); // 304 没有正文
+        return;
+    }
+    if (code_ == 416)
+    {
+        // 416 用 Content-Range 告诉客户端当前的文件大小
+        buff.Append("Content-Range: bytes */" + std::to_string(mmFileStat_.st_size) +
+                    "\r\nContent-Length: 0\r\n\r\n");
+        return;
+    }
+    if (code_ == 206)
+    {
+        AddRangeContent_(buff);
+        return;
+    }
+    // 5. 写正文(可能是缓存的文件，也可能是简易错误内容)
     AddContent_(buff);
 }
 
-void HttpResponse::UnmapFile()
+namespace
+{
+    const char *const WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    const char *const MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    // 去掉两端的空格 / 制表符
+    std::string_view TrimOws(std::string_view s)
+    {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+            s.remove_suffix(1);
+        return s;
+    }
+
+    /**
+     * @brief 解析 IMF-fixdate："Sun, 06 Nov 1994 08:49:37 GMT"；失败返回 -1
+     *        (RFC 9110 要求接收方也兼容两种旧格式，浏览器只发送 IMF-fixdate，这里不支持旧格式)
+     */
+    time_t ParseHttpDate(std::string_view date)
+    {
+        if (date.size() != 29 || date.substr(25) != " GMT")
+        {
+            return -1;
+        }
+        char buf[30];
+        memcpy(buf, date.data(), 29);
+        buf[29] = '\0';
+        char mon[4] = {0};
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        if (sscanf(buf + 5, "%2d %3s %4d %2d:%2d:%2d", &tm.tm_mday, mon, &tm.tm_year,
+                   &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+        {
+            return -1;
+        }
+        tm.tm_mon = -1;
+        for (int i = 0; i < 12; i++)
+        {
+            if (strcmp(mon, MONTHS[i]) == 0)
+                tm.tm_mon = i;
+        }
+        if (tm.tm_mon < 0)
+        {
+            return -1;
+        }
+        tm.tm_year -= 1900;
+        return timegm(&tm);
+    }
+
+    /**
+     * @brief 解析非空的十进制数，溢出返回 false
+     */
+    bool ParseSize(std::string_view digits, size_t &value)
+    {
+        if (digits.empty())
+        {
+            return false;
+        }
+        value = 0;
+        for (char ch : digits)
+        {
+            if (ch < '0' || ch > '9' || value > (SIZE_MAX - 9) / 10)
+                return false;
+            value = value * 10 + (ch - '0');
+        }
+        return true;
+    }
+
+    /**
+     * @brief multipart/byteranges 的分隔符：进程启动时随机生成一次
+     */
+    const std::string &RangeBoundary()
+    {
+        static const std::string boundary = []
+        {
+            std::random_device rd;
+            char buf[24];
+            snprintf(buf, sizeof(buf), "%08x%08x", rd(), rd());
+            return std::string(buf);
+        }();
+        return boundary;
+    }
+}
+
+void HttpResponse::MakeValidators_()
+{
+    // 强 ETag：同一 inode 上大小与纳秒级修改时间都不变，内容即不变
+    unsigned long long mtimeNs = static_cast<unsigned long long>(mmFileStat_.st_mtim.tv_sec) * 1000000000ULL +
+                                 static_cast<unsigned long long>(mmFileStat_.st_mtim.tv_nsec);
+    snprintf(etag_, sizeof(etag_), "\"%llx-%llx-%llx\"",
+             static_cast<unsigned long long>(mmFileStat_.st_ino),
+             static_cast<unsigned long long>(mmFileStat_.st_size), mtimeNs);
+
+    struct tm tm;
+    gmtime_r(&mmFileStat_.st_mtime, &tm);
+    snprintf(lastModified_, sizeof(lastModified_), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+             WEEKDAYS[tm.tm_wday], tm.tm_mday, MONTHS[tm.tm_mon], tm.tm_year + 1900,
+             tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+void HttpResponse::ChooseEncoding_()
 {
-    if (mmFile_)
+    vary_ = HttpTables::Compressible(HttpTables::MimeOfPath(path_));
+    if (!vary_ || !range_.empty() || acceptEncoding_.empty())
+    {
+        return;
+    }
+    int q[Precompressor::ENCODING_COUNT];
+    for (int i = 0; i < Precompressor::ENCODING_COUNT; i++)
+    {
+        q[i] = AcceptQ_(Precompressor::ENCODINGS[i].token);
+    }
+    // 按 q 值从高到低尝试(相同时按服务端的优先级)，旁路文件不存在或比原文件旧时换下一个
+    for (int tried = 0; tried < Precompressor::ENCODING_COUNT; tried++)
     {
-        munmap(mmFile_, mmFileStat_.st_size);
-        mmFile_ = nullptr;
+        int best = -1;
+        for (int i = 0; i < Precompressor::ENCODING_COUNT; i++)
+        {
+            if (q[i] > 0 && (best < 0 || q[i] > q[best]))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        q[best] = 0;
+        const Precompressor::Encoding &encoding = Precompressor::ENCODINGS[best];
+        const CachedFile *side = FileCache::Instance().Acquire(srcDir_ + path_ + std::string(encoding.suffix), true);
+        if (!side)
+        {
+            continue;
+        }
+        const struct timespec &srcTime = mmFileStat_.st_mtim;
+        const struct timespec &sideTime = side->st.st_mtim;
+        if (sideTime.tv_sec < srcTime.tv_sec || (sideTime.tv_sec == srcTime.tv_sec && sideTime.tv_nsec < srcTime.tv_nsec))
+        {
+            FileCache::Unpin(side);
+            continue;
+        }
+        // "ino-size-mtime" => "ino-size-mtime-gz"：不同表示的强校验器不能相同
+        size_t len = strlen(etag_);
+        snprintf(etag_ + len - 1, sizeof(etag_) - len + 1, "-%.*s\"",
+                 static_cast<int>(encoding.suffix.size() - 1), encoding.suffix.data() + 1);
+        // 只换正文的来源与长度，Last-Modified / If-Modified-Since 仍按原文件
+        UnpinFile_();
+        file_ = side;
+        mmFileStat_.st_size = side->st.st_size;
+        encoding_ = encoding.token;
+        return;
     }
+
+    // 没有可用的旁路文件：接受 gzip 时实时压缩；压缩级别会变，输出不能逐字节保证相同，用弱 ETag
+    if (AcceptsGzip_() && Compressor::Worth(mmFileStat_.st_size))
+    {
+        char weak[sizeof(etag_)];
+        size_t len = strlen(etag_);
+        snprintf(weak, sizeof(weak), "W/%.*s-gz\"", static_cast<int>(len - 1), etag_);
+        memcpy(etag_, weak, sizeof(etag_));
+        liveGzip_ = true;
+        encoding_ = "gzip";
+    }
+}
+
+bool HttpResponse::AcceptsGzip_() const
+{
+    return Compressor::Enabled() && AcceptQ_("gzip") > 0;
+}
+
+bool HttpResponse::CompressFile_()
+{
+    // 键：文件路径 + 版本(ino-size-mtime)，文件修改后自然不再命中旧结果
+    char version[64];
+    unsigned long long mtimeNs = static_cast<unsigned long long>(file_->st.st_mtim.tv_sec) * 1000000000ULL +
+                                 static_cast<unsigned long long>(file_->st.st_mtim.tv_nsec);
+    snprintf(version, sizeof(version), "\n%llx-%llx-%llx", static_cast<unsigned long long>(file_->st.st_ino),
+             static_cast<unsigned long long>(file_->st.st_size), mtimeNs);
+    const CachedFile *gz = compressor_.DeflateFile(file_, srcDir_ + path_ + version);
+    if (!gz)
+    {
+        return false;
+    }
+    UnpinFile_();
+    file_ = gz;
+    mmFileStat_.st_size = gz->st.st_size;
+    encoding_ = "gzip";
+    return true;
 }
 
-char *HttpResponse::File()
+int HttpResponse::AcceptQ_(std::string_view coding) const
 {
-    return mmFile_;
+    int any = -1;
+    std::string_view rest = acceptEncoding_;
+    while (!rest.empty())
+    {
+        size_t comma = rest.find(',');
+        std::string_view item = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        size_t semi = item.find(';');
+        std::string_view name = TrimOws(item.substr(0, semi));
+        int q = 1000;
+        while (semi != std::string_view::npos)
+        {
+            item = item.substr(semi + 1);
+            semi = item.find(';');
+            std::string_view param = TrimOws(item.substr(0, semi));
+            if (param.size() < 3 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=')
+            {
+                continue;
+            }
+            // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+            q = (param[2] - '0') * 1000;
+            int scale = 100;
+            for (size_t i = 4; i < param.size() && i < 7 && param[3] == '.'; i++, scale /= 10)
+            {
+                q += (param[i] - '0') * scale;
+            }
+            if (q < 0 || q > 1000)
+            {
+                q = 0;
+            }
+        }
+        if (name.size() == coding.size() && strncasecmp(name.data(), coding.data(), name.size()) == 0)
+        {
+            return q;
+        }
+        if (name == "*")
+        {
+            any = q;
+        }
+    }
+    return any;
 }
 
-size_t HttpResponse::FileLen() const
+bool HttpResponse::NotModified_() const
 {
-    return mmFileStat_.st_size;
+    // 有 If-None-Match 时忽略 If-Modified-Since
+    if (!ifNoneMatch_.empty())
+    {
+        return EtagMatches_(ifNoneMatch_);
+    }
+    if (!ifModifiedSince_.empty())
+    {
+        time_t since = ParseHttpDate(ifModifiedSince_);
+        return since >= 0 && mmFileStat_.st_mtime <= since;
+    }
+    return false;
+}
+
+bool HttpResponse::EtagMatches_(std::string_view list) const
+{
+    if (list == "*")
+    {
+        return true;
+    }
+    std::string_view etag(etag_);
+    if (etag.substr(0, 2) == "W/")
+    {
+        etag.remove_prefix(2); // 实时压缩的响应使用弱 ETag
+    }
+    // 逗号分隔的 entity-tag 列表；If-None-Match 使用弱比较，去掉 W/ 前缀
+    while (!list.empty())
+    {
+        size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+            item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+            item.remove_suffix(1);
+        if (item.substr(0, 2) == "W/")
+            item.remove_prefix(2);
+        if (item == etag)
+        {
+            return true;
+        }
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool HttpResponse::IfRangeMatches_() const
+{
+    if (ifRange_.empty())
+    {
+        return true;
+    }
+    // entity-tag 要求强比较：弱 ETag 永远不匹配
+    if (ifRange_.front() == '"' || ifRange_.substr(0, 2) == "W/")
+    {
+        return ifRange_ == std::string_view(etag_);
+    }
+    return ifRange_ == std::string_view(lastModified_);
+}
+
+int HttpResponse::ParseRange_()
+{
+    static const char UNIT[] = "bytes=";
+    const size_t unitLen = sizeof(UNIT) - 1;
+    if (range_.size() < unitLen || strncasecmp(range_.data(), UNIT, unitLen) != 0)
+    {
+        return -1; // 不认识的单位
+    }
+    std::string_view list = range_.substr(unitLen);
+    const size_t size = mmFileStat_.st_size;
+    int items = 0;
+    rangeCnt_ = 0;
+    while (true)
+    {
+        size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+            item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+            item.remove_suffix(1);
+
+        // 列表允许空元素
+        if (!item.empty())
+        {
+            if (++items > MAX_RANGES)
+            {
+                return -1;
+            }
+            size_t dash = item.find('-');
+            if (dash == std::string_view::npos)
+            {
+                return -1;
+            }
+            size_t first = 0;
+            size_t last = 0;
+            if (dash == 0)
+            {
+                // "-n"：最后 n 个字节
+                size_t suffix;
+                if (!ParseSize(item.substr(1), suffix))
+                    return -1;
+                if (suffix > 0 && size > 0)
+                {
+                    first = suffix < size ? size - suffix : 0;
+                    ranges_[rangeCnt_++] = {first, size - 1};
+                }
+            }
+            else
+            {
+                // "a-b" 或 "a-"
+                if (!ParseSize(item.substr(0, dash), first))
+                    return -1;
+                std::string_view lastDigits = item.substr(dash + 1);
+                last = size - 1;
+                if (!lastDigits.empty())
+                {
+                    if (!ParseSize(lastDigits, last) || last < first)
+                        return -1;
+                    last = std::min(last, size - 1);
+                }
+                if (first < size)
+                {
+                    ranges_[rangeCnt_++] = {first, last};
+                }
+            }
+        }
+
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return items > 0 ? rangeCnt_ : -1;
+}
+
+void HttpResponse::AddRangeContent_(Buffer &buff)
+{
+    const size_t size = mmFileStat_.st_size;
+    if (rangeCnt_ == 1)
+    {
+        ByteRange &r = ranges_[0];
+        size_t len = r.last - r.first + 1;
+        buff.Append("Content-Range: bytes " + std::to_string(r.first) + "-" + std::to_string(r.last) + "/" +
+                    std::to_string(size) + "\r\nContent-Length: " + std::to_string(len) + "\r\n\r\n");
+        AddFile_(buff, r.first, len);
+        return;
+    }
+
+    // 每个区间：--B\r\n 部分头 \r\n 数据 \r\n，最后 --B--\r\n；先算出总长度写进 Content-Length
+    const std::string &boundary = RangeBoundary();
+    std::string_view type = HttpTables::MimeOfPath(path_).type;
+    std::string partHeaders[MAX_RANGES];
+    size_t total = 0;
+    for (int i = 0; i < rangeCnt_; i++)
+    {
+        const ByteRange &r = ranges_[i];
+        std::string &h = partHeaders[i];
+        h = "--" + boundary + "\r\nContent-Type: ";
+        h.append(type.data(), type.size());
+        h += "\r\nContent-Range: bytes " + std::to_string(r.first) + "-" + std::to_string(r.last) + "/" +
+             std::to_string(size) + "\r\n\r\n";
+        total += h.size() + (r.last - r.first + 1) + 2;
+    }
+    std::string closing = "--" + boundary + "--\r\n";
+    total += closing.size();
+
+    buff.Append("Content-Length: " + std::to_string(total) + "\r\n\r\n");
+    for (int i = 0; i < rangeCnt_; i++)
+    {
+        ByteRange &r = ranges_[i];
+        buff.Append(partHeaders[i]);
+        AddFile_(buff, r.first, r.last - r.first + 1);
+        buff.Append("\r\n");
+    }
+    buff.Append(closing);
+}
+
+void HttpResponse::FlushText_(Buffer &buff)
+{
+    size_t end = buff.ReadableBytes();
+    if (end > textMark_)
+    {
+        pieces_[pieceCnt_++] = {nullptr, 0, end - textMark_};
+        textMark_ = end;
+    }
+}
+
+void HttpResponse::AddFile_(Buffer &buff, size_t off, size_t len)
+{
+    // 很小的正文直接拷进 buff，与响应头一次发出
+    if (len <= inlineMaxBytes)
+    {
+        if (file_->InMemory())
+        {
+            buff.Append(file_->Data(off), len);
+            return;
+        }
+        char tmp[4096];
+        size_t done = 0;
+        while (done < len)
+        {
+            ssize_t n = pread(file_->fd, tmp, std::min(len - done, sizeof(tmp)), off + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            buff.Append(tmp, n);
+            done += n;
+        }
+        if (done == len)
+        {
+            return;
+        }
+        // 读取失败(文件被截断等)：已拷贝的部分保留，剩余部分交给 sendfile，发送时报错并关闭连接
+        off += done;
+        len -= done;
+    }
+    // 否则作为文件段：内容缓存中的副本用 writev 发送，其余用 sendfile 从 fd 发送
+    FlushText_(buff);
+    FileCache::Pin(file_);
+    pieces_[pieceCnt_++] = {file_, off, len};
+}
+
+int HttpResponse::AcquireFile_()
+{
+    file_ = FileCache::Instance().Acquire(srcDir_ + path_);
+    if (!file_)
+    {
+        memset(&mmFileStat_, 0, sizeof(mmFileStat_));
+        return errno;
+    }
+    mmFileStat_ = file_->st;
+    return 0;
+}
+
+void HttpResponse::UnpinFile_()
+{
+    if (file_)
+    {
+        FileCache::Unpin(file_);
+        file_ = nullptr;
+    }
+}
+
+void HttpResponse::ReleaseFile()
+{
+    for (int i = 0; i < pieceCnt_; i++)
+    {
+        if (pieces_[i].file)
+        {
+            FileCache::Unpin(pieces_[i].file);
+        }
+    }
+    pieceCnt_ = 0;
+    rangeCnt_ = 0;
+    UnpinFile_();
+}
+
+void HttpResponse::ReleasePieces()
+{
+    pieceCnt_ = 0;
 }
 
 void HttpResponse::ErrorContent(Buffer &buff, const std::string &message)
@@ -130,9 +786,19 @@ void HttpResponse::ErrorContent(Buffer &buff, const std::string &message)
     body += "<p>" + message + "</p>";
     body += "<hr><em>My WebServer</em></body></html>";
 
-    // 写响应行 + 头 + 错误页正文
+    // 写响应行 + 头 + 错误页正文(足够长时同样实时压缩)
     buff.Append("HTTP/1.1 " + std::to_string(code_) + " " + CODE_STATUS.find(code_)->second + "\r\n");
     buff.Append("Content-type: text/html\r\n");
+    std::string gz;
+    if (Compressor::Worth(body.size()))
+    {
+        buff.Append("Vary: Accept-Encoding\r\n");
+        if (AcceptsGzip_() && compressor_.Deflate(body.data(), body.size(), gz))
+        {
+            body.swap(gz);
+            buff.Append("Content-Encoding: gzip\r\n");
+        }
+    }
     buff.Append("Content-length: " + std::to_string(body.size()) + "\r\n");
     buff.Append("Connection: close\r\n\r\n");
     buff.Append(body);
@@ -161,60 +827,95 @@ void HttpResponse::AddHeader_(Buffer &buff)
     if (isKeepAlive_)
     {
         buff.Append("keep-alive\r\n");
-        // 可根据需要追加更多 keep-alive 信息
-        buff.Append("keep-alive: max=6, timeout=120\r\n");
+        // 与 SubReactor 实际执行的空闲超时 / 最大请求数保持一致
+        buff.Append("Keep-Alive: timeout=" + std::to_string(keepAliveTimeout_) +
+                    ", max=" + std::to_string(keepAliveMax_) + "\r\n");
     }
     else
     {
         buff.Append("close\r\n");
     }
 
-    // Content-Type: ...
-    buff.Append("Content-Type: " + GetFileType_() + "\r\n");
+    // 405 需要告诉客户端支持哪些方法
+    if (code_ == 405)
+    {
+        buff.Append("Allow: " + allow_ + "\r\n");
+    }
+    if (!location_.empty())
+    {
+        buff.Append("Location: " + location_ + "\r\n");
+    }
+
+    // 200 / 304 带上校验器，供浏览器下次发条件请求
+    if (etag_[0])
+    {
+        buff.Append("ETag: ");
+        buff.Append(etag_, strlen(etag_));
+        buff.Append("\r\nLast-Modified: ");
+        buff.Append(lastModified_, strlen(lastModified_));
+        buff.Append("\r\n");
+    }
+    // 可压缩的文件按 Accept-Encoding 选择表示，缓存需要区分
+    if (vary_)
+    {
+        buff.Append("Vary: Accept-Encoding\r\n");
+    }
+    if (!encoding_.empty() && code_ != 304)
+    {
+        buff.Append("Content-Encoding: ");
+        buff.Append(encoding_.data(), encoding_.size());
+        buff.Append("\r\n");
+    }
+    // 静态文件支持按字节区间请求
+    if (!hasContent_ && (code_ == 200 || code_ == 206 || code_ == 416))
+    {
+        buff.Append("Accept-Ranges: bytes\r\n");
+    }
+    if (code_ == 304 || code_ == 416)
+    {
+        return; // 304 / 416 没有正文，不需要 Content-Type
+    }
+
+    // Content-Type: ...(静态文件直接使用表中拼好的头部行)
+    if (hasContent_)
+    {
+        buff.Append("Content-Type: " + contentType_ + "\r\n");
+    }
+    else if (code_ == 206 && rangeCnt_ > 1)
+    {
+        buff.Append("Content-Type: multipart/byteranges; boundary=" + RangeBoundary() + "\r\n");
+    }
+    else
+    {
+        std::string_view line = HttpTables::MimeOfPath(path_).header;
+        buff.Append(line.data(), line.size());
+    }
 }
 
 void HttpResponse::AddContent_(Buffer &buff)
 {
-    // 打开文件
-    int srcFd = open((srcDir_ + path_).data(), O_RDONLY);
-    if (srcFd < 0)
+    // HEAD：与 GET 相同的头部，不引用文件内容
+    if (headOnly_)
     {
-        // 如果无法打开文件，写入一个简单的错误提示
-        ErrorContent(buff, "File Not Found: " + path_);
+        buff.Append("Content-Length: " + std::to_string(mmFileStat_.st_size) + "\r\n\r\n");
         return;
     }
 
-    // 先写 Content-Length 行
-    buff.Append("Content-Length: " + std::to_string(mmFileStat_.st_size) + "\r\n\r\n");
-
-    // 使用 mmap
-    mmFile_ = static_cast<char *>(mmap(nullptr, mmFileStat_.st_size, PROT_READ, MAP_PRIVATE, srcFd, 0));
-    close(srcFd);
-
-    if (mmFile_ == MAP_FAILED)
+    if (!file_)
     {
-        mmFile_ = nullptr;
-        // 如果 mmap 失败，也写入错误提示
-        ErrorContent(buff, "File Mapping Failed: " + path_);
+        // 如果无法打开文件，写入一个简单的错误提示
+        ErrorContent(buff, "File Not Found: " + path_);
         return;
     }
 
-    // 正文部分(文件内容)不直接拷贝到 buff，而是在后续 writev 时一并发送
-    // 所以这里不做 buff.Append()，只写了头部 + \r\n\r\n
-}
-
-std::string HttpResponse::GetFileType_()
-{
-    // 根据文件后缀判断 MIME 类型
-    size_t idx = path_.find_last_of('.');
-    if (idx == std::string::npos)
-    {
-        return "text/plain";
-    }
-    std::string suffix = path_.substr(idx);
-    if (SUFFIX_TYPE.count(suffix))
+    // 先写 Content-Length 行
+    size_t fileLen = mmFileStat_.st_size;
+    buff.Append("Content-Length: " + std::to_string(fileLen) + "\r\n\r\n");
+    if (fileLen == 0)
     {
-        return SUFFIX_TYPE.find(suffix)->second;
+        return; // 空文件没有正文段
     }
-    return "text/plain";
+
+    // 正文按大小选择发送方式(见 AddFile_)
+    AddFile_(buff, 0, fileLen);
 }
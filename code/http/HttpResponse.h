@@ -2,24 +2,44 @@
 #define HTTP_RESPONSE_H
 
 #include <unordered_map>
-#include <fcntl.h>    // open
-#include <unistd.h>   // close
 #include <sys/stat.h> // stat
-#include <sys/mman.h> // mmap, munmap
 #include <string>
+#include <string_view>
 
 /**
  * 前置声明：你的 Buffer 类。请根据自己的项目路径做相应修改。
  */
 #include "../buffer/Buffer.h"
+#include "FileCache.h"
+#include "Compressor.h"
 
 /**
  * @brief HttpResponse：用于组装 HTTP 响应（状态行、头部、正文）。
- *        在正文部分，支持通过 mmap 映射静态文件。
+ *        正文部分按大小选择发送方式：很小的拷进响应头所在的缓冲，其余引用 FileCache 中共享的文件
+ *        (内存副本用 writev，否则用 sendfile)。
  */
 class HttpResponse
 {
 public:
+    // 一个 Range 请求最多包含的区间数，超过时忽略 Range、返回完整文件
+    static const int MAX_RANGES = 8;
+    // 一个响应最多由多少段组成：multipart/byteranges 为 [头][区间1][分隔][区间2]...[结尾]
+    static const int MAX_PIECES = 2 * MAX_RANGES + 1;
+
+    /**
+     * @brief 响应的一段：file 为空时表示 buff 中依次存放的 len 字节文本，
+     *        否则为缓存文件中 [off, off + len) 这一段，每段持有 file 的一个引用
+     */
+    struct Piece
+    {
+        const CachedFile *file; // 已 Pin 的文件
+        size_t off;             // 数据在文件中的偏移
+        size_t len;             // 数据长度
+    };
+
+    // 不超过它的文件正文直接拷进缓冲，与响应头一起发送，由配置 transfer.inlineMaxBytes 设置
+    static size_t inlineMaxBytes;
+
     HttpResponse();
     ~HttpResponse();
 
@@ -35,6 +55,55 @@ public:
               bool isKeepAlive = false,
               int code = -1);
 
+    /**
+     * @brief 设置长连接参数，写入响应头 Keep-Alive: timeout=..., max=...
+     * @param timeoutSec 空闲超时(秒)
+     * @param maxRequests 本连接剩余可处理的请求数
+     */
+    void SetKeepAlive(int timeoutSec, int maxRequests);
+
+    /**
+     * @brief 使用内存中的正文代替静态文件(如上传结果)
+     * @param code 状态码
+     * @param body 正文
+     * @param type Content-Type
+     */
+    void SetContent(int code, std::string body, const std::string &type);
+
+    /**
+     * @brief 改为发送 path 指向的文件(code 为错误码时发送对应的错误页面)
+     */
+    void SetFile(int code, const std::string &path);
+
+    /**
+     * @brief 重定向：只有响应头 Location，没有正文
+     */
+    void SetRedirect(int code, const std::string &location);
+
+    /**
+     * @brief 405 响应的 Allow 头，默认 "GET, HEAD, POST"
+     */
+    void SetAllow(std::string allow);
+
+    /**
+     * @brief GET / HEAD 的条件请求信息(string_view 指向请求，需在 MakeResponse 之前有效)
+     * @param headOnly        HEAD：只发送响应头，不引用文件内容
+     * @param ifNoneMatch     If-None-Match 请求头
+     * @param ifModifiedSince If-Modified-Since 请求头
+     */
+    void SetConditional(bool headOnly, std::string_view ifNoneMatch, std::string_view ifModifiedSince);
+
+    /**
+     * @brief Accept-Encoding 请求头(string_view 指向请求，需在 MakeResponse 之前有效)，
+     *        用于在原文件与预压缩的旁路文件(.br / .gz)之间选择
+     */
+    void SetAcceptEncoding(std::string_view acceptEncoding);
+
+    /**
+     * @brief GET 的 Range / If-Range 请求头(string_view 指向请求，需在 MakeResponse 之前有效)
+     */
+    void SetRange(std::string_view range, std::string_view ifRange);
+
     /**
      * @brief 根据当前设定的状态码、文件路径等信息，往 buff 写出完整的响应(行、头、正文)。
      * @param buff 传入的缓冲区，用于存放要发送的响应头部数据
@@ -42,19 +111,25 @@ public:
     void MakeResponse(Buffer &buff);
 
     /**
-     * @brief 释放 mmap 映射(若有)
+     * @brief 释放尚未交出的各段持有的文件引用
      */
-    void UnmapFile();
+    void ReleaseFile();
 
     /**
-     * @brief 返回已映射文件的首地址(用于 writev)
+     * @brief 最近一次 MakeResponse 生成的各段(用于 writev)，文本段按顺序对应 buff 中新追加的数据
      */
-    char *File();
+    const Piece *Pieces() const { return pieces_; }
+    int PieceCount() const { return pieceCnt_; }
 
     /**
-     * @brief 返回已映射文件的大小(用于 writev)
+     * @brief 交出各段文件引用的所有权(流水线中多个响应各自持有引用)，调用方负责 FileCache::Unpin
      */
-    size_t FileLen() const;
+    void ReleasePieces();
+
+    /**
+     * @brief 释放实时压缩的压缩流(连接关闭时调用)
+     */
+    void ReleaseCompressor() { compressor_.Release(); }
 
     /**
      * @brief 写入一段简易的 HTML 来描述错误信息
@@ -69,6 +144,11 @@ public:
     int Code() const { return code_; }
 
 private:
+    /**
+     * @brief 生成响应(MakeResponse 负责记录各段)
+     */
+    void BuildResponse_(Buffer &buff);
+
     /**
      * @brief 添加响应行，如"HTTP/1.1 200 OK\r\n"
      */
@@ -80,27 +160,128 @@ private:
     void AddHeader_(Buffer &buff);
 
     /**
-     * @brief 添加正文部分(若无错误码，就 mmap 文件；否则写错误页面)
+     * @brief 添加正文部分(引用缓存的文件；文件不可用时写简易错误页面)
      */
     void AddContent_(Buffer &buff);
 
     /**
-     * @brief 根据 path_ 的后缀来判断返回的Content-Type
+     * @brief 根据 stat 结果生成 ETag(inode-大小-修改时间)与 Last-Modified
+     */
+    void MakeValidators_();
+
+    /**
+     * @brief 可压缩的文件按 Accept-Encoding 选择最新的旁路文件：file_ 换成旁路文件，
+     *        ETag 加上编码后缀，Last-Modified 仍取原文件；没有可用的旁路文件时改为实时 gzip(弱 ETag)；
+     *        带 Range 的请求发送原文件
+     */
+    void ChooseEncoding_();
+
+    /**
+     * @brief 开启了实时压缩且 Accept-Encoding 接受 gzip
+     */
+    bool AcceptsGzip_() const;
+
+    /**
+     * @brief 实时压缩 file_(结果按文件版本缓存)，成功时 file_ 换成压缩后的内存条目
+     */
+    bool CompressFile_();
+
+    /**
+     * @brief Accept-Encoding 中 coding 的 q 值(千分之几)，未列出且没有 "*" 时为 -1
+     */
+    int AcceptQ_(std::string_view coding) const;
+
+    /**
+     * @brief 按 If-None-Match / If-Modified-Since 判断客户端缓存是否仍然有效(RFC 9110 13.2.2)
+     */
+    bool NotModified_() const;
+
+    /**
+     * @brief If-None-Match 列表中是否有与 etag_ 弱匹配的项
+     */
+    bool EtagMatches_(std::string_view list) const;
+
+    /**
+     * @brief If-Range 是否与当前文件一致(ETag 强比较，或与 Last-Modified 完全相同)
+     */
+    bool IfRangeMatches_() const;
+
+    /**
+     * @brief 解析 "bytes=a-b, c-, -n"，可满足的区间存入 ranges_
+     * @return -1 表示语法错误或区间过多(忽略 Range)，否则为可满足的区间数(0 => 416)
      */
-    std::string GetFileType_();
+    int ParseRange_();
+
+    /**
+     * @brief 206 的正文：单个区间直接发送；多个区间组成 multipart/byteranges
+     */
+    void AddRangeContent_(Buffer &buff);
+
+    /**
+     * @brief 追加 file_ 中 [off, off + len) 这一段：不超过 inlineMaxBytes 时拷进 buff，
+     *        否则把 buff 中尚未记录的文本作为一段，再追加一个文件段(Pin 一次)
+     */
+    void AddFile_(Buffer &buff, size_t off, size_t len);
+
+    /**
+     * @brief 从 FileCache 取得 srcDir_ + path_，失败时 file_ 为空、mmFileStat_ 清零
+     * @return 失败时的 errno，成功为 0
+     */
+    int AcquireFile_();
+    void UnpinFile_();
+
+    /**
+     * @brief 把 buff 中尚未记录的文本作为一段
+     */
+    void FlushText_(Buffer &buff);
 
 private:
     int code_;         // HTTP状态码，如 200,404 等
     bool isKeepAlive_; // 是否长连接
+    int keepAliveTimeout_; // Keep-Alive: timeout=
+    int keepAliveMax_;     // Keep-Alive: max=
 
     std::string path_;   // 请求的资源路径(如"/index.html")
     std::string srcDir_; // 资源根目录
 
-    char *mmFile_;           // mmap 映射文件的首地址
-    struct stat mmFileStat_; // mmap 文件的 stat 信息(大小/权限等)
+    bool hasContent_;         // 正文来自 content_ 而不是文件
+    std::string content_;     // 内存中的正文
+    std::string contentType_; // 内存正文的 Content-Type
+    std::string location_;    // 重定向的 Location
+    std::string allow_;       // 405 的 Allow
+
+    bool headOnly_;                    // HEAD 请求
+    std::string_view ifNoneMatch_;     // If-None-Match
+    std::string_view ifModifiedSince_; // If-Modified-Since
+    char etag_[64];                    // "ino-size-mtime"
+    std::string_view acceptEncoding_;  // Accept-Encoding
+    std::string_view encoding_;        // 选中的 Content-Encoding，为空表示原文件
+    bool vary_;                        // 可压缩的文件：响应随 Accept-Encoding 变化
+    bool liveGzip_;                    // 没有旁路文件，发送前实时压缩
+    Compressor compressor_;            // 本连接的压缩流
+    char lastModified_[32];            // IMF-fixdate
+
+    /**
+     * @brief 一个可满足的字节区间 [first, last]
+     */
+    struct ByteRange
+    {
+        size_t first;
+        size_t last;
+    };
+
+    std::string_view range_;   // Range
+    std::string_view ifRange_; // If-Range
+    ByteRange ranges_[MAX_RANGES];
+    int rangeCnt_;
+
+    const CachedFile *file_; // 生成响应期间 Pin 住的文件
+    struct stat mmFileStat_; // 文件的 stat 信息(大小/权限等)
+
+    Piece pieces_[MAX_PIECES]; // 本次响应的各段
+    int pieceCnt_;
+    size_t textMark_;          // buff 中已记录到段里的位置
 
-    // 后缀 -> MIME类型
-    static const std::unordered_map<std::string, std::string> SUFFIX_TYPE;
     // 状态码 -> 状态描述
     static const std::unordered_map<int, std::string> CODE_STATUS;
     // 部分错误码 -> 错误页面对应路径
@@ -0,0 +1,193 @@
+#include "HttpScan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCAN_X86 1
+#endif
+
+namespace
+{
+    // 256 项字符分类表：bit0 token 字符，bit1 控制字符(除 HTAB)
+    const unsigned char TOKEN = 1;
+    const unsigned char SPECIAL = 2;
+
+    struct CharTable
+    {
+        unsigned char cls[256];
+        CharTable() : cls()
+        {
+            for (int c = '0'; c <= '9'; c++)
+                cls[c] |= TOKEN;
+            for (int c = 'a'; c <= 'z'; c++)
+                cls[c] |= TOKEN;
+            for (int c = 'A'; c <= 'Z'; c++)
+                cls[c] |= TOKEN;
+            for (const char *p = "!#$%&'*+-.^_`|~"; *p; p++)
+                cls[static_cast<unsigned char>(*p)] |= TOKEN;
+            for (int c = 0; c < 0x20; c++)
+            {
+                if (c != '\t')
+                    cls[c] |= SPECIAL;
+            }
+            cls[0x7f] |= SPECIAL;
+        }
+    };
+
+    const CharTable &Table()
+    {
+        static const CharTable table;
+        return table;
+    }
+
+    /* ---------------- 标量实现 ---------------- */
+
+    const char *FindSpecialScalar(const char *begin, const char *end)
+    {
+        const unsigned char *cls = Table().cls;
+        for (; begin < end; begin++)
+        {
+            if (cls[static_cast<unsigned char>(*begin)] & SPECIAL)
+                return begin;
+        }
+        return end;
+    }
+
+    const char *FindTokenEndScalar(const char *begin, const char *end)
+    {
+        const unsigned char *cls = Table().cls;
+        for (; begin < end; begin++)
+        {
+            if (!(cls[static_cast<unsigned char>(*begin)] & TOKEN))
+                return begin;
+        }
+        return end;
+    }
+
+#ifdef HTTP_SCAN_X86
+    // token 字符的半字节查表：低 4 位查出一个位图(每位对应一个高 4 位取值)，
+    // 高 4 位查出自己对应的那一位，两者相与非 0 即为 token 字符；高 4 位 >= 8 的字节都不是 token
+#define TOKEN_LO_NIBBLE 0xe8, 0xfc, 0xf8, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, \
+                        0xf8, 0xf8, 0xf4, 0x54, 0xd0, 0x54, 0xf4, 0x70
+#define TOKEN_HI_NIBBLE 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80), \
+                        0, 0, 0, 0, 0, 0, 0, 0
+
+    /* ---------------- SSE4.2 实现 ---------------- */
+
+    __attribute__((target("sse4.2"))) const char *FindSpecialSse42(const char *begin, const char *end)
+    {
+        // 区间：[0x00, 0x08] [0x0a, 0x1f] [0x7f, 0x7f]
+        const __m128i ranges = _mm_setr_epi8(0x00, 0x08, 0x0a, 0x1f, 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        while (end - begin >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            int idx = _mm_cmpestri(ranges, 6, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+            if (idx != 16)
+                return begin + idx;
+            begin += 16;
+        }
+        return FindSpecialScalar(begin, end);
+    }
+
+    __attribute__((target("sse4.2"))) const char *FindTokenEndSse42(const char *begin, const char *end)
+    {
+        const __m128i loTable = _mm_setr_epi8(TOKEN_LO_NIBBLE);
+        const __m128i hiTable = _mm_setr_epi8(TOKEN_HI_NIBBLE);
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        while (end - begin >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            __m128i lo = _mm_shuffle_epi8(loTable, _mm_and_si128(v, nibble));
+            __m128i hi = _mm_shuffle_epi8(hiTable, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            __m128i bad = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+            int mask = _mm_movemask_epi8(bad);
+            if (mask)
+                return begin + __builtin_ctz(mask);
+            begin += 16;
+        }
+        return FindTokenEndScalar(begin, end);
+    }
+
+    /* ---------------- AVX2 实现 ---------------- */
+
+    __attribute__((target("avx2"))) const char *FindSpecialAvx2(const char *begin, const char *end)
+    {
+        const __m256i ctlMax = _mm256_set1_epi8(0x1f);
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i del = _mm256_set1_epi8(0x7f);
+        while (end - begin >= 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            // v <= 0x1f(无符号) 且不是 HTAB，或者是 DEL
+            __m256i ctl = _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctlMax), ctlMax);
+            ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl);
+            ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(ctl));
+            if (mask)
+                return begin + __builtin_ctz(mask);
+            begin += 32;
+        }
+        return FindSpecialSse42(begin, end);
+    }
+
+    __attribute__((target("avx2"))) const char *FindTokenEndAvx2(const char *begin, const char *end)
+    {
+        const __m256i loTable = _mm256_setr_epi8(TOKEN_LO_NIBBLE, TOKEN_LO_NIBBLE);
+        const __m256i hiTable = _mm256_setr_epi8(TOKEN_HI_NIBBLE, TOKEN_HI_NIBBLE);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        while (end - begin >= 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+            __m256i lo = _mm256_shuffle_epi8(loTable, _mm256_and_si256(v, nibble));
+            __m256i hi = _mm256_shuffle_epi8(hiTable, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            __m256i bad = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(bad));
+            if (mask)
+                return begin + __builtin_ctz(mask);
+            begin += 32;
+        }
+        return FindTokenEndSse42(begin, end);
+    }
+#endif
+
+    const HttpScan::Kernels SCALAR_KERNELS = {FindSpecialScalar, FindTokenEndScalar, "scalar"};
+#ifdef HTTP_SCAN_X86
+    const HttpScan::Kernels SSE42_KERNELS = {FindSpecialSse42, FindTokenEndSse42, "sse4.2"};
+    const HttpScan::Kernels AVX2_KERNELS = {FindSpecialAvx2, FindTokenEndAvx2, "avx2"};
+#endif
+}
+
+const HttpScan::Kernels *HttpScan::Get(Impl impl)
+{
+    switch (impl)
+    {
+    case SCALAR:
+        return &SCALAR_KERNELS;
+#ifdef HTTP_SCAN_X86
+    case SSE42:
+        return __builtin_cpu_supports("sse4.2") ? &SSE42_KERNELS : nullptr;
+    case AVX2:
+        // AVX2 内核的尾部交给 SSE4.2 处理
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2") ? &AVX2_KERNELS : nullptr;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const HttpScan::Kernels &HttpScan::Active()
+{
+    static const Kernels &active = []() -> const Kernels &
+    {
+        if (const Kernels *k = Get(AVX2))
+            return *k;
+        if (const Kernels *k = Get(SSE42))
+            return *k;
+        return SCALAR_KERNELS;
+    }();
+    return active;
+}
+
+bool HttpScan::IsTokenChar(unsigned char ch)
+{
+    return Table().cls[ch] & TOKEN;
+}
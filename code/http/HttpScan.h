@@ -0,0 +1,67 @@
+#ifndef HTTP_SCAN_H
+#define HTTP_SCAN_H
+
+#include <cstddef>
+
+/**
+ * @brief HTTP 报文扫描内核：一次检查 16 / 32 字节，找行尾 / 非法字节，校验 token 字符
+ *        - SSE4.2：PCMPESTRI 按字符区间找控制字符，PSHUFB 半字节查表校验 token
+ *        - AVX2：32 字节比较 + PSHUFB 查表
+ *        - 标量：查表逐字节
+ *        启动时按 CPUID 选择当前 CPU 支持的最快实现，不需要额外的编译选项
+ */
+class HttpScan
+{
+public:
+    enum Impl
+    {
+        SCALAR,
+        SSE42,
+        AVX2,
+    };
+
+    struct Kernels
+    {
+        /**
+         * @brief 找第一个控制字符(0x00-0x1f 中除 HTAB 以外的字节，以及 DEL)
+         *        CR / LF 用来定位行尾，其余控制字符说明报文非法
+         * @return 指向该字节；没有则返回 end
+         */
+        const char *(*findSpecial)(const char *begin, const char *end);
+
+        /**
+         * @brief 找第一个不是 token 字符(RFC 9110 tchar)的字节，用于方法名 / 头部名
+         * @return 指向该字节；全部是 token 字符则返回 end
+         */
+        const char *(*findTokenEnd)(const char *begin, const char *end);
+
+        const char *name;
+    };
+
+    /**
+     * @brief 当前 CPU 选中的实现
+     */
+    static const Kernels &Active();
+
+    /**
+     * @brief 指定的实现(基准测试用)；CPU 不支持时返回 nullptr
+     */
+    static const Kernels *Get(Impl impl);
+
+    static const char *FindSpecial(const char *begin, const char *end)
+    {
+        return Active().findSpecial(begin, end);
+    }
+
+    static const char *FindTokenEnd(const char *begin, const char *end)
+    {
+        return Active().findTokenEnd(begin, end);
+    }
+
+    /**
+     * @brief 单个字节是否为 token 字符
+     */
+    static bool IsTokenChar(unsigned char ch);
+};
+
+#endif // HTTP_SCAN_H
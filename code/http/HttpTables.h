@@ -0,0 +1,291 @@
+#ifndef HTTP_TABLES_H
+#define HTTP_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief 编译期生成的完美哈希表：已知请求头名 -> HeaderId，文件后缀 -> MIME 类型
+ *        编译时为每张表搜索一个没有冲突的哈希种子，查找只需一次哈希 + 一次不区分大小写的比较，不分配内存
+ */
+namespace HttpTables
+{
+    /**
+     * @brief 已知请求头。HttpRequest 按 id 记录每种头第一次出现的位置，按 id 查找是 O(1)
+     */
+    enum HeaderId : uint8_t
+    {
+        H_UNKNOWN = 0,
+        H_HOST,
+        H_CONNECTION,
+        H_KEEP_ALIVE,
+        H_CONTENT_LENGTH,
+        H_CONTENT_TYPE,
+        H_CONTENT_ENCODING,
+        H_TRANSFER_ENCODING,
+        H_TE,
+        H_TRAILER,
+        H_EXPECT,
+        H_UPGRADE,
+        H_HTTP2_SETTINGS,
+        H_ACCEPT,
+        H_ACCEPT_ENCODING,
+        H_ACCEPT_LANGUAGE,
+        H_USER_AGENT,
+        H_REFERER,
+        H_ORIGIN,
+        H_COOKIE,
+        H_AUTHORIZATION,
+        H_CACHE_CONTROL,
+        H_PRAGMA,
+        H_IF_MATCH,
+        H_IF_NONE_MATCH,
+        H_IF_MODIFIED_SINCE,
+        H_IF_UNMODIFIED_SINCE,
+        H_RANGE,
+        H_IF_RANGE,
+        HEADER_ID_COUNT,
+    };
+
+    struct HeaderName
+    {
+        std::string_view name;
+        HeaderId id;
+    };
+
+    inline constexpr HeaderName HEADERS[] = {
+        {"Host", H_HOST},
+        {"Connection", H_CONNECTION},
+        {"Keep-Alive", H_KEEP_ALIVE},
+        {"Content-Length", H_CONTENT_LENGTH},
+        {"Content-Type", H_CONTENT_TYPE},
+        {"Content-Encoding", H_CONTENT_ENCODING},
+        {"Transfer-Encoding", H_TRANSFER_ENCODING},
+        {"TE", H_TE},
+        {"Trailer", H_TRAILER},
+        {"Expect", H_EXPECT},
+        {"Upgrade", H_UPGRADE},
+        {"HTTP2-Settings", H_HTTP2_SETTINGS},
+        {"Accept", H_ACCEPT},
+        {"Accept-Encoding", H_ACCEPT_ENCODING},
+        {"Accept-Language", H_ACCEPT_LANGUAGE},
+        {"User-Agent", H_USER_AGENT},
+        {"Referer", H_REFERER},
+        {"Origin", H_ORIGIN},
+        {"Cookie", H_COOKIE},
+        {"Authorization", H_AUTHORIZATION},
+        {"Cache-Control", H_CACHE_CONTROL},
+        {"Pragma", H_PRAGMA},
+        {"If-Match", H_IF_MATCH},
+        {"If-None-Match", H_IF_NONE_MATCH},
+        {"If-Modified-Since", H_IF_MODIFIED_SINCE},
+        {"If-Unmodified-Since", H_IF_UNMODIFIED_SINCE},
+        {"Range", H_RANGE},
+        {"If-Range", H_IF_RANGE},
+    };
+
+    /**
+     * @brief 文件后缀(不含 '.'，小写) -> MIME 类型，以及拼好的 "Content-Type: ...\r\n" 头部行
+     */
+    struct MimeType
+    {
+        std::string_view ext;
+        std::string_view type;
+        std::string_view header;
+    };
+
+#define HTTP_MIME(ext, type) {ext, type, "Content-Type: " type "\r\n"}
+    inline constexpr MimeType MIME_TYPES[] = {
+        HTTP_MIME("html", "text/html"),
+        HTTP_MIME("htm", "text/html"),
+        HTTP_MIME("xml", "text/xml"),
+        HTTP_MIME("xhtml", "application/xhtml+xml"),
+        HTTP_MIME("txt", "text/plain"),
+        HTTP_MIME("css", "text/css"),
+        HTTP_MIME("js", "text/javascript"),
+        HTTP_MIME("mjs", "text/javascript"),
+        HTTP_MIME("json", "application/json"),
+        HTTP_MIME("map", "application/json"),
+        HTTP_MIME("wasm", "application/wasm"),
+        HTTP_MIME("rtf", "application/rtf"),
+        HTTP_MIME("pdf", "application/pdf"),
+        HTTP_MIME("word", "application/msword"),
+        HTTP_MIME("doc", "application/msword"),
+        HTTP_MIME("zip", "application/zip"),
+        HTTP_MIME("gz", "application/gzip"),
+        HTTP_MIME("png", "image/png"),
+        HTTP_MIME("gif", "image/gif"),
+        HTTP_MIME("jpg", "image/jpeg"),
+        HTTP_MIME("jpeg", "image/jpeg"),
+        HTTP_MIME("webp", "image/webp"),
+        HTTP_MIME("avif", "image/avif"),
+        HTTP_MIME("svg", "image/svg+xml"),
+        HTTP_MIME("ico", "image/x-icon"),
+        HTTP_MIME("bmp", "image/bmp"),
+        HTTP_MIME("woff", "font/woff"),
+        HTTP_MIME("woff2", "font/woff2"),
+        HTTP_MIME("ttf", "font/ttf"),
+        HTTP_MIME("otf", "font/otf"),
+        HTTP_MIME("eot", "application/vnd.ms-fontobject"),
+        HTTP_MIME("mp3", "audio/mpeg"),
+        HTTP_MIME("ogg", "audio/ogg"),
+        HTTP_MIME("wav", "audio/wav"),
+        HTTP_MIME("mp4", "video/mp4"),
+        HTTP_MIME("webm", "video/webm"),
+        HTTP_MIME("flv", "video/x-flv"),
+    };
+#undef HTTP_MIME
+
+    // 未知后缀 / 无后缀
+    inline constexpr MimeType DEFAULT_MIME = {"", "text/plain", "Content-Type: text/plain\r\n"};
+
+    /* ---------------- 完美哈希 ---------------- */
+
+    /**
+     * @brief 大小写无关的 FNV-1a：字节统一 | 0x20 后参与哈希(对非字母也这样做只会影响分布，
+     *        命中后还会做一次精确的不区分大小写比较)
+     */
+    constexpr uint32_t Hash(std::string_view key, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed ^ static_cast<uint32_t>(key.size());
+        for (char ch : key)
+        {
+            h = (h ^ static_cast<unsigned char>(ch | 0x20)) * 16777619u;
+        }
+        return h ^ (h >> 16);
+    }
+
+    constexpr char Lower(char ch)
+    {
+        return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch + ('a' - 'A')) : ch;
+    }
+
+    constexpr bool EqualNoCase(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (Lower(a[i]) != Lower(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 一张完美哈希表：slot[Hash(key, seed) & (SIZE - 1)] = 表项下标 + 1，0 表示空
+     */
+    template <size_t SIZE>
+    struct PerfectHash
+    {
+        static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+        uint32_t seed;
+        uint8_t slot[SIZE];
+    };
+
+    /**
+     * @brief 编译期从 1 开始逐个尝试种子，直到所有键落在不同的槽位；找不到时 seed = 0
+     */
+    template <size_t SIZE, typename Entry, size_t N, typename KeyOf>
+    constexpr PerfectHash<SIZE> BuildPerfectHash(const Entry (&entries)[N], KeyOf keyOf)
+    {
+        static_assert(N < SIZE && N < 255, "table too small");
+        PerfectHash<SIZE> table{};
+        for (uint32_t seed = 1; seed < 100000; seed++)
+        {
+            for (size_t i = 0; i < SIZE; i++)
+                table.slot[i] = 0;
+            bool ok = true;
+            for (size_t i = 0; i < N && ok; i++)
+            {
+                size_t idx = Hash(keyOf(entries[i]), seed) & (SIZE - 1);
+                if (table.slot[idx])
+                    ok = false;
+                else
+                    table.slot[idx] = static_cast<uint8_t>(i + 1);
+            }
+            if (ok)
+            {
+                table.seed = seed;
+                return table;
+            }
+        }
+        table.seed = 0;
+        return table;
+    }
+
+    inline constexpr auto HEADER_HASH = BuildPerfectHash<128>(HEADERS, [](const HeaderName &e)
+                                                              { return e.name; });
+    static_assert(HEADER_HASH.seed != 0, "no perfect hash seed for HEADERS");
+
+    inline constexpr auto MIME_HASH = BuildPerfectHash<128>(MIME_TYPES, [](const MimeType &e)
+                                                            { return e.ext; });
+    static_assert(MIME_HASH.seed != 0, "no perfect hash seed for MIME_TYPES");
+
+    /**
+     * @brief 请求头名 -> HeaderId，不区分大小写；未知头返回 H_UNKNOWN
+     */
+    constexpr HeaderId LookupHeader(std::string_view name)
+    {
+        uint8_t i = HEADER_HASH.slot[Hash(name, HEADER_HASH.seed) & 127];
+        return (i && EqualNoCase(HEADERS[i - 1].name, name)) ? HEADERS[i - 1].id : H_UNKNOWN;
+    }
+
+    /**
+     * @brief 文件后缀(不含 '.')-> MIME 类型，不区分大小写；未知后缀返回 text/plain
+     */
+    constexpr const MimeType &LookupMime(std::string_view ext)
+    {
+        uint8_t i = MIME_HASH.slot[Hash(ext, MIME_HASH.seed) & 127];
+        return (i && EqualNoCase(MIME_TYPES[i - 1].ext, ext)) ? MIME_TYPES[i - 1] : DEFAULT_MIME;
+    }
+
+    /**
+     * @brief 按路径的后缀查 MIME 类型
+     */
+    constexpr const MimeType &MimeOfPath(std::string_view path)
+    {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos)
+            return DEFAULT_MIME;
+        return LookupMime(path.substr(dot + 1));
+    }
+
+    /**
+     * @brief 该 Content-Type 是否值得压缩：文本类、JSON / XML / SVG、wasm 与未压缩的字体 / 图标
+     *        (图片、音视频、woff / woff2、压缩包本身已经压缩过)；忽略 "; charset=..." 等参数
+     */
+    constexpr bool CompressibleType(std::string_view type)
+    {
+        type = type.substr(0, type.find(';'));
+        if (type.substr(0, 5) == "text/")
+            return true;
+        constexpr std::string_view TYPES[] = {
+            "application/json", "application/xhtml+xml", "application/wasm", "application/rtf",
+            "image/svg+xml", "image/x-icon", "image/bmp", "font/ttf", "font/otf", "application/vnd.ms-fontobject",
+        };
+        for (std::string_view t : TYPES)
+        {
+            if (type == t)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 该类型的文件是否值得压缩；未知后缀不压缩
+     */
+    constexpr bool Compressible(const MimeType &mime)
+    {
+        return !mime.ext.empty() && CompressibleType(mime.type);
+    }
+
+    static_assert(LookupHeader("content-length") == H_CONTENT_LENGTH, "header lookup");
+    static_assert(LookupHeader("X-Unknown") == H_UNKNOWN, "header lookup");
+    static_assert(LookupMime("WOFF2").type == "font/woff2", "mime lookup");
+    static_assert(Compressible(MimeOfPath("/js/jquery.js")) && !Compressible(MimeOfPath("/a.woff2")), "compressible");
+    static_assert(CompressibleType("application/json; charset=utf-8") && !CompressibleType("image/png"), "compressible");
+}
+
+#endif // HTTP_TABLES_H
@@ -0,0 +1,406 @@
+#include "MultipartParser.h"
+#include <algorithm>
+#include <cstdlib>  // mkstemp
+#include <cstring>
+#include <cerrno>
+#include <unistd.h> // write, close, unlink
+#include <strings.h> // strncasecmp
+
+MultipartParser::MultipartParser()
+    : state_(DONE),
+      matched_(0),
+      quota_(0),
+      used_(0),
+      isFile_(false),
+      fd_(-1),
+      parts_(0)
+{
+}
+
+MultipartParser::~MultipartParser()
+{
+    Reset();
+}
+
+void MultipartParser::Init(std::string_view boundary, const std::string &spoolDir, size_t quota)
+{
+    Reset();
+    delim_ = "\r\n--";
+    delim_.append(boundary.data(), boundary.size());
+    // 请求体开头的分隔符前面没有 CRLF：视为已经匹配了 "\r\n"
+    matched_ = 2;
+    state_ = PREAMBLE;
+    spoolDir_ = spoolDir;
+    quota_ = quota;
+    used_ = 0;
+    parts_ = 0;
+}
+
+void MultipartParser::Reset()
+{
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+    // 没有完整结束的上传不保留半截文件
+    if (state_ != DONE)
+    {
+        for (const FilePart &file : files_)
+        {
+            unlink(file.spoolPath.c_str());
+        }
+    }
+    state_ = DONE;
+    files_.clear();
+    fields_.clear();
+    header_.clear();
+    fieldName_.clear();
+    fieldValue_.clear();
+    isFile_ = false;
+}
+
+std::string_view MultipartParser::Boundary(std::string_view contentType)
+{
+    static const char TYPE[] = "multipart/form-data";
+    const size_t typeLen = sizeof(TYPE) - 1;
+    if (contentType.size() < typeLen || strncasecmp(contentType.data(), TYPE, typeLen) != 0)
+    {
+        return std::string_view();
+    }
+    for (size_t pos = contentType.find(';'); pos != std::string_view::npos; pos = contentType.find(';', pos + 1))
+    {
+        std::string_view param = contentType.substr(pos + 1);
+        while (!param.empty() && (param.front() == ' ' || param.front() == '\t'))
+            param.remove_prefix(1);
+        if (param.size() < 9 || strncasecmp(param.data(), "boundary=", 9) != 0)
+            continue;
+        param.remove_prefix(9);
+        std::string_view value;
+        if (!param.empty() && param.front() == '"')
+        {
+            size_t quote = param.find('"', 1);
+            if (quote == std::string_view::npos)
+                return std::string_view();
+            value = param.substr(1, quote - 1);
+        }
+        else
+        {
+            value = param.substr(0, param.find_first_of("; \t"));
+        }
+        // RFC 2046：1 到 70 个字符，不含 CR / LF
+        if (value.empty() || value.size() > 70 || value.find_first_of("\r\n") != std::string_view::npos)
+            return std::string_view();
+        return value;
+    }
+    return std::string_view();
+}
+
+MultipartParser::Status MultipartParser::Feed(const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        size_t used = 0;
+        switch (state_)
+        {
+        case PREAMBLE:
+        case PART_BODY:
+        {
+            bool found = false;
+            used = ScanBody_(data, len, found);
+            if (state_ == FAILED)
+                return quota_ && used_ > quota_ ? TOO_LARGE : IO_ERROR;
+            if (found)
+            {
+                if (state_ == PART_BODY)
+                    EndPart_();
+                state_ = AFTER_DELIM;
+            }
+            break;
+        }
+
+        case AFTER_DELIM:
+        case PART_HEADERS:
+        {
+            // 分隔符之后的传输填充 + 部分头，累积到空行为止；"--" 表示最后一个分隔符
+            size_t old = header_.size();
+            size_t take = std::min(len, MAX_PART_HEADER + 4 - old);
+            header_.append(data, take);
+            if (state_ == AFTER_DELIM && header_.size() >= 2)
+            {
+                if (header_[0] == '-' && header_[1] == '-')
+                {
+                    state_ = DONE;
+                    header_.clear();
+                    return OK; // 结束分隔符之后的内容忽略
+                }
+                state_ = PART_HEADERS;
+            }
+            if (state_ == AFTER_DELIM)
+            {
+                used = take;
+                break;
+            }
+            // 第一行是分隔符行剩余部分(只允许空白)，之后是部分头，以空行结束
+            size_t lineEnd = header_.find("\r\n");
+            if (lineEnd == std::string::npos)
+            {
+                if (header_.size() > MAX_PART_HEADER)
+                {
+                    state_ = FAILED;
+                    return BAD;
+                }
+                used = take;
+                break;
+            }
+            if (header_.find_first_not_of(" \t") < lineEnd)
+            {
+                state_ = FAILED;
+                return BAD;
+            }
+            size_t end = header_.compare(lineEnd, 4, "\r\n\r\n") == 0 ? lineEnd : header_.find("\r\n\r\n", lineEnd);
+            if (end == std::string::npos)
+            {
+                if (header_.size() > MAX_PART_HEADER)
+                {
+                    state_ = FAILED;
+                    return BAD;
+                }
+                used = take;
+                break;
+            }
+            // 部分头之后的数据还给正文
+            used = end + 4 - old;
+            header_.resize(end + 2);
+            Status st = BeginPart_();
+            header_.clear();
+            if (st != OK)
+            {
+                state_ = FAILED;
+                return st;
+            }
+            state_ = PART_BODY;
+            matched_ = 0;
+            break;
+        }
+
+        case DONE:
+            return OK;
+
+        case FAILED:
+            return BAD;
+        }
+        data += used;
+        len -= used;
+    }
+    return OK;
+}
+
+size_t MultipartParser::ScanBody_(const char *data, size_t len, bool &found)
+{
+    found = false;
+    const size_t dlen = delim_.size();
+
+    // 上一段末尾匹配了分隔符的前缀：先看这一段能否接上
+    if (matched_ > 0)
+    {
+        size_t need = std::min(dlen - matched_, len);
+        if (memcmp(data, delim_.data() + matched_, need) == 0)
+        {
+            if (matched_ + need == dlen)
+            {
+                matched_ = 0;
+                found = true;
+                return need;
+            }
+            matched_ += need;
+            return need;
+        }
+        // 接不上：之前扣下的前缀是正文。分隔符里只有开头一个 CR，前缀中不会藏着另一个分隔符的起点
+        size_t carried = matched_;
+        matched_ = 0;
+        if (state_ == PART_BODY && Emit_(delim_.data(), carried) != OK)
+        {
+            state_ = FAILED;
+            return 0;
+        }
+    }
+
+    const char *p = data;
+    const char *end = data + len;
+    while (p < end)
+    {
+        const char *cr = static_cast<const char *>(memchr(p, '\r', end - p));
+        if (!cr)
+        {
+            break;
+        }
+        size_t avail = end - cr;
+        size_t cmp = std::min(avail, dlen);
+        if (memcmp(cr, delim_.data(), cmp) == 0)
+        {
+            if (state_ == PART_BODY && Emit_(data, cr - data) != OK)
+            {
+                state_ = FAILED;
+                return 0;
+            }
+            if (cmp == dlen)
+            {
+                found = true;
+                return cr - data + dlen;
+            }
+            // 段尾是分隔符的前缀，等下一段再判断
+            matched_ = cmp;
+            return len;
+        }
+        p = cr + 1;
+    }
+
+    if (state_ == PART_BODY && Emit_(data, len) != OK)
+    {
+        state_ = FAILED;
+        return 0;
+    }
+    return len;
+}
+
+MultipartParser::Status MultipartParser::Emit_(const char *data, size_t len)
+{
+    if (len == 0)
+    {
+        return OK;
+    }
+    used_ += len;
+    if (used_ > quota_)
+    {
+        return TOO_LARGE;
+    }
+    if (!isFile_)
+    {
+        if (fieldValue_.size() + len > MAX_FIELD_BYTES)
+        {
+            used_ = quota_ + 1; // 按超限处理
+            return TOO_LARGE;
+        }
+        fieldValue_.append(data, len);
+        return OK;
+    }
+
+    files_.back().size += len;
+    while (len > 0)
+    {
+        ssize_t n = write(fd_, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return IO_ERROR;
+        }
+        data += n;
+        len -= n;
+    }
+    return OK;
+}
+
+MultipartParser::Status MultipartParser::BeginPart_()
+{
+    if (++parts_ > MAX_PARTS)
+    {
+        used_ = quota_ + 1;
+        return TOO_LARGE;
+    }
+
+    // header_ 形如 "<填充>\r\nName: value\r\n...\r\n"，跳过第一行
+    std::string_view headers(header_);
+    headers.remove_prefix(headers.find("\r\n") + 2);
+    std::string_view disposition;
+    std::string_view type;
+    while (!headers.empty())
+    {
+        size_t eol = headers.find("\r\n");
+        std::string_view line = headers.substr(0, eol);
+        headers.remove_prefix(eol + 2);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos)
+        {
+            return BAD;
+        }
+        std::string_view key = line.substr(0, colon);
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        if (key.size() == 19 && strncasecmp(key.data(), "Content-Disposition", 19) == 0)
+            disposition = value;
+        else if (key.size() == 12 && strncasecmp(key.data(), "Content-Type", 12) == 0)
+            type = value;
+    }
+    if (disposition.size() < 9 || strncasecmp(disposition.data(), "form-data", 9) != 0)
+    {
+        return BAD;
+    }
+
+    fieldName_ = Param_(disposition, "name");
+    fieldValue_.clear();
+    // 带 filename 参数的是文件部分
+    isFile_ = disposition.find("filename=") != std::string_view::npos;
+    if (!isFile_)
+    {
+        return OK;
+    }
+
+    // 落盘名由 mkstemp 生成，不使用客户端提供的文件名
+    std::string path = spoolDir_ + "/upload-XXXXXX";
+    fd_ = mkstemp(&path[0]);
+    if (fd_ < 0)
+    {
+        return IO_ERROR;
+    }
+    files_.push_back({fieldName_, Param_(disposition, "filename"), std::string(type), path, 0});
+    return OK;
+}
+
+void MultipartParser::EndPart_()
+{
+    if (isFile_)
+    {
+        if (fd_ >= 0)
+        {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+    else
+    {
+        fields_[fieldName_] = std::move(fieldValue_);
+    }
+    fieldValue_.clear();
+    isFile_ = false;
+}
+
+std::string MultipartParser::Param_(std::string_view header, std::string_view key)
+{
+    // 参数以 ';' 分隔：key=value 或 key="value"
+    for (size_t pos = header.find(';'); pos != std::string_view::npos; pos = header.find(';', pos + 1))
+    {
+        std::string_view param = header.substr(pos + 1);
+        while (!param.empty() && (param.front() == ' ' || param.front() == '\t'))
+            param.remove_prefix(1);
+        if (param.size() <= key.size() || param[key.size()] != '=' ||
+            strncasecmp(param.data(), key.data(), key.size()) != 0)
+            continue;
+        param.remove_prefix(key.size() + 1);
+        if (!param.empty() && param.front() == '"')
+        {
+            std::string value;
+            for (size_t i = 1; i < param.size() && param[i] != '"'; i++)
+            {
+                if (param[i] == '\\' && i + 1 < param.size())
+                    i++;
+                value += param[i];
+            }
+            return value;
+        }
+        return std::string(param.substr(0, param.find(';')));
+    }
+    return std::string();
+}
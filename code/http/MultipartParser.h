@@ -0,0 +1,135 @@
+#ifndef MULTIPART_PARSER_H
+#define MULTIPART_PARSER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @brief multipart/form-data 流式解析器
+ *        请求体按到达顺序分段喂入，文件部分边解析边写入上传目录，普通字段存到内存；
+ *        只保留跨段的分隔符前缀(不超过分隔符长度)和部分头，内存占用与上传大小无关
+ */
+class MultipartParser
+{
+public:
+    enum Status
+    {
+        OK,        // 正常
+        BAD,       // 格式错误
+        TOO_LARGE, // 超过配额
+        IO_ERROR,  // 写盘失败
+    };
+
+    /**
+     * @brief 一个文件部分
+     */
+    struct FilePart
+    {
+        std::string name;        // 表单字段名
+        std::string filename;    // 客户端提供的文件名(仅供展示，不用于落盘路径)
+        std::string contentType; // 部分的 Content-Type
+        std::string spoolPath;   // 落盘路径
+        size_t size;             // 字节数
+    };
+
+    MultipartParser();
+    ~MultipartParser();
+
+    /**
+     * @brief 开始解析一个请求体
+     * @param boundary 来自 Content-Type 的 boundary 参数
+     * @param spoolDir 文件部分的落盘目录
+     * @param quota    本请求所有部分(文件 + 字段)的字节数上限
+     */
+    void Init(std::string_view boundary, const std::string &spoolDir, size_t quota);
+
+    /**
+     * @brief 放弃当前请求：关闭并删除已写入的文件(解析已完成时保留)
+     */
+    void Reset();
+
+    /**
+     * @brief 喂入一段请求体(解码后的字节)，可以在任意位置拆开
+     */
+    Status Feed(const char *data, size_t len);
+
+    /**
+     * @brief 是否已读到结束分隔符
+     */
+    bool IsDone() const { return state_ == DONE; }
+
+    const std::vector<FilePart> &Files() const { return files_; }
+    const std::unordered_map<std::string, std::string> &Fields() const { return fields_; }
+
+    /**
+     * @brief 从 Content-Type 中取出 multipart/form-data 的 boundary
+     * @return 不是 multipart/form-data 或 boundary 非法时返回空
+     */
+    static std::string_view Boundary(std::string_view contentType);
+
+private:
+    enum State
+    {
+        PREAMBLE,     // 第一个分隔符之前(丢弃)
+        AFTER_DELIM,  // 分隔符之后："--" 表示结束，否则是部分头
+        PART_HEADERS, // 部分头，直到空行
+        PART_BODY,    // 部分正文，直到下一个分隔符
+        DONE,         // 结束分隔符之后(丢弃)
+        FAILED,
+    };
+
+    // 单个部分头的最大字节数
+    static const size_t MAX_PART_HEADER = 8 * 1024;
+    // 单个普通字段的最大字节数
+    static const size_t MAX_FIELD_BYTES = 64 * 1024;
+    // 最多的部分数
+    static const size_t MAX_PARTS = 64;
+
+    /**
+     * @brief 在 [data, data+len) 中找分隔符 "\r\n--boundary"，分隔符之前的数据交给 Emit_
+     * @return 消耗的字节数；找到完整分隔符时 found = true
+     */
+    size_t ScanBody_(const char *data, size_t len, bool &found);
+
+    /**
+     * @brief 部分正文数据：写文件或追加到字段值
+     */
+    Status Emit_(const char *data, size_t len);
+
+    /**
+     * @brief 解析部分头(Content-Disposition / Content-Type)并打开落盘文件
+     */
+    Status BeginPart_();
+
+    /**
+     * @brief 当前部分结束：关闭文件 / 保存字段
+     */
+    void EndPart_();
+
+    /**
+     * @brief 取 Content-Disposition 中的参数，如 name="a"
+     */
+    static std::string Param_(std::string_view header, std::string_view key);
+
+    State state_;
+    std::string delim_;  // "\r\n--" + boundary
+    size_t matched_;     // 上一段末尾已匹配的分隔符前缀长度
+    std::string header_; // 正在累积的部分头
+    std::string spoolDir_;
+    size_t quota_;
+    size_t used_;
+
+    // 当前部分
+    bool isFile_;
+    int fd_;
+    std::string fieldName_;
+    std::string fieldValue_;
+
+    size_t parts_;
+    std::vector<FilePart> files_;
+    std::unordered_map<std::string, std::string> fields_;
+};
+
+#endif // MULTIPART_PARSER_H
@@ -0,0 +1,255 @@
+#include "Precompressor.h"
+#include "HttpTables.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef WEBSERVER_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace
+{
+    bool EndsWith(std::string_view s, std::string_view suffix)
+    {
+        return s.size() >= suffix.size() && s.substr(s.size() - suffix.size()) == suffix;
+    }
+
+    bool NewerOrSame(const struct stat &a, const struct stat &b)
+    {
+        return a.st_mtim.tv_sec > b.st_mtim.tv_sec ||
+               (a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec >= b.st_mtim.tv_nsec);
+    }
+
+    bool ReadAll(const std::string &path, size_t size, std::string &out)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        out.resize(size);
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = read(fd, &out[done], size - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += n;
+        }
+        close(fd);
+        return done == size;
+    }
+}
+
+Precompressor::Precompressor(size_t minBytes)
+    : minBytes_(minBytes),
+      files_(0),
+      written_(0),
+      upToDate_(0),
+      skipped_(0),
+      failed_(0),
+      bytesIn_(0),
+      bytesOut_(0)
+{
+}
+
+void Precompressor::Run(const std::string &root)
+{
+    struct stat st;
+    if (stat(root.c_str(), &st) == 0)
+    {
+        visited_.emplace(st.st_dev, st.st_ino);
+    }
+    Walk_(root);
+}
+
+std::string Precompressor::Report() const
+{
+    return "files=" + std::to_string(files_) +
+           " written=" + std::to_string(written_) +
+           " upToDate=" + std::to_string(upToDate_) +
+           " skipped=" + std::to_string(skipped_) +
+           " failed=" + std::to_string(failed_) +
+           " bytes=" + std::to_string(bytesIn_) + "->" + std::to_string(bytesOut_);
+}
+
+void Precompressor::Walk_(const std::string &dir)
+{
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+    {
+        std::cerr << "Precompress: open dir " << dir << " failed: " << strerror(errno) << std::endl;
+        return;
+    }
+    while (struct dirent *ent = readdir(d))
+    {
+        // 跳过隐藏文件(含 . / ..)与旁路文件本身
+        std::string_view name = ent->d_name;
+        if (name.empty() || name[0] == '.' || EndsWith(name, ".tmp"))
+            continue;
+        std::string path = dir + "/" + ent->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) < 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+        {
+            if (visited_.emplace(st.st_dev, st.st_ino).second)
+            {
+                Walk_(path);
+            }
+        }
+        else if (S_ISREG(st.st_mode))
+        {
+            Process_(path, st);
+        }
+    }
+    closedir(d);
+}
+
+void Precompressor::Process_(const std::string &path, const struct stat &st)
+{
+    const HttpTables::MimeType &mime = HttpTables::MimeOfPath(path);
+    if (!HttpTables::Compressible(mime))
+    {
+        return;
+    }
+    files_++;
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size < minBytes_ || size > MAX_SOURCE)
+    {
+        skipped_++;
+        return;
+    }
+
+    std::string data;
+    bool loaded = false;
+    for (const Encoding &encoding : ENCODINGS)
+    {
+#ifndef WEBSERVER_BROTLI
+        if (encoding.token == "br")
+            continue;
+#endif
+        // 旁路文件已是最新时不必读原文件
+        struct stat side;
+        if (stat((path + std::string(encoding.suffix)).c_str(), &side) == 0 && NewerOrSame(side, st))
+        {
+            upToDate_++;
+            continue;
+        }
+        if (!loaded)
+        {
+            if (!ReadAll(path, size, data))
+            {
+                failed_++;
+                return;
+            }
+            loaded = true;
+        }
+        Generate_(path, data, encoding);
+    }
+}
+
+void Precompressor::Generate_(const std::string &path, const std::string &data, const Encoding &encoding)
+{
+    std::string sidecar = path + std::string(encoding.suffix);
+    std::string out;
+    bool ok = encoding.token == "gzip" ? Gzip_(data, out) : Brotli_(data, HttpTables::MimeOfPath(path).type, out);
+    if (!ok)
+    {
+        failed_++;
+        return;
+    }
+    if (out.size() >= data.size() - data.size() / 10)
+    {
+        // 收益不足：不生成，已有的旧旁路文件也删掉，免得发出过期内容
+        unlink(sidecar.c_str());
+        skipped_++;
+        return;
+    }
+    if (!Write_(sidecar, out))
+    {
+        failed_++;
+        return;
+    }
+    written_++;
+    bytesIn_ += data.size();
+    bytesOut_ += out.size();
+}
+
+bool Precompressor::Gzip_(const std::string &in, std::string &out)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // windowBits 15 + 16：带 gzip 头尾；预压缩只做一次，用最高压缩级别
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+    out.resize(deflateBound(&zs, in.size()) + 32);
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+    zs.avail_in = in.size();
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = out.size();
+    int ret = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+bool Precompressor::Brotli_(const std::string &in, std::string_view type, std::string &out)
+{
+#ifdef WEBSERVER_BROTLI
+    BrotliEncoderMode mode = BROTLI_MODE_GENERIC;
+    if (type.substr(0, 5) == "text/" || type == "application/json" || type == "image/svg+xml")
+        mode = BROTLI_MODE_TEXT;
+    else if (type.substr(0, 5) == "font/" || type == "application/vnd.ms-fontobject")
+        mode = BROTLI_MODE_FONT;
+    size_t outSize = BrotliEncoderMaxCompressedSize(in.size());
+    out.resize(outSize);
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, mode, in.size(),
+                               reinterpret_cast<const uint8_t *>(in.data()), &outSize,
+                               reinterpret_cast<uint8_t *>(&out[0])))
+    {
+        return false;
+    }
+    out.resize(outSize);
+    return true;
+#else
+    (void)in;
+    (void)type;
+    (void)out;
+    return false;
+#endif
+}
+
+bool Precompressor::Write_(const std::string &path, const std::string &data)
+{
+    std::string tmp = path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Precompress: create " << tmp << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    close(fd);
+    if (done != data.size() || rename(tmp.c_str(), path.c_str()) < 0)
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef PRECOMPRESSOR_H
+#define PRECOMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <sys/stat.h>
+
+/**
+ * @brief 预压缩：启动时为资源目录中可压缩类型的静态文件生成旁路文件 xxx.gz(编译了 brotli 时还有 xxx.br)，
+ *        请求时按 Accept-Encoding 直接发送旁路文件，不占用请求路径上的 CPU
+ *        旁路文件的修改时间不早于原文件时视为最新，跳过；压缩后节省不到 10% 的不生成(并删除旧的)
+ *        资源目录只读时生成失败，照常发送原文件
+ */
+class Precompressor
+{
+public:
+    /**
+     * @brief 一种旁路编码：Content-Encoding 的取值与旁路文件的后缀
+     */
+    struct Encoding
+    {
+        std::string_view token;
+        std::string_view suffix;
+    };
+
+    // 发送时识别的旁路编码，按优先级排列(Accept-Encoding 中 q 值相同时选前面的)；
+    // 没有编译 brotli 时不生成 .br，但仍会发送外部工具生成的 .br
+    static constexpr Encoding ENCODINGS[] = {{"br", ".br"}, {"gzip", ".gz"}};
+    static constexpr int ENCODING_COUNT = sizeof(ENCODINGS) / sizeof(ENCODINGS[0]);
+
+    /**
+     * @param minBytes 小于它的文件不压缩(压缩后的节省抵不上一次额外的 open)
+     */
+    explicit Precompressor(size_t minBytes);
+
+    /**
+     * @brief 递归处理 root 下的文件
+     */
+    void Run(const std::string &root);
+
+    /**
+     * @brief 形如 "files=12 written=10 upToDate=0 skipped=2 failed=0 bytes=500000->120000" 的统计信息
+     */
+    std::string Report() const;
+
+private:
+    // 超过它的文件不读入内存压缩
+    static const size_t MAX_SOURCE = 64 * 1024 * 1024;
+
+    /**
+     * @brief 遍历目录：跟随符号链接，按 (st_dev, st_ino) 记录进入过的目录，避免链接成环时无限递归
+     */
+    void Walk_(const std::string &dir);
+
+    /**
+     * @brief 处理一个文件：逐个编码检查旁路文件，已是最新的跳过，其余读入原文件后生成
+     */
+    void Process_(const std::string &path, const struct stat &st);
+
+    /**
+     * @brief 生成一个旁路文件，压缩收益不足时不生成并删除旧的
+     */
+    void Generate_(const std::string &path, const std::string &data, const Encoding &encoding);
+
+    static bool Gzip_(const std::string &in, std::string &out);
+    static bool Brotli_(const std::string &in, std::string_view type, std::string &out);
+
+    /**
+     * @brief 先写临时文件再 rename，发送方不会读到写了一半的旁路文件
+     */
+    static bool Write_(const std::string &path, const std::string &data);
+
+    size_t minBytes_;
+    std::set<std::pair<dev_t, ino_t>> visited_; // 已遍历的目录
+    uint64_t files_;    // 可压缩类型的文件数
+    uint64_t written_;  // 新生成的旁路文件
+    uint64_t upToDate_; // 已是最新的旁路文件
+    uint64_t skipped_;  // 太小或压缩收益不足
+    uint64_t failed_;   // 读取 / 写入失败
+    uint64_t bytesIn_;  // 新生成部分的原始字节数
+    uint64_t bytesOut_; // 新生成部分的压缩后字节数
+};
+
+#endif // PRECOMPRESSOR_H
@@ -0,0 +1,373 @@
+#include "Router.h"
+#include <iostream>
+
+/* =====================================================================
+ * RouteMatch
+ * ===================================================================== */
+
+std::string_view RouteMatch::Param(std::string_view name) const
+{
+    if (!route)
+    {
+        return std::string_view();
+    }
+    for (int i = 0; i < paramCount && i < static_cast<int>(route->params.size()); i++)
+    {
+        if (route->params[i] == name)
+        {
+            return values[i];
+        }
+    }
+    return std::string_view();
+}
+
+/* =====================================================================
+ * Router：只读匹配
+ * ===================================================================== */
+
+namespace
+{
+    struct MethodName
+    {
+        std::string_view name;
+        uint32_t bit;
+    };
+
+    const MethodName METHODS[] = {
+        {"GET", Router::M_GET},
+        {"HEAD", Router::M_HEAD},
+        {"POST", Router::M_POST},
+        {"PUT", Router::M_PUT},
+        {"DELETE", Router::M_DELETE},
+        {"PATCH", Router::M_PATCH},
+        {"OPTIONS", Router::M_OPTIONS},
+    };
+}
+
+uint32_t Router::MethodOf(std::string_view method)
+{
+    for (const MethodName &m : METHODS)
+    {
+        if (m.name == method)
+        {
+            return m.bit;
+        }
+    }
+    return 0;
+}
+
+std::string Router::AllowOf(uint32_t methods)
+{
+    // 能 GET 的路径也能 HEAD
+    if (methods & M_GET)
+    {
+        methods |= M_HEAD;
+    }
+    std::string allow;
+    for (const MethodName &m : METHODS)
+    {
+        if (methods & m.bit)
+        {
+            if (!allow.empty())
+                allow += ", ";
+            allow.append(m.name.data(), m.name.size());
+        }
+    }
+    return allow;
+}
+
+bool Router::Match(uint32_t method, std::string_view path, RouteMatch &match) const
+{
+    match.route = nullptr;
+    match.allow = 0;
+    match.paramCount = 0;
+    if (nodes_.empty())
+    {
+        return false;
+    }
+    return Match_(0, path, method, match);
+}
+
+bool Router::Accept_(const Node &node, uint32_t method, RouteMatch &match) const
+{
+    const Route *fallback = nullptr;
+    for (uint32_t i = node.routeBegin; i < node.routeEnd; i++)
+    {
+        const Route &route = routes_[nodeRoutes_[i]];
+        match.allow |= route.methods;
+        if (route.methods & method)
+        {
+            match.route = &route;
+            return true;
+        }
+        if (method == M_HEAD && (route.methods & M_GET))
+        {
+            fallback = &route;
+        }
+    }
+    match.route = fallback;
+    return fallback != nullptr;
+}
+
+bool Router::Match_(uint32_t idx, std::string_view rest, uint32_t method, RouteMatch &match) const
+{
+    const Node &node = nodes_[idx];
+    if (rest.empty())
+    {
+        if (Accept_(node, method, match))
+        {
+            return true;
+        }
+    }
+    else
+    {
+        // 1. 静态子节点：首字符各不相同，最多一个候选
+        for (uint32_t c = node.childBegin; c < node.childEnd; c++)
+        {
+            const Node &child = nodes_[c];
+            if (labels_[child.labelOff] != rest[0])
+            {
+                continue;
+            }
+            if (rest.size() >= child.labelLen &&
+                rest.compare(0, child.labelLen, labels_, child.labelOff, child.labelLen) == 0 &&
+                Match_(c, rest.substr(child.labelLen), method, match))
+            {
+                return true;
+            }
+            break;
+        }
+
+        // 2. 参数：匹配到下一个 '/' 为止
+        if (node.param >= 0 && match.paramCount < RouteMatch::MAX_PARAMS)
+        {
+            std::string_view segment = rest.substr(0, rest.find('/'));
+            if (!segment.empty() && SafeTail_(segment))
+            {
+                match.values[match.paramCount++] = segment;
+                if (Match_(node.param, rest.substr(segment.size()), method, match))
+                {
+                    return true;
+                }
+                match.paramCount--;
+            }
+        }
+    }
+
+    // 3. 通配：匹配剩余部分(可以为空)
+    if (node.catchAll >= 0 && match.paramCount < RouteMatch::MAX_PARAMS && SafeTail_(rest))
+    {
+        match.values[match.paramCount++] = rest;
+        if (Accept_(nodes_[node.catchAll], method, match))
+        {
+            return true;
+        }
+        match.paramCount--;
+    }
+    return false;
+}
+
+bool Router::SafeTail_(std::string_view tail)
+{
+    if (tail.find('\0') != std::string_view::npos)
+    {
+        return false;
+    }
+    while (true)
+    {
+        size_t slash = tail.find('/');
+        std::string_view segment = tail.substr(0, slash);
+        if (segment == "." || segment == "..")
+        {
+            return false;
+        }
+        if (slash == std::string_view::npos)
+        {
+            return true;
+        }
+        tail.remove_prefix(slash + 1);
+    }
+}
+
+/* =====================================================================
+ * RouterBuilder：注册 / 冻结
+ * ===================================================================== */
+
+RouterBuilder::RouterBuilder() = default;
+
+RouterBuilder::~RouterBuilder() = default;
+
+bool RouterBuilder::AddStatic(uint32_t methods, std::string_view pattern, std::string file)
+{
+    Route route{methods, Route::STATIC, false, false, 200, std::move(file), nullptr, {}};
+    return Add_(pattern, std::move(route));
+}
+
+bool RouterBuilder::AddRedirect(uint32_t methods, std::string_view pattern, std::string location, int code)
+{
+    Route route{methods, Route::REDIRECT, false, false, code, std::move(location), nullptr, {}};
+    return Add_(pattern, std::move(route));
+}
+
+bool RouterBuilder::AddHandler(uint32_t methods, std::string_view pattern, RouteHandler handler, bool blocking)
+{
+    Route route{methods, Route::CALLBACK, blocking, false, 200, std::string(), std::move(handler), {}};
+    return Add_(pattern, std::move(route));
+}
+
+bool RouterBuilder::Add_(std::string_view pattern, Route route)
+{
+    if (pattern.empty() || pattern[0] != '/' || route.methods == 0)
+    {
+        std::cerr << "Router: invalid route " << pattern << std::endl;
+        return false;
+    }
+
+    // 模式拆成 静态段 / :参数 / *通配，依次插入
+    Node *node = &root_;
+    size_t pos = 0;
+    while (pos < pattern.size())
+    {
+        char ch = pattern[pos];
+        bool segmentStart = pos > 0 && pattern[pos - 1] == '/';
+        if (segmentStart && (ch == ':' || ch == '*'))
+        {
+            size_t end = pattern.find('/', pos);
+            if (end == std::string_view::npos)
+                end = pattern.size();
+            std::string_view name = pattern.substr(pos + 1, end - pos - 1);
+            if (name.empty() || (ch == '*' && end != pattern.size()) ||
+                route.params.size() >= static_cast<size_t>(RouteMatch::MAX_PARAMS))
+            {
+                std::cerr << "Router: invalid route " << pattern << std::endl;
+                return false;
+            }
+            route.params.emplace_back(name);
+            std::unique_ptr<Node> &next = ch == ':' ? node->param : node->catchAll;
+            if (!next)
+            {
+                next.reset(new Node());
+            }
+            node = next.get();
+            route.catchAll = ch == '*';
+            pos = end;
+            continue;
+        }
+        // 静态部分：到下一个参数 / 通配为止
+        size_t end = pos;
+        while (end < pattern.size() &&
+               !(end > 0 && pattern[end - 1] == '/' && (pattern[end] == ':' || pattern[end] == '*')))
+        {
+            end++;
+        }
+        node = InsertStatic_(node, pattern.substr(pos, end - pos));
+        pos = end;
+    }
+
+    for (uint32_t idx : node->routes)
+    {
+        if (routes_[idx].methods & route.methods)
+        {
+            std::cerr << "Router: duplicate route " << pattern << std::endl;
+            return false;
+        }
+    }
+    node->routes.push_back(static_cast<uint32_t>(routes_.size()));
+    routes_.push_back(std::move(route));
+    return true;
+}
+
+RouterBuilder::Node *RouterBuilder::InsertStatic_(Node *node, std::string_view s)
+{
+    while (!s.empty())
+    {
+        std::unique_ptr<Node> *slot = nullptr;
+        for (std::unique_ptr<Node> &child : node->children)
+        {
+            if (child->label[0] == s[0])
+            {
+                slot = &child;
+                break;
+            }
+        }
+        if (!slot)
+        {
+            node->children.emplace_back(new Node());
+            node->children.back()->label.assign(s.data(), s.size());
+            return node->children.back().get();
+        }
+
+        Node *child = slot->get();
+        size_t common = 0;
+        while (common < child->label.size() && common < s.size() && child->label[common] == s[common])
+        {
+            common++;
+        }
+        if (common < child->label.size())
+        {
+            // 拆分边：公共前缀成为新的中间节点
+            std::unique_ptr<Node> mid(new Node());
+            mid->label = child->label.substr(0, common);
+            child->label.erase(0, common);
+            mid->children.push_back(std::move(*slot));
+            *slot = std::move(mid);
+            child = slot->get();
+        }
+        s.remove_prefix(common);
+        node = child;
+    }
+    return node;
+}
+
+std::shared_ptr<const Router> RouterBuilder::Freeze() const
+{
+    std::shared_ptr<Router> router(new Router());
+    router->routes_ = routes_;
+    router->nodes_.resize(1);
+    Flatten_(root_, 0, *router);
+    return router;
+}
+
+void RouterBuilder::Flatten_(const Node &src, uint32_t idx, Router &router) const
+{
+    // 子节点在 nodes_ 中连续存放，先占位再递归(递归会使 nodes_ 扩容，只通过下标访问)
+    uint32_t childBegin = static_cast<uint32_t>(router.nodes_.size());
+    router.nodes_.resize(childBegin + src.children.size());
+    int32_t param = -1;
+    int32_t catchAll = -1;
+    if (src.param)
+    {
+        param = static_cast<int32_t>(router.nodes_.size());
+        router.nodes_.emplace_back();
+    }
+    if (src.catchAll)
+    {
+        catchAll = static_cast<int32_t>(router.nodes_.size());
+        router.nodes_.emplace_back();
+    }
+
+    Router::Node &dst = router.nodes_[idx];
+    dst.labelOff = static_cast<uint32_t>(router.labels_.size());
+    dst.labelLen = static_cast<uint32_t>(src.label.size());
+    router.labels_ += src.label;
+    dst.childBegin = childBegin;
+    dst.childEnd = childBegin + static_cast<uint32_t>(src.children.size());
+    dst.param = param;
+    dst.catchAll = catchAll;
+    dst.routeBegin = static_cast<uint32_t>(router.nodeRoutes_.size());
+    router.nodeRoutes_.insert(router.nodeRoutes_.end(), src.routes.begin(), src.routes.end());
+    dst.routeEnd = static_cast<uint32_t>(router.nodeRoutes_.size());
+
+    for (size_t i = 0; i < src.children.size(); i++)
+    {
+        Flatten_(*src.children[i], childBegin + static_cast<uint32_t>(i), router);
+    }
+    if (src.param)
+    {
+        Flatten_(*src.param, param, router);
+    }
+    if (src.catchAll)
+    {
+        Flatten_(*src.catchAll, catchAll, router);
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class HttpRequest;
+class HttpResponse;
+struct RouteMatch;
+
+/**
+ * @brief 路由的处理函数：可以读取请求 / 路径参数，设置响应(SetFile / SetContent / SetRedirect)
+ */
+using RouteHandler = std::function<void(HttpRequest &, const RouteMatch &, HttpResponse &)>;
+
+/**
+ * @brief 一条路由
+ */
+struct Route
+{
+    enum Kind : uint8_t
+    {
+        STATIC,   // 静态文件
+        REDIRECT, // 重定向
+        CALLBACK, // C++ 回调
+    };
+
+    uint32_t methods;   // 允许的方法(Router::Method 位掩码)
+    Kind kind;
+    bool blocking;      // 处理函数会阻塞(如查询数据库)，运行到完成模式下交给线程池
+    bool catchAll;      // 模式以 *name 结尾
+    int code;           // REDIRECT 的状态码
+    std::string target; // STATIC：文件路径(模式以 *name 结尾时在后面追加匹配到的尾部)；REDIRECT：Location
+    RouteHandler handler;
+    std::vector<std::string> params; // 参数名，按在模式中出现的顺序
+};
+
+/**
+ * @brief 一次匹配的结果：参数值指向请求路径，不分配内存
+ */
+struct RouteMatch
+{
+    static const int MAX_PARAMS = 8;
+
+    const Route *route = nullptr; // 命中的路由
+    uint32_t allow = 0;           // 路径命中过的路由允许的方法(未命中路由时非 0 => 405)
+    int paramCount = 0;
+    std::string_view values[MAX_PARAMS];
+
+    /**
+     * @brief 按名字取参数值，没有时返回空
+     */
+    std::string_view Param(std::string_view name) const;
+};
+
+/**
+ * @brief 冻结后的路由表：压缩前缀树展开成连续数组，只读，多个 Reactor 线程无锁共享
+ *        匹配顺序为 静态段 > 参数段(:name，匹配一个非空路径段) > 通配(*name，匹配剩余部分)，
+ *        前一种匹配不到路由时回退到下一种；逐字节比较路径，开销与路径长度成正比
+ *        参数与通配不绑定 "." / ".." 段：静态路由把通配的尾部拼到资源目录后面，不能越出目录
+ */
+class Router
+{
+public:
+    enum Method : uint32_t
+    {
+        M_GET = 1u << 0,
+        M_HEAD = 1u << 1,
+        M_POST = 1u << 2,
+        M_PUT = 1u << 3,
+        M_DELETE = 1u << 4,
+        M_PATCH = 1u << 5,
+        M_OPTIONS = 1u << 6,
+        M_ANY = (1u << 7) - 1,
+    };
+
+    /**
+     * @brief 按方法与路径(不含查询串)查找路由；HEAD 没有单独注册时使用 GET 的路由
+     * @return 是否命中；未命中时 match.allow 给出该路径允许的方法
+     */
+    bool Match(uint32_t method, std::string_view path, RouteMatch &match) const;
+
+    /**
+     * @brief 方法名 -> 位掩码，不认识的方法返回 0
+     */
+    static uint32_t MethodOf(std::string_view method);
+
+    /**
+     * @brief 位掩码 -> Allow 头的值，如 "GET, HEAD, POST"
+     */
+    static std::string AllowOf(uint32_t methods);
+
+private:
+    friend class RouterBuilder;
+
+    struct Node
+    {
+        uint32_t labelOff;   // 边上的静态字符在 labels_ 中的位置
+        uint32_t labelLen;
+        uint32_t childBegin; // 静态子节点 [childBegin, childEnd)，首字符各不相同
+        uint32_t childEnd;
+        int32_t param;       // 参数子节点，-1 表示没有
+        int32_t catchAll;    // 通配子节点，-1 表示没有
+        uint32_t routeBegin; // 在此结束的路由 [routeBegin, routeEnd)，下标指向 nodeRoutes_
+        uint32_t routeEnd;
+    };
+
+    bool Match_(uint32_t idx, std::string_view rest, uint32_t method, RouteMatch &match) const;
+
+    /**
+     * @brief 在节点上结束的路由中按方法选择一条
+     */
+    bool Accept_(const Node &node, uint32_t method, RouteMatch &match) const;
+
+    /**
+     * @brief 参数 / 通配的值能否拼到目录后面：不含 "." / ".." 段与 NUL
+     */
+    static bool SafeTail_(std::string_view tail);
+
+    std::vector<Node> nodes_; // nodes_[0] 为根
+    std::string labels_;
+    std::vector<uint32_t> nodeRoutes_;
+    std::vector<Route> routes_;
+};
+
+/**
+ * @brief 启动时注册路由，Freeze 得到只读的 Router
+ *        模式以 '/' 开头，以 ':' 开头的段(如 :id)匹配一个路径段，以 '*' 开头的段(如 *path)匹配剩余部分(必须在最后)
+ *        注册失败(模式非法 / 同一路径同一方法重复注册)时输出错误并返回 false
+ */
+class RouterBuilder
+{
+public:
+    RouterBuilder();
+    ~RouterBuilder();
+
+    /**
+     * @brief 静态文件：file 为相对资源目录的路径；模式以 *name 结尾时 file 作为前缀，后面追加匹配到的尾部
+     */
+    bool AddStatic(uint32_t methods, std::string_view pattern, std::string file);
+
+    /**
+     * @brief 重定向到 location
+     */
+    bool AddRedirect(uint32_t methods, std::string_view pattern, std::string location, int code = 301);
+
+    /**
+     * @brief C++ 回调；blocking 表示回调会阻塞(如查询数据库)
+     */
+    bool AddHandler(uint32_t methods, std::string_view pattern, RouteHandler handler, bool blocking = false);
+
+    /**
+     * @brief 生成只读路由表(可以多次调用)
+     */
+    std::shared_ptr<const Router> Freeze() const;
+
+private:
+    struct Node
+    {
+        std::string label;
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> param;
+        std::unique_ptr<Node> catchAll;
+        std::vector<uint32_t> routes;
+    };
+
+    bool Add_(std::string_view pattern, Route route);
+
+    /**
+     * @brief 从 node 开始插入一段静态字符，必要时拆分已有的边，返回末端节点
+     */
+    static Node *InsertStatic_(Node *node, std::string_view s);
+
+    void Flatten_(const Node &src, uint32_t idx, Router &router) const;
+
+    Node root_;
+    std::vector<Route> routes_;
+};
+
+#endif // ROUTER_H
@@ -1,8 +1,22 @@
 #include "./server/WebServer.h"
+#include "./server/HotUpgrade.h"
 #include "./log/log.hpp"
+#include <signal.h>
 
-int main()
+int main(int argc, char *argv[])
 {
+    // 在创建任何线程之前屏蔽信号，由 MasterReactor 通过 signalfd 统一处理：
+    // SIGUSR2 热升级，SIGTERM / SIGINT 排空后退出
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR2);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    // 对端提前关闭时 write 返回 EPIPE 而不是杀死进程
+    signal(SIGPIPE, SIG_IGN);
+    HotUpgrade::Init(argc, argv);
+
     // 获取配置的单例实例
     Config &config = Config::GetInstance();
 
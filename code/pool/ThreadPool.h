@@ -33,6 +33,16 @@ public:
      */
     void addTask(std::function<void()> task);
 
+    /**
+     * @brief 工作线程数量
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief 第 i 个工作线程的原生句柄(用于设置 CPU 亲和性)
+     */
+    std::thread::native_handle_type nativeHandle(size_t i) { return workers_[i].native_handle(); }
+
 private:
     /**
      * @brief 工作线程函数：不停从任务队列里取任务执行，直到收到结束信号
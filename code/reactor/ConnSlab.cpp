@@ -0,0 +1,44 @@
+#include "ConnSlab.h"
+
+ConnSlab::ConnSlab(size_t capacity)
+    : capacity_(capacity),
+      slots_(new ConnSlot[capacity])
+{
+    freeList_.reserve(capacity);
+    for (size_t i = capacity; i > 0; i--)
+    {
+        slots_[i - 1].timer.owner = &slots_[i - 1];
+        freeList_.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+ConnSlot *ConnSlab::Acquire()
+{
+    if (freeList_.empty())
+    {
+        return nullptr;
+    }
+    ConnSlot *slot = &slots_[freeList_.back()];
+    freeList_.pop_back();
+    slot->inUse = true;
+    // 分配时也加一：回收后、重新分配前投递的任务带着回收后的代数，同样要失效
+    slot->generation.fetch_add(1, std::memory_order_release);
+    return slot;
+}
+
+void ConnSlab::Release(ConnSlot *slot)
+{
+    if (!slot || !slot->inUse)
+    {
+        return;
+    }
+    slot->inUse = false;
+    slot->generation.fetch_add(1, std::memory_order_release);
+    freeList_.push_back(static_cast<uint32_t>(slot - slots_.get()));
+}
+
+bool ConnSlab::Contains(const void *ptr) const
+{
+    const ConnSlot *p = static_cast<const ConnSlot *>(ptr);
+    return p >= slots_.get() && p < slots_.get() + capacity_;
+}
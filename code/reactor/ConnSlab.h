@@ -0,0 +1,79 @@
+#ifndef CONNSLAB_H
+#define CONNSLAB_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "HttpConn.h"
+#include "TimingWheel.h"
+
+/**
+ * @brief 连接槽：一个 HttpConn 加上代数计数，按 cache line 对齐避免伪共享
+ *        epoll_event.data.ptr 直接指向槽位；
+ *        每次分配与回收 generation 都加一，投递给线程池的任务带上投递时的 generation，
+ *        执行时对不上就说明槽位已被回收(fd 可能已被新连接复用)，任务直接丢弃
+ */
+struct alignas(64) ConnSlot
+{
+    HttpConn conn;
+    std::atomic<uint32_t> generation{0};
+    bool inUse = false;
+
+    // 以下只在所属 SubReactor 线程访问
+    TimerNode timer;              // 空闲 / 读请求头 / 写停滞定时器
+    int64_t headerDeadlineMs = 0; // 当前请求头的读取期限，0 表示还没开始读请求
+    bool idle = false;            // 长连接空闲(等待下一个请求)，排空时可直接关闭
+};
+
+/**
+ * @brief 预分配的连接槽池，每个 SubReactor 一个，只在所属 SubReactor 线程分配 / 回收
+ */
+class ConnSlab
+{
+public:
+    /**
+     * @param capacity 最多容纳的连接数
+     */
+    explicit ConnSlab(size_t capacity);
+
+    /**
+     * @brief 取一个空闲槽位，generation + 1
+     * @return 槽位指针；已满返回 nullptr
+     */
+    ConnSlot *Acquire();
+
+    /**
+     * @brief 归还槽位，generation + 1 使所有在途任务失效
+     */
+    void Release(ConnSlot *slot);
+
+    /**
+     * @brief 判断指针是否指向本池中的槽位(用于区分 epoll 中的连接与控制 fd)
+     */
+    bool Contains(const void *ptr) const;
+
+    size_t Capacity() const { return capacity_; }
+    size_t InUse() const { return capacity_ - freeList_.size(); }
+
+    /**
+     * @brief 遍历所有使用中的槽位
+     */
+    template <typename Func>
+    void ForEach(Func func)
+    {
+        for (size_t i = 0; i < capacity_; i++)
+        {
+            if (slots_[i].inUse)
+                func(&slots_[i]);
+        }
+    }
+
+private:
+    size_t capacity_;
+    std::unique_ptr<ConnSlot[]> slots_;
+    std::vector<uint32_t> freeList_; // 空闲槽位下标(栈，后进先出，复用热的槽位)
+};
+
+#endif // CONNSLAB_H
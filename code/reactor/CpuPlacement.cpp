@@ -0,0 +1,172 @@
+#include "CpuPlacement.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+CpuPlacement::CpuPlacement(const std::string &cpuList, int groupCount)
+    : logger(&AsyncLogger::get_instance())
+{
+    std::vector<int> online = ParseCpuList(ReadFile_("/sys/devices/system/cpu/online"));
+    std::vector<int> cpus = cpuList.empty() ? online : ParseCpuList(cpuList);
+    if (!online.empty())
+    {
+        // 只保留在线 CPU
+        cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&online](int cpu)
+                                  { return !std::binary_search(online.begin(), online.end(), cpu); }),
+                   cpus.end());
+    }
+    if (cpus.empty() || groupCount <= 0)
+    {
+        logger->log(WARNING, "CpuPlacement: no usable cpu, affinity disabled");
+        return;
+    }
+
+    // 按 (节点, CPU 号) 排序，连续切分时同一组落在同一个节点
+    std::vector<int> cpuNode = ReadCpuNodes_();
+    auto nodeOf = [&cpuNode](int cpu)
+    { return cpu < static_cast<int>(cpuNode.size()) ? cpuNode[cpu] : -1; };
+    std::stable_sort(cpus.begin(), cpus.end(), [&nodeOf](int a, int b)
+                     { return nodeOf(a) < nodeOf(b); });
+
+    // CPU 足够时每组分到连续的若干个；不够时多个组共享 CPU
+    groups_.resize(groupCount);
+    int total = static_cast<int>(cpus.size());
+    if (total >= groupCount)
+    {
+        int begin = 0;
+        for (int i = 0; i < groupCount; i++)
+        {
+            int size = total / groupCount + (i < total % groupCount ? 1 : 0);
+            groups_[i].assign(cpus.begin() + begin, cpus.begin() + begin + size);
+            begin += size;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < groupCount; i++)
+        {
+            groups_[i].push_back(cpus[i % total]);
+        }
+    }
+
+    int maxCpu = *std::max_element(cpus.begin(), cpus.end());
+    cpuToGroup_.assign(maxCpu + 1, -1);
+    groupNodes_.resize(groupCount);
+    for (int i = 0; i < groupCount; i++)
+    {
+        for (int cpu : groups_[i])
+        {
+            if (cpuToGroup_[cpu] < 0)
+                cpuToGroup_[cpu] = i;
+        }
+        groupNodes_[i] = nodeOf(groups_[i][0]);
+        logger->log(INFO, "CpuPlacement: group " + std::to_string(i) + " node " + std::to_string(groupNodes_[i]) +
+                              " cpus " + Format(groups_[i]));
+    }
+}
+
+int CpuPlacement::GroupOfSocket(int fd) const
+{
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0 ||
+        cpu < 0 || cpu >= static_cast<int>(cpuToGroup_.size()))
+    {
+        return -1;
+    }
+    return cpuToGroup_[cpu];
+}
+
+bool CpuPlacement::Pin(pthread_t thread, const std::vector<int> &cpus)
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        CPU_SET(cpu, &set);
+    }
+    int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (ret != 0)
+    {
+        AsyncLogger::get_instance().log(WARNING, "pthread_setaffinity_np failed: " + std::to_string(ret) + " cpus " + Format(cpus));
+        return false;
+    }
+    return true;
+}
+
+std::vector<int> CpuPlacement::ParseCpuList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (item.empty() || item.find_first_of("0123456789") == std::string::npos)
+            continue;
+        size_t dash = item.find('-');
+        int first = atoi(item.c_str());
+        int last = dash == std::string::npos ? first : atoi(item.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string CpuPlacement::Format(const std::vector<int> &cpus)
+{
+    std::string out;
+    for (size_t i = 0; i < cpus.size(); i++)
+    {
+        if (i)
+            out += ",";
+        out += std::to_string(cpus[i]);
+    }
+    return out;
+}
+
+std::vector<int> CpuPlacement::ReadCpuNodes_()
+{
+    std::vector<int> cpuNode;
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (!dir)
+    {
+        return cpuNode; // 未开启 NUMA：所有 CPU 视为同一节点
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (strncmp(entry->d_name, "node", 4) != 0 || entry->d_name[4] < '0' || entry->d_name[4] > '9')
+            continue;
+        int node = atoi(entry->d_name + 4);
+        std::string path = std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist";
+        for (int cpu : ParseCpuList(ReadFile_(path)))
+        {
+            if (cpu >= static_cast<int>(cpuNode.size()))
+                cpuNode.resize(cpu + 1, -1);
+            cpuNode[cpu] = node;
+        }
+    }
+    closedir(dir);
+    return cpuNode;
+}
+
+std::string CpuPlacement::ReadFile_(const std::string &path)
+{
+    std::ifstream in(path);
+    std::string content;
+    std::getline(in, content);
+    return content;
+}
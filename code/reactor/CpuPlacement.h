@@ -0,0 +1,73 @@
+#ifndef CPUPLACEMENT_H
+#define CPUPLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "log.hpp"
+
+/**
+ * @brief CPU / NUMA 拓扑与线程放置
+ *        把可用 CPU 按 NUMA 节点排序后切成 groupCount 组，第 i 组给第 i 个 SubReactor
+ *        (以及编号 j % groupCount == i 的工作线程)，同一组尽量落在同一个节点上；
+ *        同时维护 CPU -> 组号的映射，供 reuseport CBPF 分流与主从模式下按 SO_INCOMING_CPU 分派使用
+ *        拓扑来自 /sys/devices/system，不依赖 libnuma
+ */
+class CpuPlacement
+{
+public:
+    /**
+     * @param cpuList    可用 CPU 列表("0-3,8")，空表示所有在线 CPU
+     * @param groupCount 分组数(SubReactor 个数)
+     */
+    CpuPlacement(const std::string &cpuList, int groupCount);
+
+    int GroupCount() const { return static_cast<int>(groups_.size()); }
+
+    // 第 i 组的 CPU
+    const std::vector<int> &Group(int i) const { return groups_[i]; }
+
+    // 第 i 组所在的 NUMA 节点(未知为 -1)
+    int NodeOfGroup(int i) const { return groupNodes_[i]; }
+
+    /**
+     * @brief CPU -> 组号表，下标为 CPU 号，不在任何组中的 CPU 为 -1
+     */
+    const std::vector<int> &CpuToGroup() const { return cpuToGroup_; }
+
+    /**
+     * @brief 按连接最后一次被哪个 CPU 处理软中断(SO_INCOMING_CPU)返回组号
+     * @return 组号；无法判断返回 -1
+     */
+    int GroupOfSocket(int fd) const;
+
+    /**
+     * @brief 把线程绑定到一组 CPU
+     */
+    static bool Pin(pthread_t thread, const std::vector<int> &cpus);
+
+    /**
+     * @brief 解析 "0-3,8" 形式的 CPU 列表
+     */
+    static std::vector<int> ParseCpuList(const std::string &list);
+
+    /**
+     * @brief 把 CPU 列表格式化为 "0,1,2" 用于日志
+     */
+    static std::string Format(const std::vector<int> &cpus);
+
+private:
+    // CPU -> NUMA 节点，读取 /sys/devices/system/node/node*/cpulist
+    static std::vector<int> ReadCpuNodes_();
+    // 读取整个小文件(sysfs)，失败返回空串
+    static std::string ReadFile_(const std::string &path);
+
+private:
+    std::vector<std::vector<int>> groups_;
+    std::vector<int> groupNodes_;
+    std::vector<int> cpuToGroup_;
+
+    AsyncLogger *logger;
+};
+
+#endif // CPUPLACEMENT_H
@@ -0,0 +1,271 @@
+#include "Listener.h"
+#include "config.h"
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <iostream>
+#include <netinet/tcp.h>  // TCP_DEFER_ACCEPT / TCP_FASTOPEN
+#include <linux/filter.h> // sock_filter / SKF_AD_CPU
+
+Listener::Listener(int port, bool reusePort)
+    : port_(port),
+      listenFd_(-1),
+      reusePort_(reusePort),
+      reserveFd_(-1),
+      accepted_(0),
+      fdExhausted_(0),
+      shed_(0),
+      aborted_(0),
+      otherErrors_(0),
+      logger(&AsyncLogger::get_instance())
+{
+    Config &config = Config::GetInstance();
+    backlog_ = config.GetListenBacklog();
+    deferAcceptSec_ = config.GetDeferAcceptSec();
+    fastOpenQueue_ = config.GetFastOpenQueue();
+}
+
+Listener::~Listener()
+{
+    if (listenFd_ >= 0)
+    {
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+    if (reserveFd_ >= 0)
+    {
+        close(reserveFd_);
+        reserveFd_ = -1;
+    }
+}
+
+bool Listener::Init()
+{
+    // 直接创建非阻塞 socket，省掉之后的 fcntl
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0)
+    {
+        std::cerr << "Create socket error!\n";
+        logger->log(ERROR, "Create socket error!");
+        return false;
+    }
+
+    // 端口复用
+    int optval = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+
+    // 多个 socket 绑定同一端口，由内核把连接分摊到各个 socket 的 accept 队列
+    if (reusePort_ && setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0)
+    {
+        std::cerr << "Set SO_REUSEPORT error!\n";
+        logger->log(ERROR, "Set SO_REUSEPORT error!");
+        return false;
+    }
+
+    // 绑定地址
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port_);
+
+    if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        std::cerr << "Bind error!\n";
+        logger->log(ERROR, "Bind error!");
+        return false;
+    }
+
+    // 连接上有数据到达(或超时)才放进 accept 队列，空连接不会唤醒 Reactor
+    if (deferAcceptSec_ > 0 &&
+        setsockopt(listenFd_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &deferAcceptSec_, sizeof(deferAcceptSec_)) < 0)
+    {
+        logger->log(WARNING, "Set TCP_DEFER_ACCEPT failed, errno: " + std::to_string(errno));
+    }
+
+    // TCP Fast Open：SYN 中携带的请求数据可以在握手完成前交给应用
+    if (fastOpenQueue_ > 0)
+    {
+        if (setsockopt(listenFd_, IPPROTO_TCP, TCP_FASTOPEN, &fastOpenQueue_, sizeof(fastOpenQueue_)) < 0)
+        {
+            logger->log(WARNING, "Set TCP_FASTOPEN failed, errno: " + std::to_string(errno));
+        }
+        else if ((ReadSysctl_("/proc/sys/net/ipv4/tcp_fastopen") & 2) == 0)
+        {
+            // 服务端需要 net.ipv4.tcp_fastopen 的第 2 位
+            logger->log(WARNING, "TCP_FASTOPEN set but net.ipv4.tcp_fastopen does not enable server side");
+        }
+    }
+
+    // backlog 超过 somaxconn 时内核会静默截断
+    int somaxconn = ReadSysctl_("/proc/sys/net/core/somaxconn");
+    if (somaxconn > 0 && backlog_ > somaxconn)
+    {
+        std::cerr << "listen backlog " << backlog_ << " exceeds net.core.somaxconn " << somaxconn << "\n";
+        logger->log(WARNING, "listen backlog " + std::to_string(backlog_) + " truncated to net.core.somaxconn " + std::to_string(somaxconn));
+    }
+
+    if (listen(listenFd_, backlog_) < 0)
+    {
+        std::cerr << "Listen error!\n";
+        logger->log(ERROR, "Listen error!");
+        return false;
+    }
+
+    // 预留一个 fd，fd 耗尽时用来接下并关闭连接
+    reserveFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return true;
+}
+
+bool Listener::Adopt(int fd)
+{
+    int listening = 0;
+    socklen_t len = sizeof(listening);
+    if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &len) < 0 || !listening)
+    {
+        std::cerr << "Adopt listen fd error!\n";
+        logger->log(ERROR, "Adopt listen fd " + std::to_string(fd) + " error: not a listening socket");
+        return false;
+    }
+    listenFd_ = fd;
+    // 与旧进程共享同一个打开文件描述，O_NONBLOCK 已在旧进程设置，这里再确认一次
+    fcntl(listenFd_, F_SETFL, fcntl(listenFd_, F_GETFL) | O_NONBLOCK);
+    reserveFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return true;
+}
+
+bool Listener::SetIncomingCpu(int cpu)
+{
+    if (setsockopt(listenFd_, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) < 0)
+    {
+        logger->log(WARNING, "Set SO_INCOMING_CPU failed, errno: " + std::to_string(errno));
+        return false;
+    }
+    return true;
+}
+
+int Listener::Accept(sockaddr_in *addr)
+{
+    while (true)
+    {
+        socklen_t len = sizeof(*addr);
+        int fd = accept4(listenFd_, (sockaddr *)addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            accepted_++;
+            return fd;
+        }
+
+        switch (errno)
+        {
+        case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+        case EWOULDBLOCK:
+#endif
+            return -1; // 队列已空
+        case EINTR:
+        case ECONNABORTED:
+        case EPROTO:
+            // 握手完成前对端已断开等瞬时错误，继续取下一个
+            aborted_++;
+            continue;
+        case EMFILE:
+        case ENFILE:
+        {
+            fdExhausted_++;
+            int err = errno;
+            if (ShedOne_())
+            {
+                continue;
+            }
+            errno = err;
+            return -1;
+        }
+        default:
+            otherErrors_++;
+            return -1;
+        }
+    }
+}
+
+bool Listener::ShedOne_()
+{
+    if (reserveFd_ < 0)
+    {
+        return false;
+    }
+    close(reserveFd_);
+    reserveFd_ = -1;
+
+    int fd = accept(listenFd_, nullptr, nullptr);
+    if (fd >= 0)
+    {
+        close(fd);
+        shed_++;
+    }
+    reserveFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    // 没能接下连接(或已被别的线程抢走)时不再重试，交给下一次可读事件
+    return fd >= 0;
+}
+
+int Listener::ReadSysctl_(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        return -1;
+    }
+    int value = -1;
+    if (fscanf(fp, "%d", &value) != 1)
+    {
+        value = -1;
+    }
+    fclose(fp);
+    return value;
+}
+
+std::string Listener::Report() const
+{
+    return "accepted=" + std::to_string(accepted_) +
+           " fdExhausted=" + std::to_string(fdExhausted_) +
+           " shed=" + std::to_string(shed_) +
+           " aborted=" + std::to_string(aborted_) +
+           " otherErrors=" + std::to_string(otherErrors_);
+}
+
+bool Listener::AttachReuseportCbpf(int fd, int groupSize, const std::vector<int> &cpuToIndex)
+{
+    if (fd < 0 || groupSize <= 0)
+        return false;
+
+    // A = 当前 CPU 号
+    std::vector<struct sock_filter> code;
+    code.push_back({BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU)});
+    // 查表：if (A == cpu) return index
+    for (size_t cpu = 0; cpu < cpuToIndex.size(); cpu++)
+    {
+        if (cpuToIndex[cpu] < 0 || cpuToIndex[cpu] >= groupSize)
+            continue;
+        code.push_back({BPF_JMP | BPF_JEQ | BPF_K, 0, 1, static_cast<__u32>(cpu)});
+        code.push_back({BPF_RET | BPF_K, 0, 0, static_cast<__u32>(cpuToIndex[cpu])});
+    }
+    // 未映射的 CPU：A = A % groupSize; return A
+    code.push_back({BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<__u32>(groupSize)});
+    code.push_back({BPF_RET | BPF_A, 0, 0, 0});
+    if (code.size() > BPF_MAXINSNS)
+    {
+        AsyncLogger::get_instance().log(WARNING, "SO_REUSEPORT CBPF program too long");
+        return false;
+    }
+
+    struct sock_fprog prog;
+    prog.len = static_cast<unsigned short>(code.size());
+    prog.filter = code.data();
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0)
+    {
+        AsyncLogger::get_instance().log(WARNING, "Attach SO_REUSEPORT CBPF failed, errno: " + std::to_string(errno));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef LISTENER_H
+#define LISTENER_H
+
+#include <netinet/in.h> // sockaddr_in
+#include <sys/socket.h>
+#include <unistd.h> // close
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "log.hpp"
+
+/**
+ * @brief 监听套接字封装：创建 / 绑定 / 监听 / accept
+ *        - 主从模式下只有 MasterReactor 持有一个 Listener
+ *        - SO_REUSEPORT 模式下每个 SubReactor 各自持有一个 Listener，由内核分摊新连接
+ *        - backlog / TCP_DEFER_ACCEPT / TCP_FASTOPEN 由配置 server 段决定
+ *        - Accept 只在持有者线程调用，错误计数不需要加锁
+ */
+class Listener
+{
+public:
+    /**
+     * @param port      监听端口
+     * @param reusePort 是否开启 SO_REUSEPORT(多个 socket 绑定同一端口)
+     */
+    Listener(int port, bool reusePort = false);
+    ~Listener();
+
+    /**
+     * @brief 创建非阻塞 socket 并 bind + listen，按配置开启 TCP_DEFER_ACCEPT / TCP_FASTOPEN
+     * @return 成功返回 true
+     */
+    bool Init();
+
+    /**
+     * @brief 接管一个已在监听的 socket(热升级时从旧进程继承)，选项沿用旧进程的设置
+     * @return fd 不是监听中的 TCP socket 时返回 false
+     */
+    bool Adopt(int fd);
+
+    /**
+     * @brief 接受一个新连接，新 fd 已带 O_NONBLOCK | O_CLOEXEC，调用方无需再 fcntl
+     *        ECONNABORTED 等瞬时错误在内部重试；EMFILE / ENFILE 时借用预留 fd
+     *        把队首连接接下来立即关闭，避免边缘触发下监听 fd 一直可读而空转
+     * @param addr 输出客户端地址
+     * @return 新连接 fd；队列已空(EAGAIN)或出错返回 -1，errno 保留
+     */
+    int Accept(sockaddr_in *addr);
+
+    /**
+     * @brief 记录一个不经 Accept 接下的连接(由 Poller 的 multishot accept 交来)，只用于统计
+     */
+    void OnAccepted() { accepted_++; }
+
+    /**
+     * @brief 设置 SO_INCOMING_CPU：reuseport 组在没有 BPF 程序时优先把该 CPU 上收到的连接交给本 socket
+     */
+    bool SetIncomingCpu(int cpu);
+
+    /**
+     * @brief 返回 accept 统计信息(已接受数 / 各类错误数)，用于退出时打印日志
+     */
+    std::string Report() const;
+
+    /**
+     * @brief 返回监听 fd
+     */
+    int GetFd() const { return listenFd_; }
+
+    /**
+     * @brief 给 SO_REUSEPORT 组挂载 CBPF 程序：按处理软中断的 CPU 号选择 socket
+     *        (返回值为组内第几个 socket：cpuToIndex 中有映射的 CPU 查表，其余为 cpu % groupSize)
+     * @param fd         组内任意一个监听 fd
+     * @param groupSize  组内 socket 数量
+     * @param cpuToIndex CPU -> 组内下标(-1 表示未映射)，与线程绑核保持一致；为空时全部取模
+     * @return 成功返回 true
+     */
+    static bool AttachReuseportCbpf(int fd, int groupSize, const std::vector<int> &cpuToIndex = std::vector<int>());
+
+private:
+    // fd 耗尽时丢弃队首连接：释放预留 fd -> accept -> close -> 重新预留
+    bool ShedOne_();
+    // 读取 /proc/sys 下的整数参数，失败返回 -1
+    static int ReadSysctl_(const char *path);
+
+private:
+    int port_;
+    int listenFd_;
+    bool reusePort_;
+    int backlog_;
+    int deferAcceptSec_;
+    int fastOpenQueue_;
+    // 预留的空闲 fd(打开 /dev/null)，fd 耗尽时临时让出
+    int reserveFd_;
+
+    // accept 统计
+    uint64_t accepted_;
+    uint64_t fdExhausted_; // EMFILE / ENFILE
+    uint64_t shed_;        // 因 fd 耗尽被直接关闭的连接
+    uint64_t aborted_;     // ECONNABORTED / EPROTO / EINTR 等可重试错误
+    uint64_t otherErrors_;
+
+    AsyncLogger *logger;
+};
+
+#endif // LISTENER_H
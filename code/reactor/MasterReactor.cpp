@@ -4,33 +4,93 @@ MasterReactor::MasterReactor(int port, int subReactorCnt)
     : port_(port),
       listenFd_(-1),
       isRunning_(false),
-      epoller_(std::make_unique<Epoll>()),
+      reusePort_(false),
+      epoller_(Poller::Create(Config::GetInstance().GetPoller())),
+      signalFd_(-1),
+      draining_(false),
+      drainDeadlineMs_(0),
       logger(&AsyncLogger::get_instance()),
       config(&Config::GetInstance()) // 获取配置的单例实例
 {
-    // 1. 初始化监听套接字
-    InitSocket_();
+    reusePort_ = (config->GetAcceptMode() == "reuseport");
+
+    waiter_ = std::make_unique<WaitStrategy>(WaitStrategy::ParseMode(config->GetWaitStrategy()),
+                                             config->GetSpinBudgetUs(), config->GetBusyPollUs());
+    waiter_->Attach(*epoller_);
 
     // 初始化线程池
     // threadPool_ = std::make_shared<ThreadPool>(8);
     threadPool_ = std::make_shared<ThreadPool>(config->GetThreadPoolNum());
 
-    // 2. 创建多个 SubReactor
+    // 1. 创建多个 SubReactor
     subReactors_.reserve(subReactorCnt);
 
     for (int i = 0; i < subReactorCnt; i++)
     {
         subReactors_.emplace_back(std::make_unique<SubReactor>(threadPool_));
     }
+
+    // 绑核：第 i 个 SubReactor 与编号 j % n == i 的工作线程共用第 i 组 CPU
+    if (config->GetAffinityEnabled())
+    {
+        placement_ = std::make_unique<CpuPlacement>(config->GetAffinityCpus(), subReactorCnt);
+        if (placement_->GroupCount() == 0)
+        {
+            placement_.reset();
+        }
+    }
+    if (placement_)
+    {
+        for (int i = 0; i < subReactorCnt; i++)
+        {
+            subReactors_[i]->SetCpus(placement_->Group(i));
+        }
+        if (config->GetAffinityPinWorkers())
+        {
+            for (size_t j = 0; j < threadPool_->size(); j++)
+            {
+                CpuPlacement::Pin(threadPool_->nativeHandle(j), placement_->Group(j % subReactorCnt));
+            }
+        }
+    }
+
+    // 2. 初始化监听套接字：reuseport 模式下由每个 SubReactor 各自监听
+    //    由旧进程热升级拉起时直接接管继承的监听 socket
+    std::vector<int> inherited = HotUpgrade::TakeInheritedFds();
+    if (reusePort_)
+    {
+        InitReusePort_(inherited);
+    }
+    else
+    {
+        InitSocket_(inherited);
+    }
+
+    // 3. 信号改由事件循环处理(main 已在创建线程前屏蔽这些信号)
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR2);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    signalFd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFd_ >= 0)
+    {
+        epoller_->AddFd(signalFd_, EPOLLIN);
+    }
+    else
+    {
+        logger->log(WARNING, "signalfd failed, hot upgrade disabled, errno: " + std::to_string(errno));
+    }
 }
 
 MasterReactor::~MasterReactor()
 {
-    // 停止并回收资源
+    // 停止并回收资源(listener_ 析构时关闭监听 fd)
     stop();
-    if (listenFd_ >= 0)
+    if (signalFd_ >= 0)
     {
-        close(listenFd_);
+        close(signalFd_);
+        signalFd_ = -1;
     }
 }
 
@@ -46,10 +106,15 @@ void MasterReactor::run()
                                  });
     }
 
-    // 主线程在此不断 epoll_wait，处理新连接
+    // 所有 Reactor 都已开始工作：若由旧进程拉起，通知它停止 accept
+    HotUpgrade::NotifyReady();
+
+    // 主线程在此 epoll_wait，处理新连接与信号
+    // reuseport 模式下主线程没有监听 fd，只会被信号或 stop() 唤醒
     while (isRunning_)
     {
-        int eventCount = epoller_->Wait(0);
+        // 排空中定期检查 SubReactor 是否已经退出
+        int eventCount = waiter_->Wait(*epoller_, draining_ ? 100 : -1);
         if (eventCount < 0)
         {
             if (errno == EINTR)
@@ -66,16 +131,64 @@ void MasterReactor::run()
             int fd = epoller_->GetEventFd(i);
             uint32_t events = epoller_->GetEvents(i);
 
+            if (fd == waiter_->GetWakeupFd())
+            {
+                waiter_->ConsumeWakeup();
+                continue;
+            }
+
+            if (fd == signalFd_)
+            {
+                HandleSignal_();
+                continue;
+            }
+
             if (fd == listenFd_ && (events & EPOLLIN))
             {
-                HandleListen_(); // 处理新连接
+                // io_uring 的 multishot accept 直接交来新连接，否则自己 accept 到 EAGAIN
+                int clientFd = epoller_->GetAcceptedFd(i);
+                if (clientFd >= 0)
+                {
+                    listener_->OnAccepted();
+                    DispatchConn_(clientFd, sockaddr_in{});
+                }
+                else
+                {
+                    HandleListen_(); // 处理新连接
+                }
             }
             // MasterReactor 只处理 listenFd，其他 fd 不在这里管
         }
+
+        if (draining_)
+        {
+            bool drained = true;
+            for (auto &sub : subReactors_)
+            {
+                drained = drained && sub->IsDrained();
+            }
+            if (drained)
+            {
+                logger->log(INFO, "MasterReactor drained");
+                break;
+            }
+            if (TimingWheel::NowMs() >= drainDeadlineMs_)
+            {
+                logger->log(WARNING, "MasterReactor drain timeout, closing remaining connections");
+                break;
+            }
+        }
     }
 
     // 若跳出循环表示 isRunning_ = false 或出错
     // 在 stop() 里还会回收 SubReactor 线程
+    logger->log(INFO, "MasterReactor exit: " + waiter_->Report());
+    if (listener_)
+    {
+        logger->log(INFO, "MasterReactor listener: " + listener_->Report());
+    }
+    logger->log(INFO, "FileCache: " + FileCache::Instance().Report());
+    logger->log(INFO, "Compressor: " + Compressor::Report());
 }
 
 void MasterReactor::stop()
@@ -84,6 +197,7 @@ void MasterReactor::stop()
     if (!isRunning_)
         return;
     isRunning_ = false;
+    waiter_->Wakeup();
 
     // 让每个 SubReactor 也停下
     for (auto &sub : subReactors_)
@@ -102,59 +216,76 @@ void MasterReactor::stop()
     subThreads_.clear();
 }
 
-void MasterReactor::InitSocket_()
+void MasterReactor::InitSocket_(const std::vector<int> &inherited)
 {
-    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (listenFd_ < 0)
+    std::cout << "port: " << port_ << std::endl;
+
+    listener_ = std::make_unique<Listener>(port_);
+    if (!(inherited.empty() ? listener_->Init() : listener_->Adopt(inherited[0])))
     {
-        std::cerr << "Create socket error!\n";
-        logger->log(ERROR, "Create socket error!");
         exit(EXIT_FAILURE);
     }
+    // 旧进程为 reuseport 模式时会交来多个 fd，主从模式只需要一个
+    for (size_t i = 1; i < inherited.size(); i++)
+    {
+        close(inherited[i]);
+    }
+    listenFd_ = listener_->GetFd();
 
-    // 端口复用
-    int optval = 1;
-    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    // 优先由 Poller 代为 accept(io_uring)，不支持时监听可读事件
+    if (epoller_->AddAcceptor(listenFd_) < 0)
+    {
+        epoller_->AddFd(listenFd_, EPOLLIN | EPOLLET);
+    }
 
-    // 绑定地址
-    sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port_);
+    std::cout << "[MasterReactor] Listen at port " << port_ << "\n";
+    logger->log(INFO, "webserver runing port: " + std::to_string(port_));
+}
 
+void MasterReactor::InitReusePort_(const std::vector<int> &inherited)
+{
     std::cout << "port: " << port_ << std::endl;
 
-    if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) < 0)
+    // 继承的 fd 按顺序交给各 SubReactor，不够的新建(加入同一个 reuseport 组)
+    for (size_t i = 0; i < subReactors_.size(); i++)
     {
-        std::cerr << "Bind error!\n";
-        logger->log(ERROR, "Bind error!");
-        exit(EXIT_FAILURE);
+        int fd = i < inherited.size() ? inherited[i] : -1;
+        if (!subReactors_[i]->Listen(port_, fd))
+        {
+            std::cerr << "SubReactor listen error!\n";
+            logger->log(ERROR, "SubReactor listen error!");
+            exit(EXIT_FAILURE);
+        }
     }
 
-    if (listen(listenFd_, 1024) < 0)
+    // SubReactor 比旧进程少：多余的 socket 关闭后其队列中的连接会被重置
+    for (size_t i = subReactors_.size(); i < inherited.size(); i++)
     {
-        std::cerr << "Listen error!\n";
-        logger->log(ERROR, "Listen error!");
-        exit(EXIT_FAILURE);
+        close(inherited[i]);
     }
 
-    epoller_->AddFd(listenFd_, EPOLLIN | EPOLLET);
-    // 设置非阻塞
-    fcntl(listenFd_, F_SETFL, fcntl(listenFd_, F_GETFL) | O_NONBLOCK);
+    // 所有 socket 都加入 reuseport 组之后再挂分流程序，
+    // 程序返回值是组内下标，即 subReactors_ 的下标
+    if (config->GetReusePortSteering() == "cbpf")
+    {
+        // 绑核时按 CPU -> SubReactor 表分流，连接落在处理其软中断的 CPU 所属的 SubReactor
+        std::vector<int> cpuToIndex = placement_ ? placement_->CpuToGroup() : std::vector<int>();
+        if (Listener::AttachReuseportCbpf(subReactors_[0]->GetListenFd(), static_cast<int>(subReactors_.size()), cpuToIndex))
+        {
+            logger->log(INFO, "SO_REUSEPORT CBPF steering attached");
+        }
+    }
 
-    std::cout << "[MasterReactor] Listen at port " << port_ << "\n";
-    logger->log(INFO, "webserver runing port: " + std::to_string(port_));
+    std::cout << "[MasterReactor] " << subReactors_.size() << " SubReactors listen at port " << port_ << " (SO_REUSEPORT)\n";
+    logger->log(INFO, "webserver runing port: " + std::to_string(port_) + " (SO_REUSEPORT)");
 }
 
 void MasterReactor::HandleListen_()
 {
     sockaddr_in clientAddr;
-    socklen_t len = sizeof(clientAddr);
-
-    static int idx = 0; // 静态局部变量，用于轮询分配
     while (true)
     {
-        int clientFd = accept(listenFd_, (sockaddr *)&clientAddr, &len);
+        int clientFd = listener_->Accept(&clientAddr);
         if (clientFd < 0)
         {
             if (errno == EAGAIN || errno == EWOULDBLOCK)
@@ -169,10 +300,93 @@ void MasterReactor::HandleListen_()
                 break;
             }
         }
+        DispatchConn_(clientFd, clientAddr);
+    }
+}
+
+void MasterReactor::DispatchConn_(int clientFd, const sockaddr_in &addr)
+{
+    static int idx = 0; // 静态局部变量，用于轮询分配
 
-        // 轮询
-        idx = (idx + 1) % subReactors_.size();
-        // 分派给 subReactors_[idx]
-        subReactors_[idx]->AddConn(clientFd, clientAddr);
+    // 绑核时优先交给收到该连接的 CPU 所属的 SubReactor，否则轮询
+    int group = placement_ ? placement_->GroupOfSocket(clientFd) : -1;
+    if (group >= 0)
+    {
+        subReactors_[group]->AddConn(clientFd, addr);
+        return;
+    }
+    idx = (idx + 1) % subReactors_.size();
+    // 分派给 subReactors_[idx]
+    subReactors_[idx]->AddConn(clientFd, addr);
+}
+
+void MasterReactor::HandleSignal_()
+{
+    struct signalfd_siginfo info;
+    while (read(signalFd_, &info, sizeof(info)) == sizeof(info))
+    {
+        if (info.ssi_signo == SIGUSR2)
+        {
+            Upgrade_();
+        }
+        else
+        {
+            logger->log(INFO, "MasterReactor received signal " + std::to_string(info.ssi_signo) + ", draining");
+            BeginDrain_();
+        }
+    }
+}
+
+void MasterReactor::Upgrade_()
+{
+    if (draining_)
+    {
+        return; // 已在排空，不能再交出监听 socket
+    }
+
+    std::vector<int> fds;
+    if (reusePort_)
+    {
+        for (auto &sub : subReactors_)
+        {
+            fds.push_back(sub->GetListenFd());
+        }
+    }
+    else
+    {
+        fds.push_back(listenFd_);
+    }
+
+    logger->log(INFO, "MasterReactor hot upgrade start");
+    if (HotUpgrade::Spawn(fds, config->GetUpgradeTimeoutMs()))
+    {
+        BeginDrain_();
+    }
+}
+
+void MasterReactor::BeginDrain_()
+{
+    if (draining_)
+    {
+        return;
+    }
+    draining_ = true;
+    drainDeadlineMs_ = TimingWheel::NowMs() + config->GetDrainTimeoutMs();
+
+    // 之后的响应都带 Connection: close
+    HttpConn::isDraining.store(true);
+
+    // 停止 accept(主从模式)；reuseport 模式由各 SubReactor 自己关闭
+    if (listener_)
+    {
+        epoller_->DelFd(listenFd_);
+        logger->log(INFO, "MasterReactor listener: " + listener_->Report());
+        listener_.reset();
+        listenFd_ = -1;
+    }
+
+    for (auto &sub : subReactors_)
+    {
+        sub->Drain();
     }
 }
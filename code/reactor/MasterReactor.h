@@ -8,17 +8,25 @@
 #include <netinet/in.h>
 #include <unistd.h> // close
 #include <fcntl.h>  // fcntl
+#include <signal.h>
+#include <sys/signalfd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <iostream>
 
-#include "Epoll.h"
+#include "Poller.h"
+#include "Listener.h"
+#include "WaitStrategy.h"
 #include "SubReactor.h"
+#include "CpuPlacement.h"
 #include "config.h"
 #include "HttpConn.h"
+#include "HotUpgrade.h"
 
 /**
  * @brief 主 Reactor，监听 listenFd，接受新连接，并分配给多条 SubReactor
+ *        同时通过 signalfd 处理信号：SIGUSR2 热升级，SIGTERM / SIGINT 优雅退出
+ *        (信号需要在创建任何线程之前由 main 屏蔽)
  */
 class MasterReactor
 {
@@ -41,19 +49,37 @@ public:
     void stop();
 
 private:
-    void InitSocket_();
+    // inherited 为热升级时从旧进程继承的监听 fd，普通启动为空
+    void InitSocket_(const std::vector<int> &inherited);
+    void InitReusePort_(const std::vector<int> &inherited);
     void HandleListen_();
+    // 把新连接交给 SubReactor：绑核时按收到连接的 CPU 选择，否则轮询
+    void DispatchConn_(int clientFd, const sockaddr_in &addr);
+    void HandleSignal_();
+    // 拉起新进程并交出监听 socket，成功后开始排空
+    void Upgrade_();
+    // 停止 accept，通知所有 SubReactor 排空
+    void BeginDrain_();
 
 private:
     int port_;
     int listenFd_;
-    bool isRunning_;
+    std::atomic<bool> isRunning_;
+    bool reusePort_; // true: 每个 SubReactor 自己 accept，主 Reactor 不再监听
 
-    std::unique_ptr<Epoll> epoller_;
+    std::unique_ptr<Listener> listener_; // 主从模式下的监听 socket
+
+    std::unique_ptr<Poller> epoller_; // epoll 或 io_uring，由配置 reactor.poller 决定
+    std::unique_ptr<WaitStrategy> waiter_; // 等待策略，stop() 通过它唤醒主循环
+    int signalFd_;                         // SIGUSR2 / SIGTERM / SIGINT
+
+    bool draining_;           // 排空中：不再 accept，等待 SubReactor 连接归零
+    int64_t drainDeadlineMs_; // 排空截止时间，超时直接退出
 
     std::vector<std::unique_ptr<SubReactor>> subReactors_; // 多个子 Reactor
     std::vector<std::thread> subThreads_;                  // 子 Reactor 对应的线程
     std::shared_ptr<ThreadPool> threadPool_;               // 线程池
+    std::unique_ptr<CpuPlacement> placement_;              // 绑核方案(未开启时为空)
 
     AsyncLogger *logger;
 
@@ -0,0 +1,108 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief 有界无锁队列：多生产者 / 单消费者
+ *        每个槽位带一个序号，生产者用 CAS 抢占 tail_，消费者独占 head_。
+ *        容量向上取整为 2 的幂。
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+    explicit MpscQueue(size_t capacity)
+        : mask_(RoundUpPow2_(capacity) - 1),
+          cells_(new Cell[mask_ + 1]),
+          tail_(0),
+          head_(0)
+    {
+        for (size_t i = 0; i <= mask_; i++)
+        {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * @brief 入队(任意线程)
+     * @return 队列已满返回 false
+     */
+    bool TryPush(T &&item)
+    {
+        Cell *cell;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // 满
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队(只能由唯一的消费者线程调用)
+     * @return 队列为空返回 false
+     */
+    bool TryPop(T &item)
+    {
+        Cell *cell = &cells_[head_ & mask_];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head_ + 1) < 0)
+        {
+            return false; // 空(或生产者还没写完)
+        }
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->seq.store(head_ + mask_ + 1, std::memory_order_release);
+        head_++;
+        return true;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    static size_t RoundUpPow2_(size_t n)
+    {
+        size_t cap = 2;
+        while (cap < n)
+            cap <<= 1;
+        return cap;
+    }
+
+    struct alignas(64) Cell
+    {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_; // 生产者共享
+    alignas(64) size_t head_;              // 仅消费者访问
+};
+
+#endif // MPSCQUEUE_H
@@ -1,24 +1,43 @@
 #include "SubReactor.h"
-#include <fcntl.h> // fcntl()
 #include <errno.h>
+#include <thread>
 #include <iostream>
 
 SubReactor::SubReactor(std::shared_ptr<ThreadPool> threadPool)
-    : epoller_(std::make_unique<Epoll>()),
+    : epoller_(Poller::Create(Config::GetInstance().GetPoller())),
+      headerTimeoutMs_(Config::GetInstance().GetHeaderTimeoutMs()),
+      keepAliveTimeoutMs_(Config::GetInstance().GetKeepAliveTimeoutSec() * 1000),
+      writeTimeoutMs_(Config::GetInstance().GetWriteTimeoutMs()),
+      bodyTimeoutMs_(Config::GetInstance().GetBodyTimeoutMs()),
+      mailbox_(Config::GetInstance().GetMailboxSize()),
+      doorbell_(false),
       threadPool_(threadPool),
+      runToCompletion_(Config::GetInstance().GetRunToCompletion()),
       isRunning_(false),
+      draining_(false),
+      drained_(false),
       logger(&AsyncLogger::get_instance())
 {
+    Config &config = Config::GetInstance();
+    waiter_ = std::make_unique<WaitStrategy>(WaitStrategy::ParseMode(config.GetWaitStrategy()),
+                                             config.GetSpinBudgetUs(), config.GetBusyPollUs());
+    waiter_->Attach(*epoller_);
+
+    timer_ = std::make_unique<TimingWheel>(
+        config.GetTimerTickMs(),
+        [this](TimerNode *node)
+        { OnTimeout_(static_cast<ConnSlot *>(node->owner)); },
+        TimingWheel::NowMs());
 }
 
 SubReactor::~SubReactor()
 {
     isRunning_ = false;
     // 在这里可做一些资源清理，如关闭所有连接
-    std::lock_guard<std::mutex> lock(users_mutex_);
-    for (auto &pair : users_)
+    if (slab_)
     {
-        pair.second.Close();
+        slab_->ForEach([](ConnSlot *slot)
+                       { slot->conn.Close(); });
     }
 }
 
@@ -26,11 +45,20 @@ SubReactor::~SubReactor()
 // 通常会在一个独立的线程里调用此函数
 void SubReactor::run()
 {
+    loopThreadId_ = std::this_thread::get_id();
+
+    // 先绑核再分配连接槽：连接、缓冲区与处理它们的线程在同一个 NUMA 节点
+    if (!cpus_.empty())
+    {
+        CpuPlacement::Pin(pthread_self(), cpus_);
+    }
+    slab_ = std::make_unique<ConnSlab>(Config::GetInstance().GetMaxConnPerReactor());
+
     isRunning_ = true;
     while (isRunning_)
     {
-        // 等待就绪事件，可自行调节超时时间，如 1000ms
-        int eventCount = epoller_->Wait(1000);
+        // 等待就绪事件，超时时间取最近的定时器；stop() 会通过 eventfd 唤醒
+        int eventCount = waiter_->Wait(*epoller_, timer_->NextTimeoutMs(TimingWheel::NowMs()));
         if (eventCount < 0)
         {
             if (errno == EINTR)
@@ -40,153 +68,458 @@ void SubReactor::run()
             break;
         }
 
-        // 处理每一个就绪事件
+        // 先推进时间轮：处理到期连接，并让本轮新设置的定时器以当前时间为起点
+        timer_->Advance(TimingWheel::NowMs());
+
+        // 处理每一个就绪事件；新连接在本批事件之后再 accept，
+        // 否则刚被超时关闭的槽位可能被新连接复用，收到旧连接的事件
+        bool listenReady = false;
         for (int i = 0; i < eventCount; ++i)
         {
-            int fd = epoller_->GetEventFd(i);
             uint32_t events = epoller_->GetEvents(i);
 
-            // 交给内部函数处理
-            HandleEvents_(fd, events);
+            // 连接以 data.ptr 注册，直接拿到连接槽，无需查表
+            void *ptr = epoller_->GetEventPtr(i);
+            if (slab_->Contains(ptr))
+            {
+                HandleEvents_(static_cast<ConnSlot *>(ptr), events);
+                continue;
+            }
+
+            // 其余为以 data.fd 注册的控制 fd
+            int fd = epoller_->GetEventFd(i);
+
+            if (fd == waiter_->GetWakeupFd())
+            {
+                waiter_->ConsumeWakeup();
+                continue;
+            }
+
+            if (listener_ && fd == listener_->GetFd())
+            {
+                // io_uring 的 multishot accept 直接交来新连接
+                int clientFd = epoller_->GetAcceptedFd(i);
+                if (clientFd >= 0)
+                {
+                    accepted_.push_back(clientFd);
+                    continue;
+                }
+                listenReady = true;
+            }
+        }
+        for (int clientFd : accepted_)
+        {
+            listener_->OnAccepted();
+            RegisterConn_(clientFd, sockaddr_in{});
+        }
+        accepted_.clear();
+        if (listenReady)
+        {
+            HandleListen_(); // reuseport 模式：直接在本线程 accept
+        }
+
+        // 每轮都检查邮箱：门铃只负责把线程从阻塞中叫醒
+        DrainMailbox_();
+
+        // 排空中：连接全部关闭后退出
+        if (draining_ && slab_->InUse() == 0)
+        {
+            drained_.store(true, std::memory_order_release);
+            break;
         }
     }
+
+    logger->log(INFO, "SubReactor exit: " + waiter_->Report());
+    if (listener_ && !draining_)
+    {
+        logger->log(INFO, "SubReactor listener: " + listener_->Report());
+    }
 }
 
 // 新连接加入 SubReactor 管理
 void SubReactor::AddConn(int fd, const sockaddr_in &addr)
 {
-    // 锁住 users_，保证线程安全
-    std::lock_guard<std::mutex> lock(users_mutex_);
+    Post([this, fd, addr]()
+         { RegisterConn_(fd, addr); });
+}
+
+void SubReactor::Post(std::function<void()> task)
+{
+    // 队列满时让出 CPU 等待 SubReactor 消费，不丢任务
+    while (!mailbox_.TryPush(std::move(task)))
+    {
+        std::this_thread::yield();
+    }
+    // 只有门铃从未按下变为按下的那个生产者才写 eventfd
+    if (!doorbell_.exchange(true))
+    {
+        waiter_->Wakeup();
+    }
+}
+
+void SubReactor::DrainMailbox_()
+{
+    // 先松开门铃再取任务：取任务期间新投递的生产者会重新按门铃，不会丢唤醒
+    doorbell_.store(false);
+
+    // 每轮最多处理一个队列容量的任务，避免饿死 I/O 事件
+    std::function<void()> task;
+    for (size_t i = 0; i < mailbox_.Capacity(); i++)
+    {
+        if (!mailbox_.TryPop(task))
+        {
+            return;
+        }
+        task();
+    }
+    // 还有剩余：按下门铃保证下一轮继续处理
+    if (!doorbell_.exchange(true))
+    {
+        waiter_->Wakeup();
+    }
+}
+
+void SubReactor::RegisterConn_(int fd, const sockaddr_in &addr)
+{
+    ConnSlot *slot = slab_->Acquire();
+    if (!slot)
+    {
+        // 连接槽用完：直接拒绝，避免无界增长
+        close(fd);
+        logger->log(WARNING, "SubReactor connection slab full, reject fd: " + std::to_string(fd));
+        return;
+    }
     // 初始化连接
-    users_[fd].init(fd, addr);
+    slot->conn.init(fd, addr);
 
-    // 设置非阻塞
-    int oldFlag = fcntl(fd, F_GETFL);
-    fcntl(fd, F_SETFL, oldFlag | O_NONBLOCK);
+    // fd 由 accept4 创建时已是非阻塞，这里不再 fcntl
+    waiter_->ApplySocket(fd);
 
     // 将 fd 加入 epoll 监控，监听可读事件(EPOLLIN)、边缘触发(EPOLLET)，可选 EPOLLONESHOT
     // epoller_->AddFd(fd, EPOLLIN | EPOLLET);
 
     // 也可根据需要添加 EPOLLONESHOT:
-    epoller_->AddFd(fd, EPOLLIN | EPOLLET | EPOLLONESHOT);
+    epoller_->AddFd(fd, EPOLLIN | EPOLLET | EPOLLONESHOT, slot);
+
+    // 新连接必须在期限内发来完整的请求头
+    slot->headerDeadlineMs = 0;
+    SetTimer_(slot, HEADER_TIMER);
+}
+
+void SubReactor::CloseConn_(ConnSlot *slot)
+{
+    if (!slot->inUse)
+    {
+        return; // 已回收
+    }
+    timer_->Cancel(&slot->timer);
+    epoller_->DelFd(slot->conn.GetFd()); // 从 epoll 移除
+    slot->conn.Close();                  // 关闭 socket
+    slab_->Release(slot);                // 归还槽位，代数 + 1
+}
+
+void SubReactor::SetTimer_(ConnSlot *slot, ConnTimer kind)
+{
+    int64_t now = TimingWheel::NowMs();
+    slot->idle = (kind == KEEPALIVE_TIMER);
+    switch (kind)
+    {
+    case HEADER_TIMER:
+        // 期限从开始等待这个请求时算起，分多次到达也不会延长(防慢速攻击)
+        if (slot->headerDeadlineMs == 0)
+        {
+            slot->headerDeadlineMs = now + headerTimeoutMs_;
+        }
+        timer_->Schedule(&slot->timer, slot->headerDeadlineMs - now);
+        break;
+    case KEEPALIVE_TIMER:
+        slot->headerDeadlineMs = 0;
+        timer_->Schedule(&slot->timer, keepAliveTimeoutMs_);
+        break;
+    case WRITE_TIMER:
+        timer_->Schedule(&slot->timer, writeTimeoutMs_);
+        break;
+    case BODY_TIMER:
+        slot->headerDeadlineMs = 0; // 请求头已收齐，下一个请求重新计算期限
+        timer_->Schedule(&slot->timer, bodyTimeoutMs_);
+        break;
+    }
+}
+
+void SubReactor::OnTimeout_(ConnSlot *slot)
+{
+    if (slot && slot->inUse)
+    {
+        CloseConn_(slot);
+    }
+}
+
+bool SubReactor::Listen(int port, int inheritedFd)
+{
+    listener_ = std::make_unique<Listener>(port, true);
+    if (!(inheritedFd >= 0 ? listener_->Adopt(inheritedFd) : listener_->Init()))
+    {
+        listener_.reset();
+        return false;
+    }
+    // 没有 CBPF 程序时，内核优先把绑定 CPU 上收到的连接交给本 socket
+    if (!cpus_.empty())
+    {
+        listener_->SetIncomingCpu(cpus_[0]);
+    }
+    // 优先由 Poller 代为 accept(io_uring)，不支持时监听可读事件
+    if (epoller_->AddAcceptor(listener_->GetFd()) < 0)
+    {
+        epoller_->AddFd(listener_->GetFd(), EPOLLIN | EPOLLET);
+    }
+    return true;
+}
+
+int SubReactor::GetListenFd() const
+{
+    return listener_ ? listener_->GetFd() : -1;
+}
+
+void SubReactor::Drain()
+{
+    Post([this]()
+         { BeginDrain_(); });
 }
 
-// 关闭连接
-void SubReactor::CloseConn(int fd)
+void SubReactor::BeginDrain_()
 {
-    // 锁住 users_，保证线程安全
-    std::lock_guard<std::mutex> lock(users_mutex_);
-    auto it = users_.find(fd);
-    if (it == users_.end())
+    if (draining_)
     {
-        return; // 不存在
+        return;
     }
-    epoller_->DelFd(fd); // 从 epoll 移除
-    it->second.Close();  // 关闭 socket
-    users_.erase(fd);    // 从 map 中删除
+    draining_ = true;
+
+    // 停止 accept：监听 socket 仍由新进程持有，队列中的连接不会丢
+    if (listener_)
+    {
+        epoller_->DelFd(listener_->GetFd());
+        logger->log(INFO, "SubReactor listener: " + listener_->Report());
+        listener_.reset();
+    }
+
+    // 空闲的长连接直接关闭；正在处理的请求写完响应后关闭(此时响应带 Connection: close)
+    slab_->ForEach([this](ConnSlot *slot)
+                   {
+        if (slot->idle)
+            CloseConn_(slot); });
+    logger->log(INFO, "SubReactor draining, connections left: " + std::to_string(slab_->InUse()));
 }
 
-// 内部函数：处理单个 fd 的事件
-void SubReactor::HandleEvents_(int fd, uint32_t events)
+// 本线程 accept：边缘触发，需要一直 accept 到 EAGAIN
+void SubReactor::HandleListen_()
 {
-    // 锁住 users_，保证线程安全
-    std::lock_guard<std::mutex> lock(users_mutex_);
-    // 先找到对应连接
-    auto it = users_.find(fd);
-    if (it == users_.end())
+    sockaddr_in clientAddr;
+    while (true)
+    {
+        int clientFd = listener_->Accept(&clientAddr);
+        if (clientFd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                std::cerr << "Accept error!\n";
+                logger->log(ERROR, "SubReactor accept error!");
+            }
+            break;
+        }
+        RegisterConn_(clientFd, clientAddr); // 已在本线程，无需经过邮箱
+    }
+}
+
+// 内部函数：处理单个连接的事件
+void SubReactor::HandleEvents_(ConnSlot *slot, uint32_t events)
+{
+    // 本轮推进时间轮时已被超时关闭的连接，事件已经失效
+    if (!slot->inUse)
     {
         return;
     }
 
-    // 引用 or 拷贝
-    HttpConn &conn = it->second;
+    // EPOLLONESHOT 保证任务执行期间该连接不会再触发事件；
+    // 任务带上当前代数，执行时若槽位已被回收则直接丢弃
+    uint32_t gen = slot->generation.load(std::memory_order_acquire);
+
+    // 处理期间不计时，避免定时器在线程池使用连接时把它关掉；重新注册事件时再设置
+    timer_->Cancel(&slot->timer);
+    slot->idle = false;
 
     // 如果是可读事件
     if (events & EPOLLIN)
     {
+        if (runToCompletion_)
+        {
+            HandleRead_(slot, gen); // 本线程直接处理
+            return;
+        }
         // 把真正的读逻辑投递给线程池
-        threadPool_->addTask([this, fd]()
-                             {
-            // 二次查找：确保在任务执行时，连接还在
-            // （若你能保证连接一定在，就不用二次查找）
-            auto iter = users_.find(fd);
-            if(iter == users_.end()) return;
-
-            HttpConn &connRef = iter->second;
-            HandleRead_(connRef); });
+        threadPool_->addTask([this, slot, gen]()
+                             { HandleRead_(slot, gen); });
     }
     else if (events & EPOLLOUT)
     {
+        if (runToCompletion_)
+        {
+            HandleWrite_(slot, gen);
+            return;
+        }
         // 同理，写事件也丢给线程池
-        threadPool_->addTask([this, fd]()
-                             {
-            auto iter = users_.find(fd);
-            if(iter == users_.end()) return;
-
-            HttpConn &connRef = iter->second;
-            HandleWrite_(connRef); });
+        threadPool_->addTask([this, slot, gen]()
+                             { HandleWrite_(slot, gen); });
     }
     else
     {
-        CloseConn(fd);
+        CloseConn_(slot);
     }
 }
 
-// 处理读事件
-void SubReactor::HandleRead_(HttpConn &conn)
+void SubReactor::Rearm_(ConnSlot *slot, uint32_t gen, uint32_t events, ConnTimer kind)
 {
+    if (InLoop_())
+    {
+        RearmInLoop_(slot, events, kind);
+        return;
+    }
+    Post([this, slot, gen, events, kind]()
+         {
+        if (slot->generation.load(std::memory_order_acquire) != gen)
+            return;
+        RearmInLoop_(slot, events, kind); });
+}
+
+void SubReactor::RearmInLoop_(ConnSlot *slot, uint32_t events, ConnTimer kind)
+{
+    // 排空开始前已决定保持的长连接，不再等待下一个请求
+    if (draining_ && kind == KEEPALIVE_TIMER)
+    {
+        CloseConn_(slot);
+        return;
+    }
+    epoller_->ModFd(slot->conn.GetFd(), events | EPOLLET | EPOLLONESHOT, slot);
+    SetTimer_(slot, kind);
+}
+
+void SubReactor::Close_(ConnSlot *slot, uint32_t gen)
+{
+    if (InLoop_())
+    {
+        CloseConn_(slot);
+        return;
+    }
+    Post([this, slot, gen]()
+         {
+        if (slot->generation.load(std::memory_order_acquire) != gen)
+            return;
+        CloseConn_(slot); });
+}
+
+// 处理读事件：epoll 的修改在本线程直接做，在线程池则投递回本线程
+void SubReactor::HandleRead_(ConnSlot *slot, uint32_t gen)
+{
+    if (slot->generation.load(std::memory_order_acquire) != gen)
+    {
+        return; // 过期任务
+    }
+    HttpConn &conn = slot->conn;
     int err = 0;
     int ret = -1;
     ret = conn.read(&err);
 
     if (ret <= 0 && err != EAGAIN)
     {
-        CloseConn(conn.GetFd());
+        Close_(slot, gen);
+        return;
+    }
+
+    // 运行到完成模式下，只有阻塞请求(登录 / 注册要查 MySQL)才交给线程池
+    if (InLoop_() && conn.IsBlockingRequest())
+    {
+        threadPool_->addTask([this, slot, gen]()
+                             { Process_(slot, gen); });
+        return;
     }
-    // 准备写响应
-    if (conn.process())
+    Process_(slot, gen);
+}
+
+void SubReactor::Process_(ConnSlot *slot, uint32_t gen)
+{
+    if (slot->generation.load(std::memory_order_acquire) != gen)
     {
-        epoller_->ModFd(conn.GetFd(), EPOLLOUT | EPOLLET | EPOLLONESHOT);
+        return; // 过期任务
+    }
+    if (slot->conn.process(InLoop_()))
+    {
+        // 响应已就绪：立即 writev，只有写到 EAGAIN 才注册 EPOLLOUT
+        HandleWrite_(slot, gen);
     }
     else
     {
-        epoller_->ModFd(conn.GetFd(), EPOLLIN | EPOLLET | EPOLLONESHOT);
+        // 请求不完整，继续读
+        Rearm_(slot, gen, EPOLLIN, slot->conn.IsReadingBody() ? BODY_TIMER : HEADER_TIMER);
     }
 }
 
 // 处理写事件
-void SubReactor::HandleWrite_(HttpConn &conn)
+void SubReactor::HandleWrite_(ConnSlot *slot, uint32_t gen)
 {
-    int err = 0;
-    int ret = conn.write(&err);
-
-    // 写缓冲已写完
-    if (conn.ToWriteBytes() == 0)
+    if (slot->generation.load(std::memory_order_acquire) != gen)
+    {
+        return; // 过期任务
+    }
+    HttpConn &conn = slot->conn;
+    while (true)
     {
-        // 判断是否保持长连接
-        if (conn.IsKeepAlive())
+        int err = 0;
+        conn.write(&err);
+
+        // 写缓冲已写完
+        if (conn.ToWriteBytes() == 0)
         {
-            epoller_->ModFd(conn.GetFd(), EPOLLIN | EPOLLET | EPOLLONESHOT);
+            // 判断是否保持长连接
+            if (!conn.IsKeepAlive())
+            {
+                Close_(slot, gen);
+            }
+            else if (!conn.HasBufferedRequest())
+            {
+                // 发出 100 Continue 后仍在等待请求体时不算空闲
+                Rearm_(slot, gen, EPOLLIN, conn.IsReadingBody() ? BODY_TIMER : KEEPALIVE_TIMER);
+            }
+            else if (InLoop_() && conn.IsBlockingRequest())
+            {
+                // 运行到完成模式：剩余的流水线请求以阻塞请求开头，交给线程池
+                threadPool_->addTask([this, slot, gen]()
+                                     { Process_(slot, gen); });
+            }
+            else if (conn.process(InLoop_()))
+            {
+                continue; // 读缓冲中还有流水线请求：继续处理下一批，边缘触发下不会再有可读事件
+            }
+            else
+            {
+                // 剩余请求不完整(或发出 100 Continue 后等待请求体)，继续读
+                Rearm_(slot, gen, EPOLLIN, conn.IsReadingBody() ? BODY_TIMER : HEADER_TIMER);
+            }
             return;
         }
-        else
+
+        // 写入未完成，缓冲区满
+        if (err == EAGAIN || err == EWOULDBLOCK)
         {
-            CloseConn(conn.GetFd());
+            Rearm_(slot, gen, EPOLLOUT, WRITE_TIMER);
+            return;
         }
-        return;
-    }
 
-    // 写入未完成，缓冲区满
-    if (err == EAGAIN || err == EWOULDBLOCK)
-    {
-        epoller_->ModFd(conn.GetFd(), EPOLLOUT | EPOLLET | EPOLLONESHOT);
+        Close_(slot, gen);
         return;
     }
-
-    CloseConn(conn.GetFd());
 }
 
 void SubReactor::stop()
 {
     isRunning_ = false;
-}
\ No newline at end of file
+    waiter_->Wakeup(); // 立刻唤醒阻塞中的 epoll_wait
+}
@@ -1,9 +1,11 @@
 #ifndef SUBREACTOR_H
 #define SUBREACTOR_H
 
-#include <unordered_map>
 #include <memory>
-#include <mutex>        // 引入 mutex
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
 #include <stdio.h>      // 标准输入输出
 #include <stdlib.h>     // 标准库函数
 #include <string.h>     // 字符串操作
@@ -12,47 +14,134 @@
 #include <sys/types.h>  // 基本数据类型
 #include <sys/socket.h> // 套接字接口
 #include <netinet/in.h> // sockaddr_in
-#include "Epoll.h"
+#include "Poller.h"
+#include "Listener.h"
+#include "WaitStrategy.h"
+#include "MpscQueue.h"
+#include "ConnSlab.h"
+#include "CpuPlacement.h"
+#include "TimingWheel.h"
 #include "HttpConn.h"
 #include "ThreadPool.h"
 #include "log.hpp"
 
+/**
+ * @brief 子 Reactor：独占自己的 epoll 与连接表
+ *        其他线程(主 Reactor / 线程池)只能通过 Post() 把操作投递到本线程的邮箱，
+ *        由本线程批量取出执行，因此 epoll_ctl 与连接槽的分配 / 回收只在本线程进行，不需要加锁
+ */
 class SubReactor
 {
 public:
     SubReactor(std::shared_ptr<ThreadPool> threadPool);
     ~SubReactor();
 
+    // 绑定 CPU(在 run() 之前调用)：run() 先把本线程绑到这些 CPU，再分配连接槽，
+    // 由首次写入(first-touch)把连接槽与缓冲区放在本地 NUMA 节点
+    void SetCpus(const std::vector<int> &cpus) { cpus_ = cpus; }
+
     // 启动 SubReactor 的事件循环
     void run();
 
     // 关闭 SubReactor 的事件循环
     void stop();
 
-    // 将新的 clientFd 加入 epoll 监控
+    // 将新的 clientFd 加入 epoll 监控(任意线程，投递到邮箱)
     void AddConn(int fd, const sockaddr_in &addr);
 
-    // 关闭连接
-    void CloseConn(int fd);
+    // 把任意操作投递给本 SubReactor 线程执行(任意线程)
+    void Post(std::function<void()> task);
+
+    // SO_REUSEPORT 模式：创建本 SubReactor 自己的监听 socket，并加入自己的 epoll
+    // inheritedFd >= 0 时接管热升级继承来的监听 socket
+    bool Listen(int port, int inheritedFd = -1);
+
+    // 返回自己的监听 fd(未开启 reuseport 时为 -1)
+    int GetListenFd() const;
+
+    // 开始排空(任意线程)：停止 accept，关闭空闲长连接，存量连接处理完后退出事件循环
+    void Drain();
+
+    // 是否已排空(连接全部关闭，事件循环已退出)
+    bool IsDrained() const { return drained_.load(std::memory_order_acquire); }
+
+    // 等待策略(含自旋 / 睡眠时间统计)
+    const WaitStrategy &GetWaitStrategy() const { return *waiter_; }
 
 private:
+    // 连接定时器类型
+    enum ConnTimer
+    {
+        HEADER_TIMER,    // 等待 / 读取请求头
+        KEEPALIVE_TIMER, // 响应已写完，长连接空闲
+        WRITE_TIMER,     // 等待 socket 可写
+        BODY_TIMER,      // 请求头已收齐，等待请求体(按停滞时间计时，大文件上传不受请求头期限限制)
+    };
+
+    // 以下函数只在本 SubReactor 线程调用
+    void RegisterConn_(int fd, const sockaddr_in &addr);
+    void CloseConn_(ConnSlot *slot);
+    // 按类型为连接设置定时器
+    void SetTimer_(ConnSlot *slot, ConnTimer kind);
+    // 定时器到期：关闭连接
+    void OnTimeout_(ConnSlot *slot);
+    // 批量执行邮箱中的任务
+    void DrainMailbox_();
+    // 处理自己监听 socket 上的新连接
+    void HandleListen_();
+    // 在本线程开始排空
+    void BeginDrain_();
     // 处理事件
-    void HandleEvents_(int fd, uint32_t events);
-    void HandleRead_(HttpConn &conn);
-    void HandleWrite_(HttpConn &conn);
+    void HandleEvents_(ConnSlot *slot, uint32_t events);
+
+    // 以下函数在线程池线程执行(运行到完成模式下在本线程执行)，gen 为投递任务时槽位的代数
+    void HandleRead_(ConnSlot *slot, uint32_t gen);
+    void HandleWrite_(ConnSlot *slot, uint32_t gen);
+    // 解析请求并立即尝试写出响应
+    void Process_(ConnSlot *slot, uint32_t gen);
+    // 重新注册事件 / 关闭连接：在本线程直接执行，否则投递回本线程(代数对不上则忽略)
+    void Rearm_(ConnSlot *slot, uint32_t gen, uint32_t events, ConnTimer kind);
+    void RearmInLoop_(ConnSlot *slot, uint32_t events, ConnTimer kind);
+    void Close_(ConnSlot *slot, uint32_t gen);
+    // 当前是否在本 SubReactor 线程
+    bool InLoop_() const { return std::this_thread::get_id() == loopThreadId_; }
 
 private:
-    std::unique_ptr<Epoll> epoller_;
-    // 该 SubReactor 只管理自己的一些客户端连接
-    std::unordered_map<int, HttpConn> users_;
-    // 保护 users_ 容器的互斥锁
-    std::mutex users_mutex_;
+    std::unique_ptr<Poller> epoller_; // epoll 或 io_uring，由配置 reactor.poller 决定
+    // reuseport 模式下自己的监听 socket(主从模式下为空)
+    std::unique_ptr<Listener> listener_;
+    // 本批事件中 multishot accept 交来的新连接，处理完本批事件后再注册
+    std::vector<int> accepted_;
+    // 等待策略，内含唤醒用的 eventfd
+    std::unique_ptr<WaitStrategy> waiter_;
+    // 该 SubReactor 只管理自己的一些客户端连接：预分配的连接槽(在本线程 run() 中分配)
+    std::unique_ptr<ConnSlab> slab_;
+    // 绑定的 CPU，空表示不绑定
+    std::vector<int> cpus_;
+    // 连接定时器，驱动 epoll_wait 的超时
+    std::unique_ptr<TimingWheel> timer_;
+    int headerTimeoutMs_;
+    int keepAliveTimeoutMs_;
+    int writeTimeoutMs_;
+    int bodyTimeoutMs_;
+
+    // 跨线程邮箱：有界 MPSC 队列 + eventfd 门铃(复用 waiter_ 的唤醒 fd)
+    MpscQueue<std::function<void()>> mailbox_;
+    // 门铃是否已按下：一批任务只需要写一次 eventfd
+    std::atomic<bool> doorbell_;
 
     // 线程池
     std::shared_ptr<ThreadPool> threadPool_;
+    // 运行到完成模式：请求在本线程读 / 处理 / 写，不经过线程池
+    bool runToCompletion_;
+    // 事件循环所在线程
+    std::thread::id loopThreadId_;
 
     // 你可以自行选择在构造时创建一个线程，也可以外部控制
-    bool isRunning_;
+    std::atomic<bool> isRunning_;
+    // 排空中(只在本线程访问) / 已排空(主 Reactor 轮询)
+    bool draining_;
+    std::atomic<bool> drained_;
 
     AsyncLogger *logger;
 };
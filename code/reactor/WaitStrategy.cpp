@@ -0,0 +1,138 @@
+#include "WaitStrategy.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <stdexcept>
+#include "log.hpp"
+
+namespace
+{
+    int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+WaitStrategy::WaitStrategy(Mode mode, int spinBudgetUs, int busyPollUs)
+    : mode_(mode),
+      spinBudgetNs_(static_cast<int64_t>(spinBudgetUs) * 1000),
+      busyPollUs_(busyPollUs),
+      wakeupFd_(-1),
+      spinNs_(0),
+      sleepNs_(0),
+      spinHit_(0),
+      spinMiss_(0)
+{
+    wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd_ < 0)
+    {
+        throw std::runtime_error("eventfd create failed!");
+    }
+}
+
+WaitStrategy::~WaitStrategy()
+{
+    if (wakeupFd_ >= 0)
+    {
+        close(wakeupFd_);
+    }
+}
+
+WaitStrategy::Mode WaitStrategy::ParseMode(const std::string &name)
+{
+    if (name == "spin")
+        return SPIN;
+    if (name == "busypoll")
+        return BUSY_POLL;
+    return BLOCK;
+}
+
+void WaitStrategy::Attach(Poller &poller)
+{
+    // 水平触发：没读走计数前会一直就绪，避免丢唤醒
+    poller.AddFd(wakeupFd_, EPOLLIN);
+
+    // 让等待本身也忙轮询网卡队列(epoll 需要 Linux 6.9+)
+    if (mode_ == BUSY_POLL && !poller.SetBusyPoll(busyPollUs_))
+    {
+        AsyncLogger::get_instance().log(WARNING, std::string("busy poll not supported by ") + poller.Name());
+    }
+}
+
+int WaitStrategy::Wait(Poller &poller, int timeoutMS)
+{
+    int64_t start = NowNs();
+
+    if (mode_ == BUSY_POLL)
+    {
+        // 不睡眠，全部计为自旋
+        int n = poller.Wait(0);
+        spinNs_.fetch_add(NowNs() - start, std::memory_order_relaxed);
+        return n;
+    }
+
+    if (mode_ == SPIN)
+    {
+        int64_t now = start;
+        do
+        {
+            int n = poller.Wait(0);
+            now = NowNs();
+            if (n != 0)
+            {
+                spinNs_.fetch_add(now - start, std::memory_order_relaxed);
+                spinHit_.fetch_add(1, std::memory_order_relaxed);
+                return n;
+            }
+        } while (now - start < spinBudgetNs_);
+
+        spinNs_.fetch_add(now - start, std::memory_order_relaxed);
+        spinMiss_.fetch_add(1, std::memory_order_relaxed);
+        start = now;
+    }
+
+    int n = poller.Wait(timeoutMS);
+    sleepNs_.fetch_add(NowNs() - start, std::memory_order_relaxed);
+    return n;
+}
+
+void WaitStrategy::Wakeup()
+{
+    uint64_t one = 1;
+    ssize_t ret = write(wakeupFd_, &one, sizeof(one));
+    (void)ret; // 计数溢出(EAGAIN)时说明已经处于唤醒状态
+}
+
+void WaitStrategy::ConsumeWakeup()
+{
+    uint64_t cnt = 0;
+    ssize_t ret = read(wakeupFd_, &cnt, sizeof(cnt));
+    (void)ret;
+}
+
+void WaitStrategy::ApplySocket(int fd) const
+{
+    if (mode_ != BUSY_POLL)
+        return;
+    int usecs = busyPollUs_;
+    setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs));
+}
+
+std::string WaitStrategy::Report() const
+{
+    static const char *NAMES[] = {"block", "spin", "busypoll"};
+    uint64_t hit = spinHit_.load(std::memory_order_relaxed);
+    uint64_t miss = spinMiss_.load(std::memory_order_relaxed);
+
+    std::string report = std::string("mode=") + NAMES[mode_] +
+                         " spin=" + std::to_string(GetSpinUs() / 1000) + "ms" +
+                         " sleep=" + std::to_string(GetSleepUs() / 1000) + "ms";
+    if (mode_ == SPIN && hit + miss > 0)
+    {
+        report += " spinHit=" + std::to_string(hit * 100 / (hit + miss)) + "%";
+    }
+    return report;
+}
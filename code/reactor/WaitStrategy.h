@@ -0,0 +1,96 @@
+#ifndef WAITSTRATEGY_H
+#define WAITSTRATEGY_H
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "Poller.h"
+
+/**
+ * @brief Reactor 事件循环的等待策略
+ *  - BLOCK：直接阻塞在 epoll_wait，其他线程通过 eventfd 唤醒
+ *  - SPIN ：先用 epoll_wait(0) 自旋 spinBudgetUs 微秒，仍无事件再阻塞
+ *  - BUSY_POLL：始终 epoll_wait(0)，并给 socket 开启 SO_BUSY_POLL，用 CPU 换延迟
+ *  同时统计自旋 / 睡眠各花了多少时间
+ */
+class WaitStrategy
+{
+public:
+    enum Mode
+    {
+        BLOCK,
+        SPIN,
+        BUSY_POLL,
+    };
+
+    /**
+     * @param mode         等待策略
+     * @param spinBudgetUs SPIN 模式下每次自旋的时间预算(微秒)
+     * @param busyPollUs   BUSY_POLL 模式下 SO_BUSY_POLL 的时间(微秒)
+     */
+    WaitStrategy(Mode mode, int spinBudgetUs = 50, int busyPollUs = 50);
+    ~WaitStrategy();
+
+    /**
+     * @brief 将配置中的字符串("block" / "spin" / "busypoll")转为 Mode，未知时为 BLOCK
+     */
+    static Mode ParseMode(const std::string &name);
+
+    /**
+     * @brief 把唤醒用的 eventfd 注册进 poller，并在 BUSY_POLL 模式下开启 poller 的忙轮询
+     */
+    void Attach(Poller &poller);
+
+    /**
+     * @brief 按策略等待事件
+     * @param timeoutMS 阻塞阶段最长等待时间(毫秒)，-1 表示直到被唤醒
+     * @return 就绪事件数量，<0 表示出错
+     */
+    int Wait(Poller &poller, int timeoutMS);
+
+    /**
+     * @brief 唤醒阻塞中的事件循环(可在任意线程调用)
+     */
+    void Wakeup();
+
+    /**
+     * @brief 事件循环收到唤醒 fd 可读时调用，清空计数
+     */
+    void ConsumeWakeup();
+
+    /**
+     * @brief 唤醒用的 eventfd，事件循环需要跳过它
+     */
+    int GetWakeupFd() const { return wakeupFd_; }
+
+    /**
+     * @brief 给新连接的 socket 应用策略相关的选项(BUSY_POLL 下设置 SO_BUSY_POLL)
+     */
+    void ApplySocket(int fd) const;
+
+    Mode GetMode() const { return mode_; }
+
+    /**
+     * @brief 自旋 / 睡眠累计时间(微秒)
+     */
+    uint64_t GetSpinUs() const { return spinNs_.load(std::memory_order_relaxed) / 1000; }
+    uint64_t GetSleepUs() const { return sleepNs_.load(std::memory_order_relaxed) / 1000; }
+
+    /**
+     * @brief 形如 "mode=spin spin=12ms sleep=3400ms spinHit=95%" 的统计信息
+     */
+    std::string Report() const;
+
+private:
+    Mode mode_;
+    int64_t spinBudgetNs_;
+    int busyPollUs_;
+    int wakeupFd_;
+
+    std::atomic<uint64_t> spinNs_;   // 自旋累计时间
+    std::atomic<uint64_t> sleepNs_;  // 阻塞累计时间
+    std::atomic<uint64_t> spinHit_;  // 自旋期间拿到事件的次数
+    std::atomic<uint64_t> spinMiss_; // 自旋预算耗尽转入阻塞的次数
+};
+
+#endif // WAITSTRATEGY_H
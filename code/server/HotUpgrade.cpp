@@ -0,0 +1,229 @@
+#include "HotUpgrade.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <iostream>
+
+extern char **environ;
+
+namespace
+{
+    const char *kUpgradeEnv = "WEBSERVER_UPGRADE_FD";
+    const int kMaxFds = 64; // 一次最多交接的监听 fd 数
+}
+
+std::string HotUpgrade::execPath_;
+std::vector<std::string> HotUpgrade::args_;
+int HotUpgrade::channelFd_ = -1;
+
+void HotUpgrade::Init(int argc, char *argv[])
+{
+    // 记录路径而不是 /proc/self/exe：部署新版本替换文件后，exec 打开的是新文件
+    char buf[4096];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (len > 0)
+    {
+        execPath_.assign(buf, len);
+    }
+    else if (argc > 0)
+    {
+        execPath_ = argv[0];
+    }
+    args_.assign(argv, argv + argc);
+}
+
+std::vector<int> HotUpgrade::TakeInheritedFds()
+{
+    std::vector<int> fds;
+    const char *env = getenv(kUpgradeEnv);
+    if (!env)
+    {
+        return fds;
+    }
+    channelFd_ = atoi(env);
+    unsetenv(kUpgradeEnv);
+    fcntl(channelFd_, F_SETFD, FD_CLOEXEC);
+
+    AsyncLogger &logger = AsyncLogger::get_instance();
+    if (!RecvFds_(channelFd_, &fds))
+    {
+        logger.log(ERROR, "HotUpgrade receive listen fds failed, errno: " + std::to_string(errno));
+        for (int fd : fds)
+        {
+            close(fd);
+        }
+        fds.clear();
+        close(channelFd_);
+        channelFd_ = -1;
+        return fds;
+    }
+    logger.log(INFO, "HotUpgrade inherited " + std::to_string(fds.size()) + " listen fds");
+    return fds;
+}
+
+void HotUpgrade::NotifyReady()
+{
+    if (channelFd_ < 0)
+    {
+        return;
+    }
+    char ready = 'R';
+    if (write(channelFd_, &ready, 1) != 1)
+    {
+        AsyncLogger::get_instance().log(ERROR, "HotUpgrade notify ready failed, errno: " + std::to_string(errno));
+    }
+    close(channelFd_);
+    channelFd_ = -1;
+}
+
+bool HotUpgrade::Spawn(const std::vector<int> &listenFds, int timeoutMs)
+{
+    AsyncLogger &logger = AsyncLogger::get_instance();
+    if (execPath_.empty() || listenFds.empty() || static_cast<int>(listenFds.size()) > kMaxFds)
+    {
+        logger.log(ERROR, "HotUpgrade not initialized or invalid listen fds");
+        return false;
+    }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+    {
+        logger.log(ERROR, "HotUpgrade socketpair failed, errno: " + std::to_string(errno));
+        return false;
+    }
+
+    // fork 之后的子进程只能调用异步信号安全的函数，参数和环境变量提前准备好
+    std::string envEntry = std::string(kUpgradeEnv) + "=" + std::to_string(sv[1]);
+    std::vector<char *> envp;
+    size_t prefixLen = strlen(kUpgradeEnv) + 1;
+    for (char **e = environ; *e; e++)
+    {
+        if (strncmp(*e, envEntry.c_str(), prefixLen) != 0)
+        {
+            envp.push_back(*e);
+        }
+    }
+    envp.push_back(&envEntry[0]);
+    envp.push_back(nullptr);
+
+    std::vector<char *> argv;
+    for (auto &arg : args_)
+    {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        logger.log(ERROR, "HotUpgrade fork failed, errno: " + std::to_string(errno));
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        // 子进程：通道一侧需要跨过 exec，其余 fd 都带 CLOEXEC
+        fcntl(sv[1], F_SETFD, 0);
+        sigset_t mask;
+        sigemptyset(&mask);
+        pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+        execve(execPath_.c_str(), argv.data(), envp.data());
+        _exit(127);
+    }
+    close(sv[1]);
+
+    bool ok = SendFds_(sv[0], listenFds);
+    if (ok)
+    {
+        // 等待新进程就绪(读到 1 字节)，新进程退出时读到 EOF
+        struct pollfd pfd = {sv[0], POLLIN, 0};
+        char ready = 0;
+        int n = poll(&pfd, 1, timeoutMs);
+        ok = n > 0 && read(sv[0], &ready, 1) == 1 && ready == 'R';
+    }
+    close(sv[0]);
+
+    if (!ok)
+    {
+        logger.log(ERROR, "HotUpgrade new process " + std::to_string(pid) + " not ready, keep serving");
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return false;
+    }
+    logger.log(INFO, "HotUpgrade new process " + std::to_string(pid) + " ready: " + execPath_);
+    return true;
+}
+
+bool HotUpgrade::SendFds_(int sock, const std::vector<int> &fds)
+{
+    int count = static_cast<int>(fds.size());
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    ssize_t n;
+    do
+    {
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(sizeof(count));
+}
+
+bool HotUpgrade::RecvFds_(int sock, std::vector<int> *fds)
+{
+    int count = 0;
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+
+    char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do
+    {
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n != static_cast<ssize_t>(sizeof(count)))
+    {
+        return false;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        {
+            continue;
+        }
+        size_t num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int *data = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+        fds->assign(data, data + num);
+    }
+    return static_cast<int>(fds->size()) == count && !(msg.msg_flags & MSG_CTRUNC);
+}
@@ -0,0 +1,57 @@
+#ifndef HOTUPGRADE_H
+#define HOTUPGRADE_H
+
+#include <string>
+#include <vector>
+#include "log.hpp"
+
+/**
+ * @brief 热升级：把监听 socket 交给新启动的进程，旧进程随后排空退出
+ *
+ *        旧进程(收到 SIGUSR2)                     新进程
+ *        socketpair + fork + exec  ------------>  启动，环境变量 WEBSERVER_UPGRADE_FD 指向通道
+ *        sendmsg(SCM_RIGHTS, 监听 fd) ---------->  TakeInheritedFds() 收下监听 fd 直接使用
+ *        等待就绪                  <------------  NotifyReady()：Reactor 已开始运行
+ *        停止 accept，排空连接后退出
+ *
+ *        两个进程持有的是同一个监听 socket，accept 队列中的连接不会丢失；
+ *        新进程启动失败或超时未就绪时旧进程继续服务
+ */
+class HotUpgrade
+{
+public:
+    /**
+     * @brief 启动时调用：记录可执行文件路径和参数，供之后 exec 新版本
+     */
+    static void Init(int argc, char *argv[]);
+
+    /**
+     * @brief 新进程启动时调用：若由旧进程拉起，从通道收下监听 fd(按旧进程中的顺序)
+     * @return 继承的监听 fd；普通启动返回空
+     */
+    static std::vector<int> TakeInheritedFds();
+
+    /**
+     * @brief 新进程就绪后调用：通知旧进程可以停止 accept(普通启动时什么也不做)
+     */
+    static void NotifyReady();
+
+    /**
+     * @brief 旧进程调用：拉起新进程并交出监听 fd，等待其就绪
+     * @param listenFds 监听 fd(reuseport 模式下为每个 SubReactor 的 fd)
+     * @param timeoutMs 等待新进程就绪的最长时间
+     * @return 新进程已就绪返回 true；失败时新进程已被回收，调用方继续服务
+     */
+    static bool Spawn(const std::vector<int> &listenFds, int timeoutMs);
+
+private:
+    static bool SendFds_(int sock, const std::vector<int> &fds);
+    static bool RecvFds_(int sock, std::vector<int> *fds);
+
+private:
+    static std::string execPath_;           // 启动时解析的可执行文件路径(exec 时重新打开，拿到新版本)
+    static std::vector<std::string> args_;  // 启动参数
+    static int channelFd_;                  // 新进程一侧的通道，NotifyReady 后关闭
+};
+
+#endif // HOTUPGRADE_H
@@ -1,4 +1,7 @@
 #include "WebServer.h"
+#include "HttpConn.h"
+#include "Precompressor.h"
+#include "Router.h"
 
 Server::Server(int port, int subReactorCount)
     : master_(port, subReactorCount),
@@ -10,6 +13,65 @@ Server::Server(int port, int subReactorCount)
     // 初始化数据库连接池
     // SqlConnPool::Instance()->Init("localhost", 3306, "root", "6", "webserver", 4);
     SqlConnPool::Instance()->Init(config->GetDBHost().c_str(), config->GetDBPort(), config->GetDBUser().c_str(), config->GetDBPassword().c_str(), config->GetDBName().c_str(), config->GetSqlPoolNum());
+
+    // 预压缩静态文件：只在启动时做一次，请求路径上直接发送旁路文件
+    if (config->GetPrecompress())
+    {
+        Precompressor precompressor(config->GetCompressMinBytes());
+        precompressor.Run(config->GetServerSrcDir());
+        logger->log(INFO, "Precompress: " + precompressor.Report());
+    }
+
+    // 路由表在 Reactor 线程启动前冻结，之后只读
+    InitRoutes_();
+}
+
+void Server::InitRoutes_()
+{
+    RouterBuilder routes;
+    const uint32_t READ = Router::M_GET | Router::M_HEAD;
+    const uint32_t PAGE = READ | Router::M_POST;
+
+    // 页面的短路径(POST /login、/register 是表单提交，见下)
+    routes.AddStatic(PAGE, "/", "/index.html");
+    for (const char *page : {"/index", "/welcome", "/video", "/picture"})
+    {
+        routes.AddStatic(PAGE, page, std::string(page) + ".html");
+    }
+    routes.AddStatic(READ, "/login", "/login.html");
+    routes.AddStatic(READ, "/register", "/register.html");
+
+    // 登录 / 注册：提交表单时查询 MySQL，成功跳到欢迎页，失败跳到错误页
+    auto verify = [](bool isLogin, const char *form)
+    {
+        return [isLogin, form](HttpRequest &request, const RouteMatch &, HttpResponse &response)
+        {
+            if (request.GetHeader(HttpTables::H_CONTENT_TYPE).substr(0, 33) != "application/x-www-form-urlencoded")
+            {
+                response.SetFile(200, form);
+                return;
+            }
+            bool ok = HttpRequest::UserVerify(request.GetPost("username"), request.GetPost("password"), isLogin);
+            response.SetFile(200, ok ? "/welcome.html" : "/error.html");
+        };
+    };
+    for (const char *path : {"/login", "/login.html"})
+    {
+        routes.AddHandler(Router::M_POST, path, verify(true, "/login.html"), true);
+    }
+    for (const char *path : {"/register", "/register.html"})
+    {
+        routes.AddHandler(Router::M_POST, path, verify(false, "/register.html"), true);
+    }
+
+    for (const auto &redirect : config->GetRedirects())
+    {
+        routes.AddRedirect(READ, redirect.first, redirect.second, 301);
+    }
+
+    // 其余路径按资源目录下的同名文件发送
+    routes.AddStatic(PAGE, "/*path", "/");
+    HttpConn::router = routes.Freeze();
 }
 
 Server::~Server()
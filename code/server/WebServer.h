@@ -32,6 +32,11 @@ public:
     void stop();
 
 private:
+    /**
+     * @brief 注册路由(静态页面、登录 / 注册、配置中的重定向)，冻结后交给 HttpConn
+     */
+    void InitRoutes_();
+
     MasterReactor master_; ///< 内部持有一个 MasterReactor
 
     bool running_;
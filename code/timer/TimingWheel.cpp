@@ -0,0 +1,160 @@
+#include "TimingWheel.h"
+#include <chrono>
+
+int64_t TimingWheel::NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+TimingWheel::TimingWheel(int tickMs, Callback onExpire, int64_t nowMs)
+    : tickMs_(tickMs > 0 ? tickMs : 1),
+      onExpire_(std::move(onExpire)),
+      startMs_(nowMs),
+      current_(0),
+      size_(0)
+{
+    for (int l = 0; l < LEVELS; l++)
+    {
+        for (int s = 0; s < SLOTS; s++)
+        {
+            slots_[l][s].prev = slots_[l][s].next = &slots_[l][s];
+        }
+    }
+}
+
+void TimingWheel::Schedule(TimerNode *node, int64_t timeoutMs)
+{
+    if (node->linked)
+    {
+        Unlink_(node);
+    }
+    // 向上取整，再加上当前 tick 内已经过去的部分，保证不会提前触发
+    uint64_t ticks = timeoutMs <= 0 ? 0 : static_cast<uint64_t>((timeoutMs + tickMs_ - 1) / tickMs_);
+    node->expire = current_ + ticks + 1;
+    Link_(node);
+}
+
+void TimingWheel::Cancel(TimerNode *node)
+{
+    if (node->linked)
+    {
+        Unlink_(node);
+    }
+}
+
+void TimingWheel::Advance(int64_t nowMs)
+{
+    uint64_t target = static_cast<uint64_t>((nowMs - startMs_) / tickMs_);
+    if (size_ == 0)
+    {
+        // 空轮子直接跳到目标 tick
+        if (target > current_)
+            current_ = target;
+        return;
+    }
+
+    while (current_ < target)
+    {
+        current_++;
+        // 第 0 层转完一圈：从第 1 层开始逐层级联
+        for (int level = 1; level < LEVELS; level++)
+        {
+            if ((current_ >> (SLOT_BITS * level - SLOT_BITS)) & SLOT_MASK)
+                break;
+            Cascade_(level);
+        }
+
+        TimerNode *head = &slots_[0][current_ & SLOT_MASK];
+        while (head->next != head)
+        {
+            TimerNode *node = head->next;
+            Unlink_(node);
+            onExpire_(node); // 回调里可以重新 Schedule 本节点
+        }
+        if (size_ == 0 && target > current_)
+        {
+            current_ = target;
+        }
+    }
+}
+
+int TimingWheel::NextTimeoutMs(int64_t nowMs) const
+{
+    if (size_ == 0)
+    {
+        return -1;
+    }
+    // 在第 0 层往后找最近的非空槽；找不到就等到第 0 层转完一圈(需要级联)
+    uint64_t ticks = SLOTS - (current_ & SLOT_MASK);
+    for (uint64_t i = 1; i < SLOTS; i++)
+    {
+        uint64_t t = current_ + i;
+        const TimerNode *head = &slots_[0][t & SLOT_MASK];
+        if (head->next != head)
+        {
+            ticks = i;
+            break;
+        }
+        if ((t & SLOT_MASK) == 0)
+        {
+            ticks = i; // 级联点
+            break;
+        }
+    }
+    int64_t deadline = startMs_ + static_cast<int64_t>(current_ + ticks) * tickMs_;
+    int64_t wait = deadline - nowMs;
+    return wait > 0 ? static_cast<int>(wait) : 0;
+}
+
+void TimingWheel::Link_(TimerNode *node)
+{
+    uint64_t expire = node->expire;
+    if (expire <= current_)
+    {
+        expire = current_ + 1;
+        node->expire = expire;
+    }
+    uint64_t delta = expire - current_;
+
+    // 选层：delta 落在哪一层的覆盖范围内
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+    if (level == LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * LEVELS)))
+    {
+        // 超出最大范围，挂在最高层最远处，级联时会再次分配
+        expire = current_ + (1ULL << (SLOT_BITS * LEVELS)) - 1;
+    }
+    TimerNode *head = &slots_[level][(expire >> (SLOT_BITS * level)) & SLOT_MASK];
+
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+    node->linked = true;
+    size_++;
+}
+
+void TimingWheel::Unlink_(TimerNode *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = nullptr;
+    node->linked = false;
+    size_--;
+}
+
+void TimingWheel::Cascade_(int level)
+{
+    TimerNode *head = &slots_[level][(current_ >> (SLOT_BITS * level)) & SLOT_MASK];
+    while (head->next != head)
+    {
+        TimerNode *node = head->next;
+        Unlink_(node);
+        Link_(node); // 按剩余时间重新分配到更低层
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief 侵入式定时器节点：直接嵌在被管理的对象里(如连接槽)，增删都不需要分配内存
+ */
+struct TimerNode
+{
+    TimerNode *prev = nullptr;
+    TimerNode *next = nullptr;
+    uint64_t expire = 0;    // 到期 tick
+    void *owner = nullptr;  // 所属对象，超时回调里用来找回宿主
+    bool linked = false;    // 是否挂在时间轮上
+};
+
+/**
+ * @brief 分层时间轮：4 层 x 64 槽，tick 粒度由 tickMs 指定
+ *  - 第 0 层每槽 1 tick，第 1 层每槽 64 tick，依此类推(tick=100ms 时可覆盖约 19 天)
+ *  - 添加 / 删除 / 重设都是 O(1)：只做双向链表的摘除与插入
+ *  - 第 0 层转完一圈时，把上一层对应槽里的节点重新分配到下层(级联)
+ *  非线程安全，只在所属 SubReactor 线程使用
+ */
+class TimingWheel
+{
+public:
+    using Callback = std::function<void(TimerNode *)>;
+
+    /**
+     * @param tickMs  tick 粒度(毫秒)
+     * @param onExpire 到期回调，节点已从时间轮摘下
+     * @param nowMs   当前时间(毫秒)
+     */
+    TimingWheel(int tickMs, Callback onExpire, int64_t nowMs);
+
+    /**
+     * @brief 在 timeoutMs 后触发；若节点已在时间轮上则先摘下再重新挂
+     */
+    void Schedule(TimerNode *node, int64_t timeoutMs);
+
+    /**
+     * @brief 取消定时器(未挂上时什么都不做)
+     */
+    void Cancel(TimerNode *node);
+
+    /**
+     * @brief 推进到 nowMs，触发所有到期节点
+     */
+    void Advance(int64_t nowMs);
+
+    /**
+     * @brief 距离下一个可能到期的 tick 还有多少毫秒，用作 epoll_wait 的超时；没有定时器时返回 -1
+     */
+    int NextTimeoutMs(int64_t nowMs) const;
+
+    /**
+     * @brief 时间轮上的节点数
+     */
+    size_t Size() const { return size_; }
+
+    /**
+     * @brief 单调时钟的当前时间(毫秒)
+     */
+    static int64_t NowMs();
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    void Link_(TimerNode *node);
+    void Unlink_(TimerNode *node);
+    // 把第 level 层当前槽里的节点重新分配到下层
+    void Cascade_(int level);
+
+    int tickMs_;
+    Callback onExpire_;
+    int64_t startMs_;   // 构造时刻，tick 从这里开始计
+    uint64_t current_;  // 当前已处理到的 tick
+    size_t size_;
+
+    // 每个槽是一个带哨兵的双向循环链表
+    TimerNode slots_[LEVELS][SLOTS];
+};
+
+#endif // TIMINGWHEEL_H